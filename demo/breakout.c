@@ -9,15 +9,14 @@
 #include "bounce_methods.h"
 #include "sdl_wrapper.h"
 #include "collision.h"
+#include "spatial_grid.h"
 #include "bounce_methods.h"
 
 const vector_t WINDOW = {1000, 500};
 const vector_t USER_INIT_CENTER = {500, 25};
 const double ACCELERATION = 500;
-const double PI_2 = 3.14159265358979323846;
 const double BALL_RADIUS = 7.5;
 const vector_t ORIG_VEL = {50, 0};
-const double CIRCLE_INCREMENT = 200;
 const double MASS = 10000;
 const vector_t BALL_VELOCITY = {100, 100};
 
@@ -44,30 +43,13 @@ const double COLOR_INC = 0.1;
 
 //Draws ball and adds it to the scene
 void make_ball(scene_t *scene) {
-  double radius = BALL_RADIUS;
   vector_t center = {(WINDOW.x / 2) - PADDLE_X / 2,
     (PADDLE_INIT.y + BALL_RADIUS + BRICK_OFFSET)};
-  vector_t *cent = malloc(sizeof(vector_t));
-  list_t *shape = list_init(CIRCLE_INCREMENT, (free_func_t) vec_free);
-  assert(cent != NULL);
-  cent->x = center.x;
-  cent->y = center.y;
-  double dtheta = 2 * PI_2 / CIRCLE_INCREMENT;
-  double theta = 0;
-  double origTheta = PI_2 / 4;
-  for (int i = 0; i < CIRCLE_INCREMENT;  i++){
-    theta = origTheta + (i * dtheta);
-    vector_t *add = malloc(sizeof(vector_t));
-    assert(add != NULL);
-    add->x = center.x + radius * cos(theta);
-    add->y = center.y + radius * sin(theta);
-    list_add(shape, add);
-  }
   int *ball_info = malloc(sizeof(int));
   *ball_info = BALL_INFO;
   list_t *info = list_init(1, NULL);
   list_add(info, (void *) ball_info);
-  body_t *ball = body_init_with_info(shape, MASS,
+  body_t *ball = body_init_circle(center, BALL_RADIUS, MASS,
     (rgb_color_t) {0, 0, 0}, info, NULL);
   body_set_velocity(ball, BALL_VELOCITY);
   scene_add_body(scene, ball);
@@ -241,7 +223,6 @@ void collide(scene_t *scene){
 // Actions if a killer stars collide with the paddle.
 bool killer_collide(scene_t *scene){
   body_t *paddle = scene_get_body(scene, 1);
-  bool paddle_status = body_is_collided(paddle);
   for(size_t i = 2; i < scene_bodies(scene); i++){
     body_t *body = scene_get_body(scene, i);
     if((*(int *) body_get_info(body)) == KILLER_BALL_INFO){
@@ -252,7 +233,6 @@ bool killer_collide(scene_t *scene){
       }
     }
   }
-  body_collided(paddle, paddle_status);
   return false;
 }
 
@@ -287,11 +267,11 @@ void remove_off_screen(scene_t *scene){
 void make_killer_star(scene_t *scene) {
   double rand_x = random_number(0, WINDOW.x);
   double rand_y = random_number(WINDOW.y / 2, WINDOW.y);
-  list_t *shape = create_star(10, vec_init(rand_x, rand_y));
+  shape_t *shape = create_star(10, vec_init(rand_x, rand_y));
   rgb_color_t color = {0, 1, 0};
   int *info = malloc(sizeof(int));
   *info = KILLER_BALL_INFO;
-  body_t *star = body_init_with_info(shape, 1, color, info, (free_func_t) free);
+  body_t *star = body_init_with_shape(shape, 1, color, info, (free_func_t) free);
   body_set_velocity(star, vec_init(0, -50));
   scene_add_body(scene, star);
 }
@@ -309,6 +289,7 @@ bool game_over(scene_t *scene){
 int main(void) {
   sdl_init(VEC_ZERO, WINDOW);
   scene_t *scene = scene_init();
+  scene_set_broadphase(scene, spatial_grid_init());
   make_ball(scene);
   make_paddle(scene); // ensuring it is position 1 for key handler
   make_walls(scene);
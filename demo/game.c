@@ -8,6 +8,7 @@
 #include "bounce_methods.h"
 #include "sdl_wrapper.h"
 #include "collision.h"
+#include "aabb_tree.h"
 #include "sdl_wrapper.h"
 #include <SDL2/SDL2_gfxPrimitives.h>
 #include <SDL2/SDL_ttf.h>
@@ -20,8 +21,13 @@ const double WOOD_MASS = 30;
 const double VIRUS_MASS = 100;
 const double WALL_MASS = 1e18;
 const double K = 1000;
-const double G_CONST = 5e-8;
+// About the pull the two floors used to exert on a beaver above the ground
+const double GRAVITY = 150;
+// How much of a beaver's speed along the floor is kept each tick it touches
+const double FLOOR_FRICTION = 0.96;
 const double WALL_THICKNESS = 20.0;
+// How far bodies can move before the collision tree has to re-sort them
+const double TREE_MARGIN = 5.0;
 const double DRAG = 1.0;
 const double CORONA_DRAG = 10.0;
 const double GAME_OVER_HOLD = 5.0;
@@ -35,6 +41,14 @@ const double BLOCK_LENGTH = 200.0;
 const double CORONA_RADIUS = 65.0;
 const double BOOST_VELO = 50;
 const double INTRO_SQUARE_SIZE = 150;
+// Collision categories; scenery is in none and collides with nothing
+const uint32_t BEAVER_CATEGORY = 1 << 0;
+const uint32_t BLOCK_CATEGORY = 1 << 1;
+const uint32_t VIRUS_CATEGORY = 1 << 2;
+// Beavers join this category once launched, so gravity and the floors only
+// act on them after they leave the slingshot
+const uint32_t LAUNCHED_CATEGORY = 1 << 3;
+const uint32_t FLOOR_CATEGORY = 1 << 4;
 const double SPEED_FACTOR = 4;
 const double BLOCK_SIZE = 200;
 const int FONT_SIZE = 128;
@@ -113,17 +127,13 @@ int score = 0;
 bool used_boost = false;
 
 // Make a rectangle shape.
-list_t *make_rectangle(vector_t *center, double x_dim, double y_dim){
-  list_t *points_list = list_init(4, NULL);
-  list_add(points_list, (void *) vec_init_pointer(center->x - x_dim / 2,
-    center->y - y_dim / 2));
-  list_add(points_list, (void *) vec_init_pointer(center->x + x_dim / 2,
-    center->y - y_dim / 2));
-  list_add(points_list, (void *) vec_init_pointer(center->x + x_dim / 2,
-    center->y + y_dim / 2));
-  list_add(points_list, (void *) vec_init_pointer(center->x - x_dim / 2,
-    center->y + y_dim / 2));
-  return points_list;
+shape_t *make_rectangle(vector_t *center, double x_dim, double y_dim){
+  shape_t *rectangle = shape_init(4);
+  rectangle->points[0] = vec_init(center->x - x_dim / 2, center->y - y_dim / 2);
+  rectangle->points[1] = vec_init(center->x + x_dim / 2, center->y - y_dim / 2);
+  rectangle->points[2] = vec_init(center->x + x_dim / 2, center->y + y_dim / 2);
+  rectangle->points[3] = vec_init(center->x - x_dim / 2, center->y + y_dim / 2);
+  return rectangle;
 }
 
 // Getting info for what type a body is.
@@ -150,63 +160,68 @@ void make_walls(scene_t *scene){
   list_t *info = list_init(1, NULL);
   list_add(info, (void *) wall_info);
 
-  list_t *floor_shape1 = make_rectangle(vec_init_pointer(WINDOW.x / 4,
+  shape_t *floor_shape1 = make_rectangle(vec_init_pointer(WINDOW.x / 4,
     -8000), WINDOW.x / 2, 16020);
 
-  body_t *floor1 = body_init_with_info(floor_shape1, WALL_MASS,
+  body_t *floor1 = body_init_with_shape(floor_shape1, WALL_MASS,
     CLEAR, info, NULL);
 
+  body_set_collision_filter(floor1, FLOOR_CATEGORY, LAUNCHED_CATEGORY);
   scene_add_body(scene, floor1);
 
-  list_t *floor_shape2 = make_rectangle(vec_init_pointer( 3 * WINDOW.x / 4,
+  shape_t *floor_shape2 = make_rectangle(vec_init_pointer( 3 * WINDOW.x / 4,
     -8000), WINDOW.x / 2, 16020);
 
-  body_t *floor2 = body_init_with_info(floor_shape2, WALL_MASS,
+  body_t *floor2 = body_init_with_shape(floor_shape2, WALL_MASS,
     CLEAR, info, NULL);
 
+  body_set_collision_filter(floor2, FLOOR_CATEGORY, LAUNCHED_CATEGORY);
   scene_add_body(scene, floor2);
 
-  list_t *right = make_rectangle(vec_init_pointer(WINDOW.x, WINDOW.y / 2), 20,
+  shape_t *right = make_rectangle(vec_init_pointer(WINDOW.x, WINDOW.y / 2), 20,
   WINDOW.y);
-  body_t *right_wall = body_init_with_info(right, WALL_MASS,
+  body_t *right_wall = body_init_with_shape(right, WALL_MASS,
     CLEAR, info, NULL);
 
+  body_set_collision_filter(right_wall, 0, 0);
   scene_add_body(scene, right_wall);
 
-  list_t *left = make_rectangle(vec_init_pointer(0, WINDOW.y / 2),
+  shape_t *left = make_rectangle(vec_init_pointer(0, WINDOW.y / 2),
   20, WINDOW.y);
-  body_t *left_wall = body_init_with_info(left, WALL_MASS,
+  body_t *left_wall = body_init_with_shape(left, WALL_MASS,
     CLEAR, info, NULL);
 
+  body_set_collision_filter(left_wall, 0, 0);
   scene_add_body(scene, left_wall);
 }
 
 // Draws a slingshot and adds it to the body
 void make_slingshot(scene_t *scene){
-  list_t *listOfPoints = list_init(13, NULL);
-  list_add(listOfPoints, vec_init_pointer(143, 0));
-  list_add(listOfPoints, vec_init_pointer(157, 0));
-  list_add(listOfPoints, vec_init_pointer(157, 50));
-  list_add(listOfPoints, vec_init_pointer(182, 100));
-  list_add(listOfPoints, vec_init_pointer(182, 150));
-
-  list_add(listOfPoints, vec_init_pointer(173, 150));
-  list_add(listOfPoints, vec_init_pointer(173, 100));
-  list_add(listOfPoints, vec_init_pointer(146, 52));
-
-  list_add(listOfPoints, vec_init_pointer(127, 93));
-  list_add(listOfPoints, vec_init_pointer(127, 138));
-
-  list_add(listOfPoints, vec_init_pointer(120, 138));
-  list_add(listOfPoints, vec_init_pointer(120, 93));
-  list_add(listOfPoints, vec_init_pointer(143, 47));
+  shape_t *slingshot_shape = shape_init(13);
+  slingshot_shape->points[0] = vec_init(143, 0);
+  slingshot_shape->points[1] = vec_init(157, 0);
+  slingshot_shape->points[2] = vec_init(157, 50);
+  slingshot_shape->points[3] = vec_init(182, 100);
+  slingshot_shape->points[4] = vec_init(182, 150);
+
+  slingshot_shape->points[5] = vec_init(173, 150);
+  slingshot_shape->points[6] = vec_init(173, 100);
+  slingshot_shape->points[7] = vec_init(146, 52);
+
+  slingshot_shape->points[8] = vec_init(127, 93);
+  slingshot_shape->points[9] = vec_init(127, 138);
+
+  slingshot_shape->points[10] = vec_init(120, 138);
+  slingshot_shape->points[11] = vec_init(120, 93);
+  slingshot_shape->points[12] = vec_init(143, 47);
   list_t *body_info = list_init(1, NULL);
   int *body_type = malloc(sizeof(int));
   *body_type = SLINGSHOT_TYPE;
   list_add(body_info, body_type);
-  body_t *slingshot = body_init_with_info(listOfPoints, INFINITY,
+  body_t *slingshot = body_init_with_shape(slingshot_shape, INFINITY,
     SLINGSHOT_COLOR,
     body_info, NULL);
+  body_set_collision_filter(slingshot, 0, 0);
   scene_add_body(scene, slingshot);
 }
 
@@ -223,6 +238,10 @@ vector_t compute_launch_speed(vector_t *stretch){
 void launch_beaver(scene_t *scene, body_t *beaver, vector_t *stretch){
   vector_t velocity = compute_launch_speed(stretch);
   body_set_velocity(beaver, velocity);
+  // Fast beavers would skip through thin blocks on a slow frame
+  body_set_bullet(beaver, true);
+  body_set_collision_filter(beaver, BEAVER_CATEGORY | LAUNCHED_CATEGORY,
+    BLOCK_CATEGORY | VIRUS_CATEGORY | FLOOR_CATEGORY);
   score += SCORE_ADD_LAUNCH;
 }
 
@@ -251,6 +270,7 @@ void draw_rubberband(scene_t *scene, vector_t *point){
   list_add(body_info, (void *) body_type);
   body_t *rubber_band = body_init_with_info(listOfPoints, INFINITY,
     RUBBER_BAND_COLOR, body_info, NULL);
+  body_set_collision_filter(rubber_band, 0, 0);
   scene_add_body(scene, rubber_band);
 }
 
@@ -289,6 +309,8 @@ void make_beaver(scene_t *scene, int index) {
   body_set_centroid(launcher, TIP);
   body_set_launched(launcher, false);
   body_set_rotation(launcher, SMALL_ROTATE_ANGLE);
+  body_set_collision_filter(launcher, BEAVER_CATEGORY,
+    BLOCK_CATEGORY | VIRUS_CATEGORY);
   scene_add_body(scene, launcher);
   score += SCORE_ADD_BEAVER;
 }
@@ -313,6 +335,8 @@ void make_corona(scene_t *scene, vector_t center, double size){
   body_set_centroid(rona, center);
   //wack reason for this.  If you got questions, ask will
   body_set_rotation(rona, SMALL_ROTATE_ANGLE);
+  body_set_collision_filter(rona, VIRUS_CATEGORY,
+    BEAVER_CATEGORY | BLOCK_CATEGORY);
   scene_add_body(scene, rona);
   create_drag(scene, CORONA_DRAG, rona);
 }
@@ -320,13 +344,15 @@ void make_corona(scene_t *scene, vector_t center, double size){
 // Making structure block on screen.
 void make_block(scene_t *scene, vector_t *center, double size_x, double size_y,
    double mass, rgb_color_t color, double ang_vel){
-  list_t *rec = make_rectangle(center, size_x, size_y);
+  shape_t *rec = make_rectangle(center, size_x, size_y);
   list_t *body_info = list_init(1, NULL);
   int *body_type = malloc(sizeof(int));
   *body_type = BLOCK_TYPE;
   list_add(body_info, (void *) body_type);
-  body_t *block = body_init_with_info(rec, mass, color, body_info, NULL);
+  body_t *block = body_init_with_shape(rec, mass, color, body_info, NULL);
   body_set_angular_impulse(block, ang_vel);
+  body_set_collision_filter(block, BLOCK_CATEGORY,
+    BEAVER_CATEGORY | BLOCK_CATEGORY | VIRUS_CATEGORY);
   scene_add_body(scene, block);
   create_drag(scene, DRAG, block);
 }
@@ -345,17 +371,39 @@ void make_wood(scene_t *scene, vector_t *center, double size_x, double size_y,
 
 // Adding background iamge.
 void make_background_image(scene_t *scene) {
-  list_t *background = make_rectangle(vec_init_pointer(WINDOW_CENTER.x,
+  shape_t *background = make_rectangle(vec_init_pointer(WINDOW_CENTER.x,
     WINDOW_CENTER.y), WINDOW.x, WINDOW.y);
   list_t *body_info = list_init(1, NULL);
   int *background_type = malloc(sizeof(int));
   *background_type = BACKGROUND_TYPE;
   list_add(body_info, background_type);
-  body_t *background_body = body_init_with_info(background, INFINITY, CLEAR,
+  body_t *background_body = body_init_with_shape(background, INFINITY, CLEAR,
       body_info, NULL);
+  body_set_collision_filter(background_body, 0, 0);
   scene_add_body(scene, background_body);
 }
 
+// Bounces blocks off everything that can hit them.
+void physics_collide(scene_t *scene){
+  create_physics_collision_rule(scene, ELASTICITY, BLOCK_CATEGORY,
+    BEAVER_CATEGORY | BLOCK_CATEGORY | VIRUS_CATEGORY);
+}
+
+// Holds a launched beaver up on the floor and slows it down.
+void land_on_floor(body_t *beaver, body_t *floor, vector_t axis, void *aux){
+  body_set_velocity(beaver,
+    vec_init(FLOOR_FRICTION * body_get_velocity(beaver).x, 0));
+  // cancels gravity, so the beaver does not sink into the floor
+  body_add_force(beaver, vec_init(0, body_get_mass(beaver) * GRAVITY));
+}
+
+// Pulls launched beavers down until they land on the floor.
+void make_gravity(scene_t *scene){
+  create_uniform_gravity(scene, GRAVITY, LAUNCHED_CATEGORY);
+  scene_add_collision_rule(scene, LAUNCHED_CATEGORY, FLOOR_CATEGORY,
+    land_on_floor, NULL, NULL);
+}
+
 // Building level one structure.
 void make_level_one(scene_t *scene){
   make_background_image(scene);
@@ -368,6 +416,8 @@ void make_level_one(scene_t *scene){
     BLOCK_SIZE, 0.0);
   make_rock(scene, vec_init_pointer(1000, 250), BLOCK_THICKNESS,
     BLOCK_SIZE, 0.0);
+  physics_collide(scene);
+  make_gravity(scene);
   beavers_index = 0;
   used_boost = false;
 }
@@ -387,6 +437,8 @@ void make_level_two(scene_t *scene){
     0.0);
   make_wood(scene, vec_init_pointer(900, 362.5), BLOCK_LENGTH, BLOCK_THICKNESS,
     0.0);
+  physics_collide(scene);
+  make_gravity(scene);
   beavers_index = 0;
   used_boost = false;
 }
@@ -404,6 +456,8 @@ void make_level_three(scene_t *scene){
     INFINITY, ROCK_COLOR, 5.0);
   make_block(scene, vec_init_pointer(600, 200), BLOCK_THICKNESS, BLOCK_LENGTH,
     INFINITY, ROCK_COLOR, -5.0);
+  physics_collide(scene);
+  make_gravity(scene);
   beavers_index = 0;
   used_boost = false;
 }
@@ -455,74 +509,42 @@ void check_spinning(scene_t *scene){
   }
 }
 
-// Critera to see if physics collision is one we want.
-bool is_valid_physics_collision(body_t *body1, body_t *body2) {
-  int type_body1 = get_body_type(body1);
-  int type_body2 = get_body_type(body2);
-
-  if (type_body1 == BEAVER_TYPE || type_body1 == FANCY_BEAVER_TYPE) {
-    return(type_body2 == BLOCK_TYPE);
-  }
-  if (type_body1 == VIRUS_TYPE) {
-    return(type_body2 == BLOCK_TYPE);
+// Hurts a virus that a body is touching.
+void hit_virus(body_t *body, body_t *virus){
+  int body_type = get_body_type(body);
+  if(body_type == BEAVER_TYPE || body_type == FANCY_BEAVER_TYPE){
+    body_remove(virus);
   }
-  if (type_body1 == BLOCK_TYPE) {
-    return(type_body2 == VIRUS_TYPE ||
-       type_body2 == BEAVER_TYPE || type_body2 == BLOCK_TYPE ||
-       type_body2 == FANCY_BEAVER_TYPE);
-  }
-  return false;
-}
-
-// Create physics collisions between everything.
-void physics_collide(scene_t *scene){
-  size_t size = scene_bodies(scene);
-  for(size_t i = 3; i < size; i++){
-    for(size_t j = i + 1; j < size; j++){
-      body_t *body1 = scene_get_body(scene, i);
-      body_t *body2 = scene_get_body(scene, j);
-      if(is_valid_physics_collision(body1, body2)) {
-        create_physics_collision(scene, ELASTICITY, body1, body2);
-      }
+  else if (body_type == BLOCK_TYPE){
+    double velo_mag = vec_magnitude(body_get_velocity(body)) +
+                      vec_magnitude(body_get_velocity(virus));
+    double health_dec = velo_mag * body_get_mass(body) / 12000;
+    double *health = (double *) list_remove((list_t *)
+      body_get_info(virus), 1);
+    *health = *health - health_dec;
+    score += SCORE_ADD_HEALTH;
+    list_add((list_t*) body_get_info(virus), health);
+    if (*(double *) list_get((list_t *) body_get_info(virus), 1) <= 0){
+      body_remove(virus);
     }
   }
 }
 
 // Adjusts health on virus.
 void health(scene_t *scene){
-  // Checking all other bodies to see if there is a collision.
-  for(size_t i = 2; i < scene_bodies(scene); i++){
-    body_t *body1 = scene_get_body(scene, i);
-    int body1_type = get_body_type(body1);
-    for(size_t j = 2; j < scene_bodies(scene); j++){
-      if(i != j){
-        body_t *body2 = scene_get_body(scene, j);
-        int body2_type = get_body_type(body2);
-        collision_info_t collided = find_collision(body1, body2);
-        if(get_if_collided(collided)) {
-          if(body2_type == VIRUS_TYPE){
-            if(body1_type == BEAVER_TYPE || body1_type == FANCY_BEAVER_TYPE){
-              scene_remove_body(scene, j);
-            }
-            else if (body1_type == BLOCK_TYPE){
-              double velo_mag = vec_magnitude(body_get_velocity(body1)) +
-                                vec_magnitude(body_get_velocity(body2));
-              double health_dec = velo_mag * body_get_mass(body1) / 12000;
-              double *health = (double *) list_remove((list_t *)
-                body_get_info(body2), 1);
-              *health = *health - health_dec;
-              score += SCORE_ADD_HEALTH;
-              list_add((list_t*) body_get_info(body2), health);
-              if (*(double *) list_get((list_t *) body_get_info(body2), 1)
-                <= 0){
-                scene_remove_body(scene, j);
-              }
-            }
-          }
-        }
-      }
+  // Each touching pair is found once, and the physics collisions reuse it
+  list_t *contacts = list_init(scene_bodies(scene), free);
+  scene_collect_contacts(scene, contacts);
+  for(size_t i = 0; i < list_size(contacts); i++){
+    contact_t *contact = list_get(contacts, i);
+    if(get_body_type(contact->body2) == VIRUS_TYPE){
+      hit_virus(contact->body1, contact->body2);
+    }
+    if(get_body_type(contact->body1) == VIRUS_TYPE){
+      hit_virus(contact->body2, contact->body1);
     }
   }
+  list_free(contacts);
 }
 
 // Clicking event handler.
@@ -562,8 +584,6 @@ void on_click(event_type_t type, vector_t clicked_point, void *scene) {
       create_drag(scene, DRAG, beaver);
       launch_beaver(scene, beaver, change_vector);
       body_set_launched(beaver, true);
-      create_earth_gravity(scene, G_CONST, beaver, scene_get_body(scene, 2));
-      create_earth_gravity(scene, G_CONST, beaver, scene_get_body(scene, 3));
       new_tip = vec_init_pointer(TIP.x, TIP.y);
       draw_rubberband(scene, new_tip);
     }
@@ -584,6 +604,7 @@ body_t *draw_square(scene_t *scene, vector_t centroid, double size){
   body_t *square = body_init_with_info(listOfPoints, BEAVER_MASS, CLEAR,
     body_info, NULL);
   body_set_centroid(square, centroid);
+  body_set_collision_filter(square, 0, 0);
   return square;
 }
 
@@ -791,6 +812,9 @@ int main(void) {
     bool clock_start = false;
     bool is_screen_made = false;
     scene_t *bigScene = scene_init();
+    scene_set_broadphase(bigScene, aabb_tree_broadphase_init(TREE_MARGIN));
+    // settled blocks and viruses stop costing anything until they are hit
+    scene_set_sleeping(bigScene, true);
 
     char *score_text = malloc(DEFAULT_STRING * sizeof(char));
     char *beavers_left_text = malloc(DEFAULT_STRING * sizeof(char));
@@ -871,7 +895,6 @@ int main(void) {
           }
           check_spinning(bigScene);
           health(bigScene);
-          physics_collide(bigScene);
           scene_tick(bigScene, dt);
           // Attach the sprites to the body
           attach_sprites(bigScene,
@@ -932,7 +955,6 @@ int main(void) {
           check_spinning(bigScene);
           health(bigScene);
           scene_tick(bigScene, dt);
-          physics_collide(bigScene);
           // Attach the sprites to the body
           attach_sprites(bigScene,
                         normal_beav_texture,
@@ -990,7 +1012,6 @@ int main(void) {
           }
           check_spinning(bigScene);
           health(bigScene);
-          physics_collide(bigScene);
           scene_tick(bigScene, dt);
           attach_sprites(bigScene,
                           normal_beav_texture,
@@ -12,30 +12,28 @@ const vector_t WINDOW = {1000, 500};
 const int MIN_MASS = 15;
 const int MAX_MASS = 95;
 const int NUM_STARS = 70;
+// How coarsely distant stars are grouped when computing gravity
+const double THETA = 0.5;
 
 int main(void){
   vector_t min = {.x = 0, .y = 0};
   vector_t max = {.x = WINDOW.x , .y = WINDOW.y};
   sdl_init(min, max);
-  scene_t *scene = scene_init();
+  // every star moves every tick, so their state is kept in dense arrays
+  scene_t *scene = scene_init_soa(NUM_STARS);
   // Adding bodies to the scene
   for(int i = 0; i < NUM_STARS; i++) {
     int xCenter = random_number(0, (int) WINDOW.x);
     int yCenter = random_number(0, (int) WINDOW.y);
     vector_t center = {xCenter, yCenter};
-    body_t *star = body_init(create_star(4, center),
+    body_t *star = body_init_with_shape(create_star(4, center),
       random_number(MIN_MASS, MAX_MASS),
       (rgb_color_t) {(float) get_color(), (float) get_color(),
-        (float) get_color()});
+        (float) get_color()}, NULL, NULL);
     scene_add_body(scene, star);
   }
 
-  for(size_t i = 0; i < scene_bodies(scene); i++){
-    for(size_t j = i + 1; j < scene_bodies(scene); j++){
-       create_newtonian_gravity(scene, G_CONST, scene_get_body(scene, i),
-         scene_get_body(scene, j));
-    }
-  }
+  create_barnes_hut_gravity(scene, G_CONST, THETA);
   // Main loop
   while(!sdl_is_done(scene)) {
    double dt = time_since_last_tick();
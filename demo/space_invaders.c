@@ -8,6 +8,7 @@
 #include "bounce_methods.h"
 #include "sdl_wrapper.h"
 #include "collision.h"
+#include "sweep_prune.h"
 
 const double ENEMY_CIRCLE_AMOUNT = 0.400;
 const double ENEMY_RADIUS = 30;
@@ -16,7 +17,6 @@ const vector_t WINDOW = {1000, 500};
 const vector_t USER_INIT_CENTER = {500, 25};
 const double ACCELERATION = 100;
 const double PI_2 = 3.14159265358979323846;
-const double FULL_CIRCLE_FRAC = 1;
 const double BULLET_RADIUS = 7.5;
 const vector_t ORIG_VEL = {50, 0};
 const double CIRCLE_INCREMENT = 60;
@@ -75,20 +75,18 @@ void shoot(scene_t *scene, body_t *shooter, int type) {
   // Will creates a cirle that starts at the center of the shooter
   // has an initial y velocity. Once it leaves the screen it can be removed.
   // Will use find_collision to see if it hits the ship but this method should
-  list_t *circle_bullet = list_init(CIRCLE_INCREMENT, (free_func_t) vec_free);
-  vector_t center = *(vector_t *)list_get(body_get_shape(shooter), 0);
-  draw_circle(FULL_CIRCLE_FRAC, center, BULLET_RADIUS, circle_bullet);
+  vector_t center = body_get_shape_view(shooter)->points[0];
   if (type == USER_INFO) {
     *bullet_info = USER_BULLET_INFO;
-    body_t *bullet = body_init_with_info(circle_bullet, BULLET_MASS, (rgb_color_t){1, 0, 0}
-    , bullet_info, NULL);
+    body_t *bullet = body_init_circle(center, BULLET_RADIUS, BULLET_MASS,
+      (rgb_color_t){1, 0, 0}, bullet_info, NULL);
     body_set_velocity(bullet, VELOCITY_VECTOR);
     scene_add_body(scene, bullet);
   }
   else {
     *bullet_info = ENEMY_BULLET_INFO;
-    body_t *bullet = body_init_with_info(circle_bullet, BULLET_MASS, (rgb_color_t){0, 1, 0}
-    ,bullet_info, NULL);
+    body_t *bullet = body_init_circle(center, BULLET_RADIUS, BULLET_MASS,
+      (rgb_color_t){0, 1, 0}, bullet_info, NULL);
     body_set_velocity(bullet, vec_negate(VELOCITY_VECTOR));
     scene_add_body(scene, bullet);
   }
@@ -154,12 +152,11 @@ void check_shift_down(scene_t *scene) {
   for (int i = 0; i < scene_bodies(scene); i++) {
     body_t *enemy = scene_get_body(scene, i);
     if (*(int *)body_get_info(enemy) == 1) {
-        list_t *points_shape = body_get_shape(enemy);
-        vector_t *center_point = list_get(points_shape, 0);
-        if (center_point->x <= ENEMY_RADIUS ||
-          center_point->x >= WINDOW.x - ENEMY_RADIUS) {
-          polygon_translate(points_shape, DEFAULT_SHIFT_DOWN);
-          body_set_points(enemy, points_shape);
+        vector_t center_point = body_get_shape_view(enemy)->points[0];
+        if (center_point.x <= ENEMY_RADIUS ||
+          center_point.x >= WINDOW.x - ENEMY_RADIUS) {
+          body_set_centroid(enemy, vec_add(body_get_centroid(enemy),
+            DEFAULT_SHIFT_DOWN));
           vector_t new_velo = vec_negate(body_get_velocity(enemy));
           body_set_velocity(enemy, new_velo);
       }
@@ -291,6 +288,7 @@ int main(void) {
   vector_t max = {.x = WINDOW.x , .y = WINDOW.y};
   sdl_init(min, max);
   scene_t *scene = scene_init();
+  scene_set_broadphase(scene, sweep_prune_init());
   int num_rows = 0;
   double clock = 0;
   double shoot = 0;
@@ -10,40 +10,18 @@
 
 const int NUM_BODIES = 50;
 const double MASS = 10;
-const double CIRCLE_INCREMENT = 600;
 const double SPRING_CONSTANT = 10.0;
 const vector_t INITIAL_VELO = {0, 100};
 const vector_t WINDOW = {1000, 500};
 const vector_t INIT_CENTER = {500, 250};
 const double ACCELERATION = 100;
-const double PI = 3.14159265358979323846;
 const double FACTOR_MOD = 0.01;
 
-// This function creates a circle given a radius and a center
-// Also given a list that we want to add the points to
-// and a circ frac of how much of the circle we want
-void draw_circle(double circ_frac, vector_t center, double radius,
-  list_t *list) {
-  double dtheta = 2 * PI / CIRCLE_INCREMENT;
-  double theta = 0;
-  double origTheta = circ_frac * PI / 4;
-  for (int i = 0; i < CIRCLE_INCREMENT * circ_frac;  i++){
-    theta = origTheta + i * dtheta;
-    vector_t *add = malloc(sizeof(vector_t));
-    assert(add != NULL);
-    add->x = center.x + radius * cos(theta);
-    add->y = center.y + radius * sin(theta);
-    list_add(list, add);
-  }
-}
-
-// This method uses draw circles to create a body of a circle
+// This method creates a circle body
 // with mass, color, speed, etc.
 // Adds it to a given scene. Also given a type to see whether it is
 // an infinite mass or normal mass one.
 void make_circles(scene_t *scene, vector_t center, double radius, size_t type) {
-  list_t *points = list_init(CIRCLE_INCREMENT, (free_func_t) vec_free);
-  draw_circle(1, center, radius, points);
   body_t *new_circle = NULL;
   // Types will allow us to add bodies to the screen that we want
   // Type 1 is normal bodies that we see. Random color and uniform mass
@@ -51,11 +29,12 @@ void make_circles(scene_t *scene, vector_t center, double radius, size_t type) {
   if (type == 1) {
     rgb_color_t color = {(float) get_color(), (float) get_color(),
       (float) get_color()};
-    new_circle = body_init(points, MASS, color);
+    new_circle = body_init_circle(center, radius, MASS, color, NULL, NULL);
   }
   else {
     rgb_color_t color = {(float) 1.0, (float) 1.0, (float) 1.0};
-    new_circle = body_init(points, INFINITY, color);
+    new_circle = body_init_circle(center, radius, INFINITY, color, NULL,
+      NULL);
   }
   scene_add_body(scene, new_circle);
 }
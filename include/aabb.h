@@ -0,0 +1,74 @@
+#ifndef __AABB_H__
+#define __AABB_H__
+
+#include <stdbool.h>
+#include "shape.h"
+#include "vector.h"
+
+/**
+ * An axis-aligned bounding box.
+ * Broadphases compare these instead of polygons to cheaply rule out
+ * pairs of bodies that cannot be touching.
+ */
+typedef struct {
+    /** The corner with the smallest x and y */
+    vector_t min;
+    /** The corner with the largest x and y */
+    vector_t max;
+} aabb_t;
+
+/**
+ * Computes the smallest box containing every vertex of a shape.
+ *
+ * @param shape a packed polygon with at least one vertex
+ * @return the shape's bounding box
+ */
+aabb_t aabb_of_shape(const shape_t *shape);
+
+/**
+ * Returns whether two boxes overlap. Boxes that only touch count as
+ * overlapping.
+ *
+ * @param a the first box
+ * @param b the second box
+ * @return whether the boxes share any point
+ */
+bool aabb_overlap(aabb_t a, aabb_t b);
+
+/**
+ * Returns whether one box lies entirely inside another.
+ *
+ * @param outer the box that might contain the other
+ * @param inner the box that might be contained
+ * @return whether inner is inside outer
+ */
+bool aabb_contains(aabb_t outer, aabb_t inner);
+
+/**
+ * Computes the smallest box containing two boxes.
+ *
+ * @param a the first box
+ * @param b the second box
+ * @return the union of the boxes
+ */
+aabb_t aabb_union(aabb_t a, aabb_t b);
+
+/**
+ * Grows a box by a margin on every side.
+ *
+ * @param box the box to grow
+ * @param margin the distance to move each side outwards
+ * @return the grown box
+ */
+aabb_t aabb_fatten(aabb_t box, double margin);
+
+/**
+ * Computes the perimeter of a box, which is the cost measure used to
+ * decide how to group boxes in a tree.
+ *
+ * @param box the box to measure
+ * @return the box's perimeter
+ */
+double aabb_perimeter(aabb_t box);
+
+#endif // #ifndef __AABB_H__
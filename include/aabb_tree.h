@@ -0,0 +1,180 @@
+#ifndef __AABB_TREE_H__
+#define __AABB_TREE_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "aabb.h"
+#include "broadphase.h"
+#include "vector.h"
+
+/**
+ * A dynamic bounding volume hierarchy: a balanced binary tree whose leaves
+ * hold boxes, each inner node holding the union of its children's boxes.
+ * Leaves store a "fat" box grown by a margin, so a leaf only has to be
+ * moved in the tree once its object leaves the fat box. Insertions pick the
+ * sibling that grows the tree's total perimeter least, and rotations keep
+ * the tree balanced.
+ * Unlike grids and sweep-and-prune it handles objects of very different
+ * sizes well, e.g. huge floors next to small debris.
+ */
+typedef struct aabb_tree aabb_tree_t;
+
+/**
+ * A function called for each leaf found by aabb_tree_query().
+ *
+ * @param data the data stored with the leaf
+ * @param aux the auxiliary value passed to aabb_tree_query()
+ * @return whether to keep looking for more leaves
+ */
+typedef bool (*tree_query_t)(void *data, void *aux);
+
+/**
+ * A function called for each leaf whose box a ray hits in aabb_tree_raycast().
+ *
+ * @param data the data stored with the leaf
+ * @param origin the start of the ray
+ * @param direction the direction of the ray
+ * @param max_t how far along the ray (in multiples of direction) to look
+ * @param aux the auxiliary value passed to aabb_tree_raycast()
+ * @return the new value of max_t: max_t to keep looking, a smaller value to
+ *   only look for closer leaves, or 0 to stop
+ */
+typedef double (*tree_raycast_t)(
+    void *data,
+    vector_t origin,
+    vector_t direction,
+    double max_t,
+    void *aux
+);
+
+/**
+ * Allocates memory for an empty tree.
+ * Asserts that the required memory is allocated.
+ *
+ * @param margin how far to grow each leaf's box on every side
+ * @return a pointer to the newly allocated tree
+ */
+aabb_tree_t *aabb_tree_init(double margin);
+
+/**
+ * Releases the memory allocated for a tree. Does not free leaf data.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ */
+void aabb_tree_free(aabb_tree_t *tree);
+
+/**
+ * Adds a leaf to a tree.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ * @param box the object's bounding box
+ * @param data the data to store with the leaf
+ * @return a handle for the leaf, valid until it is removed
+ */
+size_t aabb_tree_insert(aabb_tree_t *tree, aabb_t box, void *data);
+
+/**
+ * Removes a leaf from a tree.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ * @param leaf a handle returned from aabb_tree_insert()
+ */
+void aabb_tree_remove(aabb_tree_t *tree, size_t leaf);
+
+/**
+ * Updates the bounding box of a leaf's object. The leaf is only moved in
+ * the tree if the new box is no longer inside its fat box.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ * @param leaf a handle returned from aabb_tree_insert()
+ * @param box the object's new bounding box
+ * @return whether the leaf had to be moved
+ */
+bool aabb_tree_move(aabb_tree_t *tree, size_t leaf, aabb_t box);
+
+/**
+ * Gets the fat box stored for a leaf.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ * @param leaf a handle returned from aabb_tree_insert()
+ * @return the leaf's box, grown by the tree's margin
+ */
+aabb_t aabb_tree_get_box(aabb_tree_t *tree, size_t leaf);
+
+/**
+ * Gets the data stored with a leaf.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ * @param leaf a handle returned from aabb_tree_insert()
+ * @return the data passed to aabb_tree_insert()
+ */
+void *aabb_tree_get_data(aabb_tree_t *tree, size_t leaf);
+
+/**
+ * Gets the height of a tree (0 for a single leaf), which is logarithmic in
+ * the number of leaves while the tree is balanced.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ * @return the number of levels below the root
+ */
+size_t aabb_tree_height(aabb_tree_t *tree);
+
+/**
+ * Calls a function on every leaf whose fat box overlaps a region.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ * @param region the box to search
+ * @param callback the function to call on each leaf found
+ * @param aux an auxiliary value to pass to the callback
+ */
+void aabb_tree_query(
+    aabb_tree_t *tree,
+    aabb_t region,
+    tree_query_t callback,
+    void *aux
+);
+
+/**
+ * Calls a function on every leaf whose fat box is hit by the ray from
+ * origin to origin + max_t * direction. Leaves are not visited in any
+ * particular order; the callback can shorten the ray to skip farther ones.
+ *
+ * @param tree a pointer to a tree returned from aabb_tree_init()
+ * @param origin the start of the ray
+ * @param direction the direction of the ray (need not be a unit vector)
+ * @param max_t how far along the ray to look, in multiples of direction
+ * @param callback the function to call on each leaf hit
+ * @param aux an auxiliary value to pass to the callback
+ */
+void aabb_tree_raycast(
+    aabb_tree_t *tree,
+    vector_t origin,
+    vector_t direction,
+    double max_t,
+    tree_raycast_t callback,
+    void *aux
+);
+
+/**
+ * Allocates memory for a broadphase that keeps bodies in an aabb_tree_t.
+ * Each tick every body's leaf is updated and queried with its fat box,
+ * so pairs are reported once their fat boxes overlap.
+ * It also answers broadphase_query() and broadphase_raycast() from the
+ * tree.
+ *
+ * @param margin how far to grow each body's box on every side
+ * @return a pointer to the newly allocated broadphase
+ */
+broadphase_t *aabb_tree_broadphase_init(double margin);
+
+/**
+ * Gets the tree used by a broadphase from aabb_tree_broadphase_init(),
+ * e.g. to run region or ray queries over a scene's bodies.
+ * The data stored with each leaf is its body_t *.
+ *
+ * @param broadphase a broadphase returned from aabb_tree_broadphase_init()
+ * @return the broadphase's tree
+ */
+aabb_tree_t *aabb_tree_broadphase_get_tree(broadphase_t *broadphase);
+
+#endif // #ifndef __AABB_TREE_H__
@@ -0,0 +1,51 @@
+#ifndef __BARNES_HUT_H__
+#define __BARNES_HUT_H__
+
+#include "scene.h"
+
+/**
+ * Newtonian gravity between every pair of bodies in a scene, approximated
+ * with a Barnes-Hut quadtree. Each tick the bodies are sorted into a
+ * quadtree whose cells know their total mass and center of mass, with a few
+ * bodies in each leaf. The bodies of a leaf are pulled by a whole cell at
+ * once when the cell is small compared to its distance from the leaf, i.e.
+ * its width is less than theta times that distance, so a tick costs
+ * O(n log n) instead of the O(n^2) of one force creator per pair.
+ */
+typedef struct barnes_hut barnes_hut_t;
+
+/**
+ * Allocates memory for Barnes-Hut gravity over a scene's bodies.
+ * Bodies of infinite mass neither pull nor are pulled.
+ *
+ * @param scene the scene whose bodies attract each other
+ * @param G the gravitational proportionality constant
+ * @param theta the opening angle: 0 makes every pair of bodies interact
+ *   directly, giving the same forces as create_newtonian_gravity() on every
+ *   pair up to floating-point rounding, while larger values trade accuracy
+ *   for speed (0.5 is typical)
+ * @return a pointer to the newly allocated gravity
+ */
+barnes_hut_t *barnes_hut_init(scene_t *scene, double G, double theta);
+
+/**
+ * Frees memory allocated for Barnes-Hut gravity.
+ * The scene is not freed.
+ *
+ * @param gravity a pointer returned from barnes_hut_init()
+ */
+void barnes_hut_free(barnes_hut_t *gravity);
+
+/**
+ * Rebuilds the quadtree from the scene's bodies and adds the gravitational
+ * force on each of them. As with create_newtonian_gravity(), bodies closer
+ * than the sum of their radii do not pull each other.
+ * Sleeping bodies still pull the others but are not pulled themselves, and
+ * when every body is asleep the tree is not built at all.
+ * This is a force creator (see scene_add_force_creator()).
+ *
+ * @param gravity a pointer returned from barnes_hut_init()
+ */
+void barnes_hut_apply(barnes_hut_t *gravity);
+
+#endif // #ifndef __BARNES_HUT_H__
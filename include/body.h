@@ -2,22 +2,47 @@
 #define __BODY_H__
 
 #include <stdbool.h>
+#include <stdint.h>
+#include "aabb.h"
+#include "body_store.h"
 #include "color.h"
 #include "list.h"
+#include "shape.h"
 #include "vector.h"
 
 /**
  * A rigid body constrained to the plane.
- * Implemented as a polygon with uniform density.
+ * Implemented as a polygon with uniform density, or as a circle or capsule
+ * (see body_kind_t).
+ * The polygon is stored once in local space (centroid at the origin) along
+ * with a position and angle, so moving or rotating a body is O(1).
+ * The position, velocity, forces and angular state live in a slot of a
+ * body_store_t, either one owned by a scene or the body's own.
  * Bodies can accumulate forces and impulses during each tick.
  * Angular physics (i.e. torques) are not currently implemented.
  */
 typedef struct body body_t;
 
+/**
+ * The kinds of geometry a body can have.
+ * Circles and capsules are stored as a core shape plus a radius: a circle's
+ * core is its center and a capsule's core is the segment between the centers
+ * of its end caps. Collisions between them are tested in closed form and
+ * they are drawn natively, so they are much cheaper than polygons with
+ * enough vertices to look round.
+ */
+typedef enum {
+    BODY_POLYGON,
+    BODY_CIRCLE,
+    BODY_CAPSULE
+} body_kind_t;
+
 /**
  * Allocates memory for a body with the given parameters.
  * The body is initially at rest.
  * Asserts that the mass is positive and that the required memory is allocated.
+ * The vertices are copied into the body's packed storage
+ * and the list is list_free()d, so it must not be used afterwards.
  *
  * @param shape a list of vectors describing the initial shape of the body
  * @param mass the mass of the body (if INFINITY, stops the body from moving)
@@ -35,6 +60,73 @@ body_t *body_init_with_info(
     free_func_t info_freer
 );
 
+/**
+ * Allocates memory for a body whose vertices are given as a packed shape.
+ * Acts like body_init_with_info(), but the body takes ownership of the shape
+ * directly instead of copying it out of a list.
+ *
+ * @param shape the packed vertices of the body, freed by body_free()
+ * @param mass the mass of the body (if INFINITY, stops the body from moving)
+ * @param color the color of the body, used to draw it on the screen
+ * @param info additional information to associate with the body
+ * @param info_freer if non-NULL, a function call on the info to free it
+ * @return a pointer to the newly allocated body
+ */
+body_t *body_init_with_shape(
+    shape_t *shape,
+    double mass,
+    rgb_color_t color,
+    void *info,
+    free_func_t info_freer
+);
+
+/**
+ * Allocates memory for a circle body.
+ * Acts like body_init_with_info(), but the body is a circle instead of a
+ * polygon.
+ *
+ * @param center the center of the circle, which is also its centroid
+ * @param radius the radius of the circle, which must be positive
+ * @param mass the mass of the body (if INFINITY, stops the body from moving)
+ * @param color the color of the body, used to draw it on the screen
+ * @param info additional information to associate with the body
+ * @param info_freer if non-NULL, a function call on the info to free it
+ * @return a pointer to the newly allocated body
+ */
+body_t *body_init_circle(
+    vector_t center,
+    double radius,
+    double mass,
+    rgb_color_t color,
+    void *info,
+    free_func_t info_freer
+);
+
+/**
+ * Allocates memory for a capsule body: every point within a radius of the
+ * segment from start to end.
+ * Acts like body_init_with_info(), but the body is a capsule instead of a
+ * polygon.
+ *
+ * @param start the center of one end cap
+ * @param end the center of the other end cap
+ * @param radius the radius of the capsule, which must be positive
+ * @param mass the mass of the body (if INFINITY, stops the body from moving)
+ * @param color the color of the body, used to draw it on the screen
+ * @param info additional information to associate with the body
+ * @param info_freer if non-NULL, a function call on the info to free it
+ * @return a pointer to the newly allocated body
+ */
+body_t *body_init_capsule(
+    vector_t start,
+    vector_t end,
+    double radius,
+    double mass,
+    rgb_color_t color,
+    void *info,
+    free_func_t info_freer
+);
+
 /**
  * Initializes a body without any info.
  * Acts like body_init_with_info() where info and info_freer are NULL.
@@ -59,6 +151,94 @@ void body_free(body_t *body);
  */
 list_t *body_get_shape(body_t *body);
 
+/**
+ * Gets a read-only view of the current shape of a body.
+ * Unlike body_get_shape(), nothing is copied or allocated: the view borrows
+ * the body's own vertex storage. It must not be freed or modified,
+ * and it is only valid until the body is next moved, rotated, reshaped,
+ * or freed.
+ * For circles and capsules this is the core shape (see body_kind_t).
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the packed polygon describing the body's current position
+ */
+const shape_t *body_get_shape_view(body_t *body);
+
+/**
+ * Gets the kind of geometry a body has.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return whether the body is a polygon, circle or capsule
+ */
+body_kind_t body_get_kind(body_t *body);
+
+/**
+ * Gets the radius of a circle or capsule body.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the body's radius, or 0 if it is a polygon
+ */
+double body_get_radius(body_t *body);
+
+/**
+ * Gets how far a body reaches from its centroid, as gravity measures it to
+ * decide whether two bodies are touching. Polygons are measured in their
+ * local space, so unlike body_get_shape_view() this never moves the shape.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the radius of a circle or capsule, or the distance from a
+ *   polygon's centroid to its first vertex
+ */
+double body_get_reach(body_t *body);
+
+/**
+ * Gets the axis-aligned bounding box of the current shape of a body.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the smallest box containing the body
+ */
+aabb_t body_get_aabb(body_t *body);
+
+/**
+ * Gets the number of convex pieces a body's shape is made of.
+ * Concave polygons are split into convex pieces once, when the body is
+ * created or reshaped (see shape_decompose()), because the collision tests
+ * only work on convex shapes. Every other body is one piece: its shape.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the number of pieces, at least 1
+ */
+size_t body_get_piece_count(body_t *body);
+
+/**
+ * Gets a read-only view of one of a body's convex pieces at the body's
+ * current position. Like body_get_shape_view(), it is only valid until the
+ * body is next moved, rotated, reshaped, or freed.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param index the index of the piece, less than body_get_piece_count()
+ * @return the packed polygon describing the piece
+ */
+const shape_t *body_get_piece_view(body_t *body, size_t index);
+
+/**
+ * Gets the axis-aligned bounding box of one of a body's convex pieces.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param index the index of the piece, less than body_get_piece_count()
+ * @return the smallest box containing the piece
+ */
+aabb_t body_get_piece_aabb(body_t *body, size_t index);
+
+/**
+ * Gets a number that identifies a body.
+ * Every body gets a different id, and ids are never reused.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the body's id
+ */
+size_t body_get_id(body_t *body);
+
 /**
  * Gets the current center of mass of a body.
  * While this could be calculated with polygon_centroid(), that becomes too slow
@@ -121,6 +301,8 @@ void body_set_centroid(body_t *body, vector_t x);
 
 /**
 * Sets a body's point list.
+* The vertices are copied into the body's packed storage and the list is
+* list_free()d. Circles and capsules become polygons.
 *
 * @param body a pointer to a body returned from body_init()
 * @param list the list to set the points to.
@@ -143,7 +325,112 @@ bool body_get_launched(body_t *body);
 void body_set_launched(body_t *body, bool truth);
 
 /**
- *  Gets a body's impact position
+ * Gets whether a body is a bullet (see body_set_bullet()).
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return whether the body is a bullet
+ */
+bool body_is_bullet(body_t *body);
+
+/**
+ * Sets whether a body is a bullet. scene_tick() sweeps bullets along their
+ * velocity and stops the step at their first time of impact, so a fast body
+ * cannot pass through a thin one between two ticks. Sweeping costs a time of
+ * impact test against every body near the bullet's path, so only fast bodies
+ * should be bullets.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param bullet whether the body is a bullet
+ */
+void body_set_bullet(body_t *body, bool bullet);
+
+/**
+ * Sets which collision categories a body belongs to and which it collides
+ * with. Two bodies can only collide if each one's category shares a bit with
+ * the other's mask; the broadphase drops every other pair before it reaches
+ * the narrowphase or any collision creator.
+ * Bodies start in category 1 with a mask of every category, so they collide
+ * with everything. A mask of 0 makes a body collide with nothing.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param category the bits of the categories the body belongs to
+ * @param mask the bits of the categories the body collides with
+ */
+void body_set_collision_filter(body_t *body, uint32_t category,
+    uint32_t mask);
+
+/**
+ * Gets the collision categories a body belongs to.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the body's category bits
+ */
+uint32_t body_get_category(body_t *body);
+
+/**
+ * Gets the collision categories a body collides with.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the body's mask bits
+ */
+uint32_t body_get_mask(body_t *body);
+
+/**
+ * Returns whether the collision filters of two bodies allow them to collide
+ * (see body_set_collision_filter()).
+ *
+ * @param body1 a pointer to a body returned from body_init()
+ * @param body2 a pointer to another body returned from body_init()
+ * @return whether the bodies can collide
+ */
+bool body_can_collide(body_t *body1, body_t *body2);
+
+/**
+ * Gets whether a body is asleep. Sleeping bodies stay put and are skipped by
+ * their scene's force creators and collision tests until they are woken
+ * (see scene_set_sleeping()).
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return whether the body is asleep
+ */
+bool body_is_sleeping(body_t *body);
+
+/**
+ * Puts a body to sleep, stopping it.
+ *
+ * @param body a pointer to a body returned from body_init()
+ */
+void body_sleep(body_t *body);
+
+/**
+ * Wakes a body up and restarts the time it has been still.
+ * Sleeping bodies are also woken when they are moved or given a nonzero
+ * force, impulse, torque or velocity.
+ *
+ * @param body a pointer to a body returned from body_init()
+ */
+void body_wake(body_t *body);
+
+/**
+ * Gets how long a body has been moving slowly enough to sleep.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the time in seconds
+ */
+double body_get_still_time(body_t *body);
+
+/**
+ * Sets how long a body has been moving slowly enough to sleep.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param time the time in seconds
+ */
+void body_set_still_time(body_t *body, double time);
+
+/**
+ *  Gets a body's impact position.
+ *  This is the body's centroid unless body_set_impact_pos() was called
+ *  since the last tick.
  *
  * @param body a pointer to a body returned from body_init()
  */
@@ -175,8 +462,12 @@ void body_set_angular_velocity(body_t *body, double v);
 void body_set_impact_pos(body_t *body, vector_t pos);
 /**
  * Changes a body's orientation in the plane.
- * The body is rotated about its center of mass.
+ * The body is rotated about its rotation point, which is its center of mass
+ * unless body_set_rotation_point() or body_set_impact_pos() moved it.
+ * Rotating about any other point moves the body's centroid around that
+ * point as well.
  * Note that the angle to move is relative to the current orientation.
+ * Only the body's transform changes; its vertices are recomputed lazily.
  *
  * @param body a pointer to a body returned from body_init()
  * @param angle_to_rotate raidian angle to rotate body. Positive is
@@ -310,6 +601,16 @@ double ang_diff(vector_t one, vector_t two);
  */
 void body_tick(body_t *body, double dt);
 
+/**
+ * Moves a body's position, velocity, forces and angular state into a store.
+ * The body_t handle stays valid; only where its state lives changes.
+ * Passing NULL moves the state back into storage owned by the body.
+ *
+ * @param body the body to move
+ * @param store the store to move it into, or NULL
+ */
+void body_set_store(body_t *body, body_store_t *store);
+
 /**
  * Marks a body for removal--future calls to body_is_removed() will return true.
  * Does not free the body.
@@ -329,49 +630,4 @@ void body_remove(body_t *body);
  */
 bool body_is_removed(body_t *body);
 
-/**
- * Sets the collided status of a body to the given status
- *
- * @param body that we want to change
- * @param bool that we want to set the status equal
- */
-void body_collided(body_t *body, bool is_collided);
-
-/**
- * Gets whether the body has collided with anything
- * Will we used to prevent double addition of impulses
- *
- * @param body a pointer to a body that we want to change
- * @return bool that says whether the body is colliding or not
- */
-bool body_is_collided(body_t *body);
-
-
-/**
-* Will take in two bodies that collided in the last tick and store the second
-* one in the first one's "bodies collided with" list.  No return type
-*
-* @param body is a body_t *
-* @param collided is another body_t * that is added to body's list of bodies collided with
-*/
-void body_set_collision_body(body_t *body, body_t *collided);
-
-/**
-* Will return a list of the bodies that a certain body collided with last tick
-*
-* @param body is a body_t *
-* @return a list_t * of the bodies that this body collided with
-*/
-list_t *body_get_collision_bodies(body_t *body);
-
-/**
-* finds the list of bodies that certain body collided with last tick and will
-* return the body at the given index in that list
-*
-* @param body is a body_t *
-* @param index is an integer that is the index in the list
-*/
-void body_remove_collision_body(body_t *body, int index);
-
-
 #endif // #ifndef __BODY_H__
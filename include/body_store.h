@@ -0,0 +1,163 @@
+#ifndef __BODY_STORE_H__
+#define __BODY_STORE_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct body body_t;
+
+/**
+ * The per-body quantities kept in a body_store_t.
+ * These are the values body_tick() reads and writes every tick;
+ * everything else about a body stays in the body_t itself.
+ */
+typedef enum {
+    STORE_CENTROID_X,
+    STORE_CENTROID_Y,
+    STORE_VELOCITY_X,
+    STORE_VELOCITY_Y,
+    STORE_FORCE_X,
+    STORE_FORCE_Y,
+    STORE_IMPULSE_X,
+    STORE_IMPULSE_Y,
+    STORE_INV_MASS,
+    STORE_ANGLE,
+    STORE_ANGULAR_VELOCITY,
+    STORE_TORQUE,
+    STORE_ANGULAR_IMPULSE,
+    STORE_INV_INERTIA,
+    STORE_FIELDS
+} store_field_t;
+
+/**
+ * Flags kept per slot in a body_store_t.
+ * STORE_HAS_IMPACT means the body's impact position was set this tick,
+ * STORE_HAS_PIVOT means its rotation point was moved off its centroid.
+ * Both are cleared by body_store_tick().
+ * STORE_ASLEEP means the body is sleeping, so body_store_tick() skips it;
+ * it stays set until the body wakes.
+ */
+#define STORE_HAS_IMPACT 1
+#define STORE_HAS_PIVOT 2
+#define STORE_ASLEEP 4
+
+/**
+ * Structure-of-arrays storage for the hot state of many bodies.
+ * Each quantity lives in its own dense array, indexed by a body's slot,
+ * so integration runs as tight loops over contiguous doubles.
+ * Bodies keep their body_t handles; only their slot changes when another
+ * body is removed from the store.
+ * body_store_t is defined here so integration loops can index it directly.
+ */
+typedef struct body_store {
+    /** The number of occupied slots */
+    size_t size;
+    /** The number of slots each array has room for */
+    size_t capacity;
+    /** One array of capacity doubles per store_field_t */
+    double *fields[STORE_FIELDS];
+    /** STORE_HAS_* flags for each slot */
+    unsigned char *flags;
+    /** The body occupying each slot */
+    body_t **bodies;
+    /** Whether the arrays were allocated by the store (and must be freed) */
+    bool owns_memory;
+} body_store_t;
+
+/**
+ * Allocates memory for an empty store.
+ * Asserts that the required memory is allocated.
+ *
+ * @param capacity the number of bodies to allocate space for
+ * @return the new store
+ */
+body_store_t *body_store_init(size_t capacity);
+
+/**
+ * Initializes an empty store with room for exactly one body,
+ * backed by memory the caller provides. Used for bodies outside any scene.
+ *
+ * @param store the store to initialize
+ * @param fields an array of STORE_FIELDS doubles
+ * @param flags a single flags byte
+ * @param bodies a single body pointer
+ */
+void body_store_init_single(
+    body_store_t *store,
+    double *fields,
+    unsigned char *flags,
+    body_t **bodies
+);
+
+/**
+ * Releases the memory allocated for a store.
+ * Bodies still in the store are not freed.
+ *
+ * @param store a pointer to a store returned from body_store_init()
+ */
+void body_store_free(body_store_t *store);
+
+/**
+ * Appends a slot for a body, growing the store if necessary.
+ * All of the slot's fields and flags start at 0.
+ *
+ * @param store the store to add to
+ * @param body the body that will occupy the slot
+ * @return the index of the new slot
+ */
+size_t body_store_add(body_store_t *store, body_t *body);
+
+/**
+ * Removes a slot by moving the last slot into its place.
+ *
+ * @param store the store to remove from
+ * @param slot the index of the slot to remove
+ * @return the body that was moved into slot, or NULL if none was moved
+ */
+body_t *body_store_remove(body_store_t *store, size_t slot);
+
+/**
+ * Copies all fields and flags of one slot into another, possibly in a
+ * different store.
+ *
+ * @param to the destination store
+ * @param to_slot the destination slot
+ * @param from the source store
+ * @param from_slot the source slot
+ */
+void body_store_copy_slot(
+    body_store_t *to,
+    size_t to_slot,
+    body_store_t *from,
+    size_t from_slot
+);
+
+/**
+ * Integrates the bodies in slots [start, end) over a time interval.
+ * Applies the accumulated forces, impulses and torques exactly like
+ * body_tick(), then resets them and clears the slots' per-tick flags.
+ * Every slot in the range is integrated, asleep or not.
+ *
+ * @param store the store holding the bodies
+ * @param start the first slot to integrate
+ * @param end one past the last slot to integrate
+ * @param dt the number of seconds elapsed since the last tick
+ */
+void body_store_tick_range(
+    body_store_t *store,
+    size_t start,
+    size_t end,
+    double dt
+);
+
+/**
+ * Integrates every awake body in a store over a time interval.
+ * Runs of awake slots go through body_store_tick_range(); the slots of
+ * sleeping bodies are left untouched.
+ *
+ * @param store the store holding the bodies
+ * @param dt the number of seconds elapsed since the last tick
+ */
+void body_store_tick(body_store_t *store, double dt);
+
+#endif // #ifndef __BODY_STORE_H__
@@ -5,6 +5,7 @@
 #include "vector.h"
 #include "polygon.h"
 #include "list.h"
+#include "shape.h"
 
 #define WINDOW_WIDTH 1000
 #define WINDOW_HEIGHT 500
@@ -41,9 +42,9 @@ double get_color(void);
  *
  * @param sides: a size_t that represents the number of sides of the star
  *
- * @return a vec_list_t that contains all the vertices of the star
+ * @return a packed shape that contains all the vertices of the star
  *
 */
-list_t *create_star(int sides, vector_t center);
+shape_t *create_star(int sides, vector_t center);
 
 #endif // #ifndef __BOUNCE_METHODS_H__
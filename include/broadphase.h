@@ -0,0 +1,216 @@
+#ifndef __BROADPHASE_H__
+#define __BROADPHASE_H__
+
+#include "body.h"
+#include "list.h"
+#include "pair_map.h"
+
+/**
+ * Two bodies whose bounding boxes overlap, and so might be colliding.
+ */
+typedef struct {
+    body_t *body1;
+    body_t *body2;
+} body_pair_t;
+
+/**
+ * A function that starts tracking a body in a broadphase.
+ */
+typedef void (*broadphase_add_t)(void *state, body_t *body);
+
+/**
+ * A function that stops tracking a body in a broadphase.
+ */
+typedef void (*broadphase_remove_t)(void *state, body_t *body);
+
+/**
+ * A function that adds every pair of tracked bodies whose bounding boxes
+ * overlap to a map (see broadphase_add_pair()).
+ */
+typedef void (*broadphase_pairs_t)(void *state, pair_map_t *pairs);
+
+/**
+ * A function called for each body found by broadphase_query().
+ *
+ * @param body the body found
+ * @param aux the auxiliary value passed to broadphase_query()
+ * @return whether to keep looking for more bodies
+ */
+typedef bool (*body_query_t)(body_t *body, void *aux);
+
+/**
+ * A function that calls a body_query_t on every tracked body whose bounding
+ * box (as of the last broadphase_find_pairs()) overlaps a region.
+ */
+typedef void (*broadphase_query_t)(
+    void *state,
+    aabb_t region,
+    body_query_t callback,
+    void *aux
+);
+
+/**
+ * A function called for each body whose bounding box a ray hits in
+ * broadphase_raycast().
+ *
+ * @param body the body hit
+ * @param origin the start of the ray
+ * @param direction the direction of the ray
+ * @param max_t how far along the ray (in multiples of direction) to look
+ * @param aux the auxiliary value passed to broadphase_raycast()
+ * @return the new value of max_t: max_t to keep looking, a smaller value to
+ *   only look for closer bodies, or 0 to stop
+ */
+typedef double (*body_raycast_t)(
+    body_t *body,
+    vector_t origin,
+    vector_t direction,
+    double max_t,
+    void *aux
+);
+
+/**
+ * A function that calls a body_raycast_t on every tracked body whose
+ * bounding box (as of the last broadphase_find_pairs()) a ray hits.
+ */
+typedef void (*broadphase_raycast_t)(
+    void *state,
+    vector_t origin,
+    vector_t direction,
+    double max_t,
+    body_raycast_t callback,
+    void *aux
+);
+
+/**
+ * A broadphase: a structure that finds the pairs of bodies that might be
+ * colliding much faster than testing every pair of polygons.
+ * Each kind of broadphase (e.g. sweep_prune_init()) provides its state and
+ * the functions that operate on it.
+ */
+typedef struct broadphase broadphase_t;
+
+/**
+ * Allocates memory for a broadphase built from an implementation's state
+ * and functions.
+ *
+ * @param state the implementation's state, passed to each function
+ * @param add the function that starts tracking a body
+ * @param remove the function that stops tracking a body
+ * @param find_pairs the function that finds overlapping pairs
+ * @param freer if non-NULL, a function to call on the state to free it
+ * @return a pointer to the newly allocated broadphase
+ */
+broadphase_t *broadphase_init(
+    void *state,
+    broadphase_add_t add,
+    broadphase_remove_t remove,
+    broadphase_pairs_t find_pairs,
+    free_func_t freer
+);
+
+/**
+ * Releases the memory allocated for a broadphase and its state.
+ * Does not free the bodies it tracks.
+ *
+ * @param broadphase a pointer to a broadphase returned from broadphase_init()
+ */
+void broadphase_free(broadphase_t *broadphase);
+
+/**
+ * Gets the implementation state of a broadphase.
+ *
+ * @param broadphase a pointer to a broadphase returned from broadphase_init()
+ * @return the state passed to broadphase_init()
+ */
+void *broadphase_get_state(broadphase_t *broadphase);
+
+/**
+ * Starts tracking a body.
+ *
+ * @param broadphase a pointer to a broadphase returned from broadphase_init()
+ * @param body the body to track
+ */
+void broadphase_add(broadphase_t *broadphase, body_t *body);
+
+/**
+ * Stops tracking a body. Must be called before the body is freed.
+ *
+ * @param broadphase a pointer to a broadphase returned from broadphase_init()
+ * @param body a tracked body
+ */
+void broadphase_remove(broadphase_t *broadphase, body_t *body);
+
+/**
+ * Finds every pair of tracked bodies whose bounding boxes overlap,
+ * using the bodies' current positions.
+ * The pairs are added to a map keyed by pair_key() of the body ids,
+ * with body_pair_t values.
+ *
+ * @param broadphase a pointer to a broadphase returned from broadphase_init()
+ * @param pairs a map created with a value size of sizeof(body_pair_t)
+ */
+void broadphase_find_pairs(broadphase_t *broadphase, pair_map_t *pairs);
+
+/**
+ * Lets a broadphase answer region queries. Broadphases without one make
+ * broadphase_query() return false, and callers fall back to a linear scan.
+ *
+ * @param broadphase a pointer to a broadphase returned from broadphase_init()
+ * @param query the function that finds the bodies in a region
+ */
+void broadphase_set_query(broadphase_t *broadphase, broadphase_query_t query);
+
+/**
+ * Calls a function on every tracked body whose bounding box overlapped a
+ * region at the last broadphase_find_pairs(). Boxes may be fattened, so some
+ * bodies found may not actually overlap the region.
+ *
+ * @param broadphase a pointer to a broadphase returned from broadphase_init()
+ * @param region the box to search
+ * @param callback the function to call on each body found
+ * @param aux an auxiliary value to pass to the callback
+ * @return whether the broadphase supports queries (see broadphase_set_query())
+ */
+bool broadphase_query(broadphase_t *broadphase, aabb_t region,
+    body_query_t callback, void *aux);
+
+/**
+ * Lets a broadphase answer ray queries. Broadphases without one make
+ * broadphase_raycast() return false, and callers fall back to a linear scan.
+ *
+ * @param broadphase a pointer to a broadphase returned from broadphase_init()
+ * @param raycast the function that finds the bodies a ray hits
+ */
+void broadphase_set_raycast(broadphase_t *broadphase,
+    broadphase_raycast_t raycast);
+
+/**
+ * Calls a function on every tracked body whose bounding box a ray hit at the
+ * last broadphase_find_pairs(). Bodies are not visited in any particular
+ * order; the callback can shorten the ray to skip farther ones.
+ *
+ * @param broadphase a pointer to a broadphase returned from broadphase_init()
+ * @param origin the start of the ray
+ * @param direction the direction of the ray (need not be a unit vector)
+ * @param max_t how far along the ray to look, in multiples of direction
+ * @param callback the function to call on each body hit
+ * @param aux an auxiliary value to pass to the callback
+ * @return whether the broadphase supports ray queries
+ *   (see broadphase_set_raycast())
+ */
+bool broadphase_raycast(broadphase_t *broadphase, vector_t origin,
+    vector_t direction, double max_t, body_raycast_t callback, void *aux);
+
+/**
+ * Adds a pair of bodies to a pair map filled by broadphase_find_pairs().
+ * Adding the same pair twice has no effect, and pairs whose collision
+ * filters do not match (see body_can_collide()) are not added.
+ *
+ * @param pairs a map created with a value size of sizeof(body_pair_t)
+ * @param body1 the first body
+ * @param body2 the second body
+ */
+void broadphase_add_pair(pair_map_t *pairs, body_t *body1, body_t *body2);
+
+#endif // #ifndef __BROADPHASE_H__
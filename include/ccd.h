@@ -0,0 +1,60 @@
+#ifndef __CCD_H__
+#define __CCD_H__
+
+#include "body.h"
+
+/**
+ * Finds when two bodies moving at their current velocities will hit, by
+ * conservative advancement: the bodies are repeatedly moved forward by their
+ * distance divided by how fast they are closing along it, which can never
+ * carry them past their first contact.
+ * The bodies are treated as only translating over dt.
+ * The time returned lets the bodies sink slightly into each other, so that
+ * find_collision() reports their collision once they are moved there.
+ *
+ * @param body1 the first body
+ * @param body2 the second body
+ * @param dt how far ahead to look, in seconds
+ * @return the time of impact, between 0 and dt, or INFINITY if the bodies
+ *   do not hit within dt (or are already colliding)
+ */
+double time_of_impact(body_t *body1, body_t *body2, double dt);
+
+/**
+ * Finds when a shape moving at a constant velocity first touches a shape that
+ * stays put, by conservative advancement (see time_of_impact()).
+ * Either shape may be rounded by a radius, as circle and capsule bodies are.
+ *
+ * @param still the shape that does not move
+ * @param still_radius how far the still shape is rounded
+ * @param moving the shape that moves
+ * @param moving_radius how far the moving shape is rounded
+ * @param velocity the moving shape's velocity
+ * @param dt how far ahead to look, in seconds
+ * @param normal where to write the unit normal of the still shape at the
+ *   contact, pointing towards the moving shape
+ * @param point where to write the contact point on the still shape
+ * @return the time at which the shapes touch, between 0 and dt, or INFINITY
+ *   if they do not touch within dt. The shapes must not already overlap.
+ */
+double shape_time_of_impact(const shape_t *still, double still_radius,
+    const shape_t *moving, double moving_radius, vector_t velocity, double dt,
+    vector_t *normal, vector_t *point);
+
+/**
+ * Finds where a ray first enters a convex body.
+ * Rays that start inside the body do not hit it.
+ *
+ * @param body the body to test
+ * @param origin the start of the ray
+ * @param direction the direction of the ray (need not be a unit vector)
+ * @param max_t how far along the ray to look, in multiples of direction
+ * @param normal where to write the unit normal of the body where the ray
+ *   enters it
+ * @return how far along the ray it enters the body, in multiples of
+ *   direction, or INFINITY if it does not within max_t
+ */
+double ray_time_of_impact(body_t *body, vector_t origin, vector_t direction,
+    double max_t, vector_t *normal);
+
+#endif // #ifndef __CCD_H__
@@ -3,6 +3,7 @@
 
 #include <stdbool.h>
 #include "list.h"
+#include "shape.h"
 #include "vector.h"
 #include "body.h"
 #include "scene.h"
@@ -21,6 +22,18 @@
       * If collided is false, this value is undefined.
       */
      vector_t axis;
+     /**
+      * If the shapes are colliding, how far they overlap along the axis.
+      * If collided is false, this value is undefined.
+      */
+     double depth;
+     /**
+      * If the shapes are colliding, how many points they touch at (1 or 2).
+      * If collided is false, this is 0.
+      */
+     size_t contact_count;
+     /** The contact points, in world coordinates */
+     vector_t contacts[2];
  } collision_info_t;
 
 /**
@@ -64,8 +77,21 @@ double extrema(double a, double b, int type);
 bool onSegment(vector_t p, vector_t q, vector_t r);
 int orientation(vector_t p, vector_t q, vector_t r);
 bool do_intersect(vector_t p1, vector_t q1, vector_t p2, vector_t q2);
-vector_t point_of_intersect(vector_t p1, vector_t q1, vector_t p2, vector_t q2);
-vector_t bodies_intersect(body_t *bod1, body_t *bod2);
+
+/**
+ * Finds the closest points between two segments, either of which may be a
+ * single point (when its ends are equal).
+ *
+ * @param p1 the start of the first segment
+ * @param q1 the end of the first segment
+ * @param p2 the start of the second segment
+ * @param q2 the end of the second segment
+ * @param c1 where to write the closest point on the first segment
+ * @param c2 where to write the closest point on the second segment
+ * @return the squared distance between c1 and c2
+ */
+double closest_segment_points(vector_t p1, vector_t q1, vector_t p2,
+    vector_t q2, vector_t *c1, vector_t *c2);
 
 /**
  * Mathematical function that tries the max or min of a list doubles
@@ -82,49 +108,108 @@ vector_t bodies_intersect(body_t *bod1, body_t *bod2);
 double find_extrema(list_t *numbers, int type);
 
 /**
-* This function will add the magnitude (postive and negative) of a projection
-* of each point in a polygon onto a given line.
+* Projects every point of a polygon onto a line, in a single pass.
+* The extent is scaled by the line's length, so divide it by
+* vec_magnitude(line) to get distances.
 *
 * @param line is a vector that other points will project onto
-* @param shape is a pointer to a list that contains the points of a shape
-* @param magnitude is a pointer to a list of doubles that will be added to
-*/
-void add_mag(vector_t line, list_t *shape, list_t *magnitude);
-
-/**
-* This function will find add lines that are perpendicular to every edge in the
-* passed in polygon to a list
-*
-* @param perp_vectors is a pointer to a list that will hold vectors
-* @param shape is a pointer to a list of vectors that represents a polygon
+* @param shape is a pointer to a packed polygon
+* @param min is set to the smallest projection
+* @param max is set to the largest projection
 */
-void perpendicular_lines(list_t *perp_vectors, list_t *shape);
+void project_shape(vector_t line, const shape_t *shape, double *min,
+  double *max);
 
 /**
 * This function will project every point from both polygons onto a given line.
-* It then determines whether these projections overlap. It returns true if they
-* do and false if they do not.
+* It then determines how much these projections overlap. Allocates nothing.
 *
 * @param line is a vector that will be projected onto
-* @param shape1 is a list pointer that represents a polygon
-* @param shape2 is a list pointer that represents a polygon
-* @return true if the polygons overlap when projected onto the given line
-* and false if they do not.
+* @param shape1 is a pointer to a packed polygon
+* @param shape2 is a pointer to a packed polygon
+* @return how far the projections overlap along the line, which is negative
+* if there is a gap between them
 */
-double overlap(vector_t line, list_t *shape1, list_t *shape2);
+double overlap(vector_t line, const shape_t *shape1, const shape_t *shape2);
 
+/**
+ * Finds where two colliding convex polygons touch, by clipping the edge of one
+ * polygon that faces the other (the incident edge) against the sides of the
+ * other polygon's facing edge (the reference edge). Edge-on-edge contacts give
+ * 2 points and vertex-on-edge contacts give 1.
+ * Sets the contact_count and contacts of the collision information.
+ *
+ * @param shape1 the first polygon
+ * @param shape2 the second polygon
+ * @param axis the collision axis, a unit vector pointing from shape1 towards
+ *   shape2
+ * @param information the collision information to fill in
+ */
+void contact_manifold(const shape_t *shape1, const shape_t *shape2,
+    vector_t axis, collision_info_t *information);
 
 /**
- * Computes the status of the collision between two convex polygons.
+ * A collision test between two convex shapes, each grown by a radius
+ * (0 for polygons, see body_kind_t).
+ */
+typedef collision_info_t (*piece_test_t)(const shape_t *shape1,
+    double radius1, const shape_t *shape2, double radius2);
+
+/**
+ * Tests two bodies piece by piece (see body_get_piece_count()), running a
+ * test on each pair of convex pieces whose bounding boxes overlap.
+ * The collision tests call this for bodies made of several pieces.
+ *
+ * @param body1 the first body
+ * @param body2 the second body
+ * @param test the test to run on each pair of pieces
+ * @return the deepest collision between the bodies' pieces, if any
+ */
+collision_info_t find_piece_collision(body_t *body1, body_t *body2,
+    piece_test_t test);
+
+/**
+ * Computes the status of the collision between two polygons. Concave
+ * polygons are tested piece by piece (see find_piece_collision()).
  * The shapes are given as lists of vertices in counterclockwise order.
  * There is an edge between each pair of consecutive vertices,
  * and one between the first vertex and the last vertex.
  *
  * @param shape1 the first shape
  * @param shape2 the second shape
- * @return whether the shapes are colliding, and if so, the collision axis.
+ * @return whether the shapes are colliding, and if so, the collision axis
+ * and depth.
  * The axis should be a unit vector pointing from shape1 towards shape2.
  */
 collision_info_t find_collision(body_t *body1, body_t *body2);
 
+/**
+ * Computes the collision between two bodies, at least one of which is a
+ * circle or capsule, in closed form from the closest points of their cores.
+ * Cores that overlap fall back to a separating axis test that accounts for
+ * the rounded edges.
+ * find_collision() and find_collision_gjk() call this for such pairs.
+ *
+ * @param body1 the first body
+ * @param body2 the second body
+ * @return whether the bodies are colliding, and if so, the collision axis
+ *   (pointing from body1 towards body2) and depth
+ */
+collision_info_t find_round_collision(body_t *body1, body_t *body2);
+
+/**
+ * Computes the same result as find_collision(), but first tests the axis
+ * that separated the bodies the last time they were tested with this cache.
+ * Pairs that are still separated along it skip the other edge normals.
+ * The cache's separating axis hit and miss counters are updated.
+ *
+ * @param cache the contact cache to remember separating axes in,
+ *   e.g. scene_get_contacts()
+ * @param body1 the first body
+ * @param body2 the second body
+ * @return whether the bodies are colliding, and if so, the collision axis
+ */
+collision_info_t find_collision_cached(contact_cache_t *cache, body_t *body1,
+  body_t *body2);
+
 #endif // #ifndef __COLLISION_H__
@@ -0,0 +1,219 @@
+#ifndef __CONTACT_CACHE_H__
+#define __CONTACT_CACHE_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "body.h"
+#include "vector.h"
+
+/**
+ * Where a contact is in its life.
+ * CONTACT_NEW: the bodies started touching this tick.
+ * CONTACT_PERSISTING: the bodies were already touching last tick.
+ * CONTACT_ENDED: the bodies separated this tick; the contact is dropped
+ *   at the start of the next tick.
+ */
+typedef enum {
+    CONTACT_NEW,
+    CONTACT_PERSISTING,
+    CONTACT_ENDED
+} contact_state_t;
+
+/**
+ * What the scene remembers about a pair of touching bodies.
+ */
+typedef struct {
+    /** The bodies, in the order they first touched in */
+    body_t *body1;
+    body_t *body2;
+    contact_state_t state;
+    /** The latest collision axis, pointing from body1 towards body2 */
+    vector_t axis;
+    /** The total impulse applied to body1 over the contact (body2 got -impulse) */
+    vector_t impulse;
+    /** The tick in which the bodies were last seen touching */
+    size_t last_tick;
+    /** Whether the collision has been resolved (e.g. bounced) already */
+    bool resolved;
+    /** How many points the bodies touched at in the latest test (0 to 2) */
+    size_t point_count;
+    /** The latest contact points, in world coordinates */
+    vector_t points[2];
+} contact_t;
+
+/**
+ * The edge normal that last separated a pair of bodies.
+ * Separated pairs usually stay separated along the same axis for many ticks,
+ * so testing it first lets most narrowphase tests stop after one axis.
+ */
+typedef struct {
+    /** Whether an axis has been recorded */
+    bool valid;
+    /** The id of the body whose edge gives the axis */
+    size_t body_id;
+    /** The index of the edge's first vertex in the body's shape */
+    size_t edge;
+} separating_axis_t;
+
+/**
+ * A hash map from pairs of bodies to their contact_t, with O(1) lookups.
+ * Each scene owns one (see scene_get_contacts()); it is the only record of
+ * which bodies are touching and which collisions were already resolved.
+ */
+typedef struct contact_cache contact_cache_t;
+
+/**
+ * Allocates memory for an empty contact cache.
+ *
+ * @return a pointer to the newly allocated cache
+ */
+contact_cache_t *contact_cache_init(void);
+
+/**
+ * Releases the memory allocated for a contact cache. Does not free bodies.
+ *
+ * @param cache a pointer to a cache returned from contact_cache_init()
+ */
+void contact_cache_free(contact_cache_t *cache);
+
+/**
+ * Gets the number of contacts in a cache, including ended ones.
+ *
+ * @param cache a pointer to a cache returned from contact_cache_init()
+ * @return the number of contacts
+ */
+size_t contact_cache_size(contact_cache_t *cache);
+
+/**
+ * Gets the current tick number, which starts at 0 and is advanced by
+ * contact_cache_tick().
+ *
+ * @param cache a pointer to a cache returned from contact_cache_init()
+ * @return the current tick
+ */
+size_t contact_cache_get_tick(contact_cache_t *cache);
+
+/**
+ * Gets the contact between two bodies, in either order.
+ * The pointer is only valid until the cache is next modified.
+ *
+ * @param cache a pointer to a cache returned from contact_cache_init()
+ * @param body1 a body
+ * @param body2 another body
+ * @return the bodies' contact, or NULL if they are not touching
+ */
+contact_t *contact_cache_get(contact_cache_t *cache, body_t *body1,
+    body_t *body2);
+
+/**
+ * Records that two bodies are touching this tick.
+ * A pair with no contact (or an ended one) gets a new contact; a pair that
+ * was touching in an earlier tick becomes CONTACT_PERSISTING.
+ * The pointer is only valid until the cache is next modified.
+ *
+ * @param cache a pointer to a cache returned from contact_cache_init()
+ * @param body1 a body
+ * @param body2 another body
+ * @param axis the collision axis, pointing from body1 towards body2
+ * @return the bodies' contact
+ */
+contact_t *contact_cache_touch(contact_cache_t *cache, body_t *body1,
+    body_t *body2, vector_t axis);
+
+/**
+ * Records that two bodies are not touching. Their contact, if any, ends.
+ *
+ * @param cache a pointer to a cache returned from contact_cache_init()
+ * @param body1 a body
+ * @param body2 another body
+ */
+void contact_cache_separate(contact_cache_t *cache, body_t *body1,
+    body_t *body2);
+
+/**
+ * Starts a new tick: drops ended contacts, and ends contacts whose bodies
+ * were not seen touching during the tick that just finished.
+ * Every few ticks, also drops the separating axes that were not looked up
+ * in the meantime, so pairs that are no longer tested do not keep theirs.
+ *
+ * @param cache a pointer to a cache returned from contact_cache_init()
+ */
+void contact_cache_tick(contact_cache_t *cache);
+
+/**
+ * Gets the separating axis remembered for two bodies, in either order,
+ * adding an invalid one if the pair has none yet.
+ * The pointer is only valid until the cache is next modified.
+ *
+ * @param cache a pointer to a cache returned from contact_cache_init()
+ * @param body1 a body
+ * @param body2 another body
+ * @return the pair's separating axis
+ */
+separating_axis_t *contact_cache_separating_axis(contact_cache_t *cache,
+    body_t *body1, body_t *body2);
+
+/**
+ * Counts a lookup of a remembered separating axis.
+ *
+ * @param cache a pointer to a cache returned from contact_cache_init()
+ * @param hit whether the remembered axis still separated the pair
+ */
+void contact_cache_count_axis(contact_cache_t *cache, bool hit);
+
+/**
+ * Gets how many narrowphase tests were ended by a remembered separating
+ * axis. Together with contact_cache_axis_misses() this gives the hit rate.
+ *
+ * @param cache a pointer to a cache returned from contact_cache_init()
+ * @return the number of hits
+ */
+size_t contact_cache_axis_hits(contact_cache_t *cache);
+
+/**
+ * Gets how many narrowphase tests had to check every axis, because the pair
+ * had no remembered axis, or it no longer separated the pair.
+ *
+ * @param cache a pointer to a cache returned from contact_cache_init()
+ * @return the number of misses
+ */
+size_t contact_cache_axis_misses(contact_cache_t *cache);
+
+/**
+ * Drops every contact and separating axis involving a body. Must be called
+ * before the body is freed. Takes time proportional to the number of pairs
+ * the body is in, not to the size of the cache.
+ *
+ * @param cache a pointer to a cache returned from contact_cache_init()
+ * @param body the body being removed
+ */
+void contact_cache_remove_body(contact_cache_t *cache, body_t *body);
+
+/**
+ * Drops every contact and separating axis.
+ *
+ * @param cache a pointer to a cache returned from contact_cache_init()
+ */
+void contact_cache_clear(contact_cache_t *cache);
+
+/**
+ * Gets the number of slots in a cache, for iterating with
+ * contact_cache_slot().
+ *
+ * @param cache a pointer to a cache returned from contact_cache_init()
+ * @return the number of slots
+ */
+size_t contact_cache_capacity(contact_cache_t *cache);
+
+/**
+ * Gets the contact in a slot of a cache, if the slot is occupied.
+ * Iterating over every slot from 0 to contact_cache_capacity() visits every
+ * contact once, as long as the cache is not modified in between.
+ *
+ * @param cache a pointer to a cache returned from contact_cache_init()
+ * @param index the slot to read
+ * @return the contact in the slot, or NULL if the slot is empty
+ */
+contact_t *contact_cache_slot(contact_cache_t *cache, size_t index);
+
+#endif // #ifndef __CONTACT_CACHE_H__
@@ -3,17 +3,6 @@
 
 #include "scene.h"
 
-/**
- * A function called when a collision occurs.
- * @param body1 the first body passed to create_collision()
- * @param body2 the second body passed to create_collision()
- * @param axis a unit vector pointing from body1 towards body2
- *   that defines the direction the two bodies are colliding in
- * @param aux the auxiliary value passed to create_collision()
- */
-typedef void (*collision_handler_t)
-    (body_t *body1, body_t *body2, vector_t axis, void *aux);
-
 typedef struct auxillary auxillary_t;
 
 /**
@@ -131,6 +120,30 @@ void create_newtonian_gravity(scene_t *scene, double G, body_t *body1, body_t *b
  */
 void calc_gravity_force(void *aux);
 
+/**
+ * Adds the Newtonian gravitational force between two bodies to both of them,
+ * whatever their distance. This is the force calc_gravity_force() applies to
+ * bodies that are not touching.
+ *
+ * @param constant the gravitational proportionality constant
+ * @param body1 the first body
+ * @param body2 the second body
+ */
+void grav_calc_helper(double constant, body_t *body1, body_t *body2);
+
+/**
+ * Adds a single force creator to a scene that applies gravity between every
+ * pair of its bodies, including ones added later, as create_newtonian_gravity()
+ * would on each pair. A Barnes-Hut quadtree rebuilt every tick pulls each
+ * body by distant groups of bodies at once, so a tick costs O(n log n)
+ * rather than O(n^2) (see barnes_hut_init()).
+ *
+ * @param scene the scene containing the bodies
+ * @param G the gravitational proportionality constant
+ * @param theta the opening angle; 0 is exact, larger is faster and coarser
+ */
+void create_barnes_hut_gravity(scene_t *scene, double G, double theta);
+
 /**
  * Adds a force creator to a scene that applies gravity between two bodies,
  adjusted to be realistic for a scene of earth.
@@ -161,6 +174,31 @@ void create_earth_gravity(scene_t *scene, double G, body_t *body1, body_t *body2
  */
 void calc_earth_force(void *aux);
 
+/**
+ * Adds a force creator to a scene that pulls every body whose category
+ * shares a bit with mask downwards (towards -y) with a force of its mass
+ * times g, e.g. for gravity near the ground.
+ * Unlike create_earth_gravity(), it needs no floor body: one pass over the
+ * scene's bodies covers all of them, including ones added later, and the
+ * ground is left to the collision system (see scene_add_collision_rule()).
+ * Bodies of infinite mass and sleeping bodies are not pulled.
+ *
+ * @param scene the scene containing the bodies
+ * @param g the acceleration due to gravity
+ * @param mask the category bits of the bodies to pull
+ */
+void create_uniform_gravity(scene_t *scene, double g, uint32_t mask);
+
+/**
+ * This is a method that pulls the bodies of the scene passed through
+ * create_uniform_gravity downwards.
+ *
+ * @param aux the auxillary holding the scene, g and the mask
+ *
+ * @return void
+ */
+void calc_uniform_gravity(void *aux);
+
 /**
  * Adds a force creator to a scene that acts like a spring between two bodies.
  * The force creator will be called each tick
@@ -206,6 +244,7 @@ void create_drag(scene_t *scene, double gamma, body_t *body);
 /**
  * This is a method that calcualtes the forces on the bodies passed through
  * create_drag and applies the force to the bodies.
+ * Sleeping bodies are left alone, so drag never wakes them.
  *
  * @param: forcer, a pointer to a force_holder_t that has the following
  ** @contains void *aux for the constant
@@ -219,12 +258,15 @@ void calc_drag_force(void *aux);
 
 
 /**
- * Adds a force creator to a scene that calls a given collision handler
- * function each time two bodies collide.
+ * Makes a scene call a given collision handler function each time two bodies
+ * collide.
  * This generalizes create_destructive_collision() from last week,
  * allowing different things to happen on a collision.
  * The handler is passed the bodies, the collision axis, and an auxiliary value.
- * It should only be called once while the bodies are still colliding.
+ * It is called once per tick while the bodies are colliding, by the scene's
+ * collision system rather than a force creator per pair.
+ * Registering the same bodies and handler again does nothing but free aux
+ * (see scene_register_collision()).
  *
  * @param scene the scene containing the bodies
  * @param body1 the first body
@@ -242,19 +284,6 @@ void create_collision(
     free_func_t freer
 );
 
-/**
- * Calculates the collision using the force handler
- * Allows us to have the abstraction for the collisions using the
- * collision_handler_t and its parameters. Calls methods that will add
- * the forces to the body.
- *
- * @param an aux that carries all the things that we need. In create
- * collision we will use auxillary_t to transfer information from the
- * user aux to the implementor aux allow us to interface between the
- * layers.
- */
-void calc_collison(void *aux);
-
 /**
  * Adds a force creator to a scene that destroys two bodies when they collide.
  * The bodies should be destroyed by calling body_remove().
@@ -305,11 +334,32 @@ void create_physics_collision(
     body_t *body2
 );
 
+/**
+ * Adds a collision rule to a scene that applies impulses to resolve
+ * collisions between every body in one category and every body in another,
+ * like create_physics_collision() does for a single pair
+ * (see scene_add_collision_rule()).
+ *
+ * @param scene the scene containing the bodies
+ * @param elasticity the "coefficient of restitution" of the collisions
+ * @param category1 the category bits of one side of the collisions
+ * @param category2 the category bits of the other side of the collisions
+ */
+void create_physics_collision_rule(
+    scene_t *scene,
+    double elasticity,
+    uint32_t category1,
+    uint32_t category2
+);
+
 /**
  * Calculates the impulses associated with a given collision
  * Uses the aux to get the bodies and constants needed
  * Gets the axis by getting the collision between the two
- * Might need to be changed.
+ * Only applies an impulse once per contact (see scene_get_contacts()),
+ * so bodies that stay overlapping are not bounced again every tick.
+ * The impulse is applied at the middle of the contact points, which also
+ * decides how much it spins the bodies.
  *
  * @param body1 the first body
  * @param body2 the second body
@@ -0,0 +1,27 @@
+#ifndef __GJK_H__
+#define __GJK_H__
+
+#include "body.h"
+#include "collision.h"
+
+/**
+ * Computes the status of the collision between two bodies with the
+ * Gilbert-Johnson-Keerthi algorithm, and their penetration with the
+ * expanding polytope algorithm.
+ * Unlike the separating axis test, which projects both shapes onto every
+ * edge normal, GJK and EPA only ever ask for each shape's furthest vertex in
+ * a direction, so a test costs close to O(n + m) for shapes with n and m
+ * vertices. This makes them the better choice for round shapes with many
+ * vertices (see scene_set_narrowphase()).
+ *
+ * Concave polygons are tested piece by piece (see find_piece_collision()).
+ * As with find_collision(), shapes that only touch collide with depth 0.
+ *
+ * @param body1 the first body
+ * @param body2 the second body
+ * @return whether the bodies are colliding, and if so, the collision axis
+ *   (a unit vector pointing from body1 towards body2) and the depth
+ */
+collision_info_t find_collision_gjk(body_t *body1, body_t *body2);
+
+#endif // #ifndef __GJK_H__
@@ -56,6 +56,18 @@ size_t list_size(list_t *list);
  */
 void *list_get(list_t *list, size_t index);
 
+/**
+ * Replaces the element at a given index in a list.
+ * The old element is not freed.
+ * Asserts that the index is valid, given the list's current size, and that
+ * the value is non-NULL.
+ *
+ * @param list a pointer to a list returned from list_init()
+ * @param index an index in the list (the first element is at 0)
+ * @param value the element to put at the given index
+ */
+void list_set(list_t *list, size_t index, void *value);
+
 /**
  * Removes the element at a given index in a list and returns it,
  * moving all subsequent elements towards the start of the list.
@@ -0,0 +1,120 @@
+#ifndef __PAIR_MAP_H__
+#define __PAIR_MAP_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * A hash map from 64-bit keys to fixed-size values, used to look up
+ * per-pair state (e.g. "are these two bodies close this tick?") in O(1).
+ * Keys are usually built with pair_key() from two body ids.
+ * Values are stored inline in the map, so adding an entry never allocates
+ * unless the map has to grow.
+ */
+typedef struct pair_map pair_map_t;
+
+/**
+ * Builds the key for an unordered pair of ids.
+ * pair_key(a, b) == pair_key(b, a). Asserts that both ids fit in 32 bits,
+ * so that distinct pairs never share a key.
+ *
+ * @param id1 the first id, less than 2^32
+ * @param id2 the second id, less than 2^32
+ * @return a key identifying the pair
+ */
+uint64_t pair_key(size_t id1, size_t id2);
+
+/**
+ * Allocates memory for an empty map.
+ * Asserts that the required memory is allocated.
+ *
+ * @param initial_size the number of entries to allocate space for
+ * @param value_size the size in bytes of each value (0 for a set of keys)
+ * @return a pointer to the newly allocated map
+ */
+pair_map_t *pair_map_init(size_t initial_size, size_t value_size);
+
+/**
+ * Releases the memory allocated for a map.
+ *
+ * @param map a pointer to a map returned from pair_map_init()
+ */
+void pair_map_free(pair_map_t *map);
+
+/**
+ * Gets the number of entries in a map.
+ *
+ * @param map a pointer to a map returned from pair_map_init()
+ * @return the number of keys in the map
+ */
+size_t pair_map_size(pair_map_t *map);
+
+/**
+ * Returns whether a map has an entry for a key.
+ *
+ * @param map a pointer to a map returned from pair_map_init()
+ * @param key the key to look up
+ * @return whether the key is in the map
+ */
+bool pair_map_contains(pair_map_t *map, uint64_t key);
+
+/**
+ * Gets the value stored for a key.
+ * The pointer is only valid until the map is next modified.
+ *
+ * @param map a pointer to a map returned from pair_map_init()
+ * @param key the key to look up
+ * @return a pointer to the key's value, or NULL if the key is not in the map
+ */
+void *pair_map_get(pair_map_t *map, uint64_t key);
+
+/**
+ * Gets the value stored for a key, adding an entry if there is none.
+ * New values are zero-filled.
+ * The pointer is only valid until the map is next modified.
+ *
+ * @param map a pointer to a map returned from pair_map_init()
+ * @param key the key to look up or add
+ * @return a pointer to the key's value
+ */
+void *pair_map_put(pair_map_t *map, uint64_t key);
+
+/**
+ * Removes the entry for a key, if there is one.
+ *
+ * @param map a pointer to a map returned from pair_map_init()
+ * @param key the key to remove
+ * @return whether an entry was removed
+ */
+bool pair_map_remove(pair_map_t *map, uint64_t key);
+
+/**
+ * Removes every entry from a map, keeping its memory.
+ *
+ * @param map a pointer to a map returned from pair_map_init()
+ */
+void pair_map_clear(pair_map_t *map);
+
+/**
+ * Gets the number of slots in a map, for iterating with pair_map_slot().
+ *
+ * @param map a pointer to a map returned from pair_map_init()
+ * @return the number of slots
+ */
+size_t pair_map_capacity(pair_map_t *map);
+
+/**
+ * Gets the entry in a slot of a map, if the slot is occupied.
+ * Iterating over every slot from 0 to pair_map_capacity() visits every
+ * entry once, as long as the map is not modified in between.
+ *
+ * @param map a pointer to a map returned from pair_map_init()
+ * @param index the slot to read
+ * @param key set to the entry's key if the slot is occupied (may be NULL)
+ * @param value set to the entry's value if the slot is occupied (may be NULL)
+ * @return whether the slot is occupied
+ */
+bool pair_map_slot(pair_map_t *map, size_t index, uint64_t *key, void **value);
+
+#endif // #ifndef __PAIR_MAP_H__
@@ -1,8 +1,10 @@
 #ifndef __POLYGON_H__
 #define __POLYGON_H__
 
+#include <stdbool.h>
 #include <stddef.h>
 #include "list.h"
+#include "shape.h"
 #include "vector.h"
 
 /**
@@ -47,4 +49,66 @@ void polygon_translate(list_t *polygon, vector_t translation);
  */
 void polygon_rotate(list_t *polygon, double angle, vector_t point);
 
+/**
+ * Computes the area of a packed polygon.
+ * Equivalent to polygon_area(), but walks the contiguous vertex array.
+ *
+ * @param shape the polygon, with vertices listed counterclockwise
+ * @return the area of the polygon
+ */
+double shape_area(const shape_t *shape);
+
+/**
+ * Computes the center of mass of a packed polygon.
+ * Equivalent to polygon_centroid(), but walks the contiguous vertex array.
+ *
+ * @param shape the polygon, with vertices listed counterclockwise
+ * @return the centroid of the polygon
+ */
+vector_t shape_centroid(const shape_t *shape);
+
+/**
+ * Translates all vertices in a packed polygon by a given vector.
+ * Note: mutates the original polygon.
+ *
+ * @param shape the polygon to translate
+ * @param translation the vector to add to each vertex's position
+ */
+void shape_translate(shape_t *shape, vector_t translation);
+
+/**
+ * Rotates vertices in a packed polygon by a given angle about a given point.
+ * Note: mutates the original polygon.
+ *
+ * @param shape the polygon to rotate
+ * @param angle the angle to rotate the polygon, in radians.
+ * A positive angle means counterclockwise.
+ * @param point the point to rotate around
+ */
+void shape_rotate(shape_t *shape, double angle, vector_t point);
+
+/**
+ * Returns whether a packed polygon is convex, i.e. turns the same way at
+ * every vertex. Straight corners are allowed.
+ *
+ * @param shape the polygon, with vertices listed in either direction
+ * @return whether the polygon is convex
+ */
+bool shape_is_convex(const shape_t *shape);
+
+/**
+ * Splits a simple packed polygon into convex pieces with the Hertel-Mehlhorn
+ * algorithm: the polygon is triangulated by ear clipping, then neighbouring
+ * pieces are merged whenever the result stays convex. This uses at most four
+ * times as many pieces as the fewest possible, and no new vertices.
+ * Takes O(n^3) time for n vertices, so it is meant to run once per shape.
+ *
+ * @param shape the polygon, with vertices listed in either direction
+ * @return a list of newly allocated pieces (shape_t pointers, freed by
+ *   list_free()) with vertices listed counterclockwise. If the polygon is
+ *   convex, or intersects itself so cannot be split, the list holds a single
+ *   copy of it.
+ */
+list_t *shape_decompose(const shape_t *shape);
+
 #endif // #ifndef __POLYGON_H__
@@ -2,6 +2,8 @@
 #define __SCENE_H__
 
 #include "body.h"
+#include "broadphase.h"
+#include "contact_cache.h"
 #include "list.h"
 
 
@@ -20,6 +22,46 @@ typedef void (*force_creator_t)(void *aux);
 */
 typedef struct force_holder force_holder_t;
 
+/**
+ * A function called when a collision occurs.
+ * @param body1 the first body passed to create_collision(), or the body in
+ *   the first category of a collision rule (see scene_add_collision_rule())
+ * @param body2 the second body passed to create_collision(), or the body in
+ *   the second category of a collision rule
+ * @param axis a unit vector pointing from body1 towards body2
+ *   that defines the direction the two bodies are colliding in
+ * @param aux the auxiliary value passed to create_collision()
+ */
+typedef void (*collision_handler_t)
+    (body_t *body1, body_t *body2, vector_t axis, void *aux);
+
+/**
+ * The algorithm collision creators use to test whether two bodies collide.
+ * NARROWPHASE_SAT: the separating axis test, which projects both shapes
+ *   onto every edge normal; cheap for boxes and other low-vertex shapes.
+ * NARROWPHASE_GJK: GJK with EPA (see find_collision_gjk()), which costs
+ *   close to O(n + m) and suits circles and stars with many vertices.
+ */
+typedef enum {
+    NARROWPHASE_SAT,
+    NARROWPHASE_GJK
+} narrowphase_t;
+
+/**
+ * The first body hit by a ray or a swept body (see scene_raycast() and
+ * scene_shapecast()).
+ */
+typedef struct {
+    /** The body hit */
+    body_t *body;
+    /** How far along the path the hit is, from 0 at its start to 1 at its end */
+    double fraction;
+    /** Where the body was hit */
+    vector_t point;
+    /** The unit normal of the body where it was hit, facing back along the path */
+    vector_t normal;
+} raycast_hit_t;
+
 /**
  * A function which adds some forces or impulses to bodies,
  * e.g. from collisions, gravity, or spring forces.
@@ -35,6 +77,18 @@ typedef struct force_holder force_holder_t;
  */
 scene_t *scene_init(void);
 
+/**
+ * Allocates memory for an empty scene that stores its bodies' positions,
+ * velocities, forces and angular state in parallel dense arrays.
+ * Bodies added to the scene move their state into those arrays, so
+ * scene_tick() can integrate every body in a few tight loops.
+ * The body_t handles work exactly as they do in a scene_init() scene.
+ *
+ * @param capacity the number of bodies to allocate space for
+ * @return the new scene
+ */
+scene_t *scene_init_soa(size_t capacity);
+
 force_holder_t *force_holder_init(
   force_creator_t force,
   free_func_t freer,
@@ -164,7 +218,202 @@ void scene_add_bodies_force_creator(
 );
 
 /**
- * Clears a scene of all the bodies and forces associated with it
+ * Gives a scene a broadphase, replacing (and freeing) any it had before.
+ * The broadphase tracks every body in the scene. At the start of each tick
+ * it finds the pairs of bodies whose bounding boxes overlap, and collision
+ * creators skip the polygon test for every other pair
+ * (see scene_may_collide()).
+ * The scene takes ownership of the broadphase.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param broadphase e.g. sweep_prune_init(), or NULL to test every pair
+ */
+void scene_set_broadphase(scene_t *scene, broadphase_t *broadphase);
+
+/**
+ * Returns whether two bodies in a scene might be colliding this tick,
+ * i.e. whether the scene's broadphase found their bounding boxes
+ * overlapping. Without a broadphase, only the bodies' collision filters
+ * are checked (see body_can_collide()).
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param body1 a body in the scene
+ * @param body2 another body in the scene
+ * @return false if the bodies are certainly not colliding
+ */
+bool scene_may_collide(scene_t *scene, body_t *body1, body_t *body2);
+
+/**
+ * Chooses how a scene's collision creators test pairs of bodies.
+ * Scenes start out using NARROWPHASE_SAT.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param narrowphase the algorithm to use
+ */
+void scene_set_narrowphase(scene_t *scene, narrowphase_t narrowphase);
+
+/**
+ * Gets how a scene's collision creators test pairs of bodies.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the algorithm in use
+ */
+narrowphase_t scene_get_narrowphase(scene_t *scene);
+
+/**
+ * Turns sleeping on or off for a scene's bodies. Scenes start with it off.
+ * While it is on, scene_tick() groups the bodies that touch each other into
+ * islands, and puts an island to sleep once every body in it has moved slowly
+ * for a while. Sleeping bodies are not integrated, force creators and
+ * collision handlers whose bodies are all asleep or immovable (of infinite
+ * mass) are skipped, and touching pairs of them are not tested again, so a settled
+ * scene costs little to tick.
+ * An island wakes as a whole when any body in it is woken (see body_wake()),
+ * e.g. by a collision with an awake body. Immovable bodies never sleep and do
+ * not join islands; one moved by hand should have the bodies resting on it
+ * woken.
+ * Turning sleeping off wakes every body.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param sleeping whether bodies can sleep
+ */
+void scene_set_sleeping(scene_t *scene, bool sleeping);
+
+/**
+ * Gets the contacts between a scene's bodies: which pairs are touching,
+ * since when, and whether their collision has been resolved.
+ * Collision creators keep it up to date, and scene_tick() drops contacts
+ * that ended and contacts of removed bodies.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the scene's contact cache
+ */
+contact_cache_t *scene_get_contacts(scene_t *scene);
+
+/**
+ * Tests whether two bodies in a scene are touching, using the scene's
+ * broadphase and narrowphase, and records the result in its contacts.
+ * Each pair is tested at most once between two moves of the bodies:
+ * a pair already found touching reuses that result.
+ * Collision creators call this, so they share their tests with each other
+ * and with scene_collect_contacts().
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param body1 a body in the scene
+ * @param body2 another body in the scene
+ * @return the pair's contact, or NULL if the bodies are not touching.
+ *   The pointer is only valid until the scene's contacts are next modified.
+ */
+contact_t *scene_test_pair(scene_t *scene, body_t *body1, body_t *body2);
+
+/**
+ * Finds every pair of bodies in a scene that is touching.
+ * The first call after the bodies move tests every pair the broadphase
+ * finds (or every pair, without a broadphase); later calls, and the
+ * collision handlers run by the next scene_tick(), reuse those results.
+ * Bodies marked for removal are left out.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param contacts a list created with free as its freer, to which a copy of
+ *   each touching pair's contact_t is added
+ */
+void scene_collect_contacts(scene_t *scene, list_t *contacts);
+
+/**
+ * Makes a scene call a collision handler on every pair of touching bodies
+ * where one body is in category1 and the other in category2, once per tick
+ * while they touch. Unlike create_collision(), this needs no registration
+ * per pair, and bodies added later are covered too.
+ * Only pairs whose collision filters match are found
+ * (see body_set_collision_filter()).
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param category1 the category bits of the handler's first body
+ * @param category2 the category bits of the handler's second body
+ * @param handler the function to call on each touching pair
+ * @param aux an auxiliary value to pass to the handler
+ * @param freer if non-NULL, a function to call in order to free aux
+ */
+void scene_add_collision_rule(
+    scene_t *scene,
+    uint32_t category1,
+    uint32_t category2,
+    collision_handler_t handler,
+    void *aux,
+    free_func_t freer
+);
+
+/**
+ * Makes a scene call a collision handler on a pair of bodies, once per tick
+ * while they touch, unless the handler is already registered for them.
+ * The handler runs in the same pass over touching pairs as the collision
+ * rules, so a pair costs nothing while it does not touch.
+ * create_collision() calls this so that registering the same pair and
+ * handler again, e.g. every frame, does not call the handler twice.
+ * The order of the bodies matters, since the handler may treat them
+ * differently. A body's registrations are dropped, and their aux freed,
+ * when it is removed, in time proportional to how many pairs it is in.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param body1 the first body passed to the handler
+ * @param body2 the second body passed to the handler
+ * @param handler the collision handler
+ * @param aux an auxiliary value to pass to the handler
+ * @param freer if non-NULL, a function to call in order to free aux; a
+ *   duplicate registration frees it straight away
+ * @return true if the registration is new, false if it is a duplicate
+ */
+bool scene_register_collision(scene_t *scene, body_t *body1, body_t *body2,
+    collision_handler_t handler, void *aux, free_func_t freer);
+
+/**
+ * Gets how many duplicate registrations scene_register_collision() has
+ * turned away since the scene was created. Each one would otherwise have
+ * resolved the same collision again.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the number of duplicate registrations
+ */
+size_t scene_duplicate_collisions(scene_t *scene);
+
+/**
+ * Finds the first body that a line segment hits, e.g. for line-of-sight
+ * checks. Only bodies whose category shares a bit with mask are hit, and
+ * bodies containing start are ignored.
+ * With a broadphase that supports broadphase_raycast() (an AABB tree), only
+ * the bodies whose boxes the ray passes through are tested.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param start where the ray starts
+ * @param end where the ray ends
+ * @param mask the category bits of the bodies the ray can hit
+ * @param hit where to write the first hit, if any
+ * @return whether the ray hit a body
+ */
+bool scene_raycast(scene_t *scene, vector_t start, vector_t end,
+    uint32_t mask, raycast_hit_t *hit);
+
+/**
+ * Finds the first body that a body would hit if moved along a translation,
+ * e.g. to predict where a launched body will land. The swept body need not be
+ * in the scene, and is never hit itself. Only bodies whose category shares a
+ * bit with mask are hit, and bodies it already overlaps are ignored.
+ * With a broadphase that supports broadphase_query() (an AABB tree), only
+ * the bodies whose boxes overlap the swept body's path are tested.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param body the body to sweep
+ * @param translation how far to move it
+ * @param mask the category bits of the bodies it can hit
+ * @param hit where to write the first hit, if any
+ * @return whether the body hit another body
+ */
+bool scene_shapecast(scene_t *scene, body_t *body, vector_t translation,
+    uint32_t mask, raycast_hit_t *hit);
+
+/**
+ * Clears a scene of all the bodies, forces and collision rules associated
+ * with it
  * Frees all the information related to it except the shell of the scene
  *
  * @param scene that we want to free
@@ -172,12 +421,33 @@ void scene_add_bodies_force_creator(
  */
 void scene_clear(scene_t *scene);
 
+/**
+ * Integrates every body in a scene over a time interval, applying and then
+ * resetting the forces and impulses accumulated on them (see body_tick()).
+ * In a scene_init_soa() scene all bodies are integrated together with SIMD
+ * instructions when the build enables them (AVX2, else SSE2), matching
+ * body_tick() up to floating-point rounding.
+ * Called by scene_tick() after the force creators run.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param dt the time elapsed since the last tick, in seconds
+ */
+void scene_integrate(scene_t *scene, double dt);
+
 /**
  * Executes a tick of a given scene over a small time interval.
- * This requires executing all the force creators
+ * This requires executing all the force creators, then calling the
+ * collision handlers of the touching pairs of bodies in one pass,
  * and then ticking each body (see body_tick()).
  * If any bodies are marked for removal, they should be removed from the scene
  * and freed, along with any force creators acting on them.
+ * If a bullet (see body_set_bullet()) would hit another body during the
+ * tick, the tick is split at the time of impact and the collision handlers
+ * run again from there, so fast bullets collide however large dt is.
+ * The force creators still run once per tick: each later step integrates
+ * the forces and torques they gave in the first step, so a split tick costs
+ * a collision pass and an integration per step, not a force pass.
+ * A tick is split into at most 8 steps.
  *
  * @param scene a pointer to a scene returned from scene_init()
  * @param dt the time elapsed since the last tick, in seconds
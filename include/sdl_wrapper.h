@@ -5,6 +5,7 @@
 #include "color.h"
 #include "list.h"
 #include "scene.h"
+#include "shape.h"
 #include "vector.h"
 #include "body.h"
 #include <SDL2/SDL.h>
@@ -104,6 +105,25 @@ void sdl_clear(void);
  */
 void sdl_draw_polygon(list_t *points, rgb_color_t color);
 
+/**
+ * Draws a packed polygon and a color.
+ * Acts like sdl_draw_polygon(), but reads the vertices directly from the
+ * shape's contiguous storage and reuses its pixel buffers between calls.
+ *
+ * @param shape the vertices of the polygon
+ * @param color the color used to fill in the polygon
+ */
+void sdl_draw_shape(const shape_t *shape, rgb_color_t color);
+
+/**
+ * Draws a body in its color. Polygons are drawn with sdl_draw_shape(),
+ * while circles and capsules are drawn natively as filled circles (joined
+ * by a rectangle for capsules) instead of as many-sided polygons.
+ *
+ * @param body the body to draw
+ */
+void sdl_draw_body(body_t *body);
+
 /**
  * Displays the rendered frame on the SDL window.
  * Must be called after drawing the polygons in order to show them.
@@ -112,7 +132,7 @@ void sdl_show(void);
 
 /**
  * Draws all bodies in a scene.
- * This internally calls sdl_clear(), sdl_draw_polygon(), and sdl_show(),
+ * This internally calls sdl_clear(), sdl_draw_body(), and sdl_show(),
  * so those functions should not be called directly.
  *
  * @param scene the scene to draw
@@ -201,14 +221,13 @@ SDL_Texture *sdl_make_image(SDL_Surface *image);
 
 /**
  * Function that renders the image on the a body that we specify
- * Because of the nature and extent of our SDL knowledge, we need the body
- * to be a rectangle whose points are in counter clockwise order from the bottom
- * left. This way the SDL_Rect object can be created quickly.
+ * The image is stretched over the body's bounding box (see body_get_aabb()),
+ * so it covers an axis-aligned rectangle exactly and works for circles and
+ * capsules too.
  * All adjustments have been made so it renders on our screen.
  *
  * @param an SDL_Texture pointer that is the image we want to render
- * @param a body_t pointer of the rectangular body that we want to render
- *        the image on.
+ * @param a body_t pointer of the body that we want to render the image on.
  * 
  **/
 void sdl_put_image_on_body(SDL_Texture *image_texture, body_t *body);
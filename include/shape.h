@@ -0,0 +1,65 @@
+#ifndef __SHAPE_H__
+#define __SHAPE_H__
+
+#include <stddef.h>
+#include "list.h"
+#include "vector.h"
+
+/**
+ * A polygon stored as a packed array of vertices.
+ * Unlike a list_t of vector_t pointers, the vertices live in one contiguous
+ * block right after the vertex count, so walking a shape touches consecutive
+ * memory and needs no pointer hops or bounds checks.
+ * shape_t is defined here so loops can index points[] directly.
+ */
+typedef struct shape {
+    /** The number of vertices in the polygon */
+    size_t size;
+    /** The vertices, listed in a counterclockwise direction */
+    vector_t points[];
+} shape_t;
+
+/**
+ * Allocates memory for a shape with the given number of vertices.
+ * The vertices are initialized to (0, 0).
+ * Asserts that the required memory is allocated.
+ *
+ * @param size the number of vertices in the shape
+ * @return a pointer to the newly allocated shape
+ */
+shape_t *shape_init(size_t size);
+
+/**
+ * Allocates a shape holding a copy of the vertices in a list.
+ * Does not free the list.
+ *
+ * @param points a list of vector_t pointers
+ * @return a pointer to the newly allocated shape
+ */
+shape_t *shape_from_list(list_t *points);
+
+/**
+ * Allocates a copy of a shape.
+ *
+ * @param shape the shape to copy
+ * @return a pointer to the newly allocated shape
+ */
+shape_t *shape_copy(const shape_t *shape);
+
+/**
+ * Copies the vertices of a shape into a newly allocated vector list,
+ * which must be list_free()d.
+ *
+ * @param shape the shape to copy
+ * @return a list of newly allocated vector_t pointers
+ */
+list_t *shape_to_list(const shape_t *shape);
+
+/**
+ * Releases the memory allocated for a shape.
+ *
+ * @param shape a pointer to a shape returned from shape_init()
+ */
+void shape_free(shape_t *shape);
+
+#endif // #ifndef __SHAPE_H__
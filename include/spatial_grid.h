@@ -0,0 +1,20 @@
+#ifndef __SPATIAL_GRID_H__
+#define __SPATIAL_GRID_H__
+
+#include "broadphase.h"
+
+/**
+ * Allocates memory for a spatial hash grid broadphase.
+ * Space is divided into square cells as wide as the median body, and each
+ * body is binned into the cells its bounding box touches. Only bodies that
+ * share a cell are compared.
+ * Bodies that would cover too many cells (e.g. floors and walls) are kept
+ * out of the grid and compared against every body instead.
+ * Works best when bodies are about the same size, like a field of pegs or
+ * a wall of bricks, where sweep-and-prune sees long runs along one axis.
+ *
+ * @return a pointer to the newly allocated broadphase
+ */
+broadphase_t *spatial_grid_init(void);
+
+#endif // #ifndef __SPATIAL_GRID_H__
@@ -0,0 +1,19 @@
+#ifndef __SWEEP_PRUNE_H__
+#define __SWEEP_PRUNE_H__
+
+#include "broadphase.h"
+
+/**
+ * Allocates memory for a sweep-and-prune broadphase.
+ * The x extents of every body's bounding box are kept in one sorted list of
+ * endpoints. Each tick the endpoints are updated in place and re-sorted with
+ * insertion sort, which is close to linear because bodies move little
+ * between ticks. A single sweep over the list then finds the pairs whose
+ * boxes overlap.
+ * Works best when bodies are spread out along the x axis.
+ *
+ * @return a pointer to the newly allocated broadphase
+ */
+broadphase_t *sweep_prune_init(void);
+
+#endif // #ifndef __SWEEP_PRUNE_H__
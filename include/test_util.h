@@ -7,6 +7,9 @@
 #include <stdio.h>
 #include <string.h>
 
+#include "aabb.h"
+#include "body.h"
+#include "broadphase.h"
 #include "vector.h"
 
 /**
@@ -76,4 +79,55 @@ void read_testname(char *filename, char *testname, size_t testname_size);
  */
 bool test_assert_fail(void (*run)(void *aux), void *aux);
 
+/**
+ * The color given to bodies made by the functions below. Tests never draw them.
+ */
+extern const rgb_color_t TEST_COLOR;
+
+/**
+ * Returns a random double between min and max.
+ * Call srand() first so that a test sees the same numbers every run.
+ */
+double random_between(double min, double max);
+
+/**
+ * Returns the bounding box with the given corners.
+ */
+aabb_t make_aabb(double min_x, double min_y, double max_x, double max_y);
+
+/**
+ * Returns an axis-aligned rectangle, wound counterclockwise.
+ */
+shape_t *make_box_shape(vector_t center, double width, double height);
+
+/**
+ * Returns a body with the rectangle from make_box_shape().
+ */
+body_t *make_box(vector_t center, double width, double height, double mass);
+
+/**
+ * Returns a circle body.
+ */
+body_t *make_circle(vector_t center, double radius, double mass);
+
+/**
+ * Returns a regular polygon with the given number of points, or a concave
+ * star with twice as many if the inner radius is smaller than the outer one.
+ * The first point is at the given angle from the center.
+ */
+body_t *make_star(vector_t center, size_t points, double outer, double inner,
+    double angle);
+
+/**
+ * Checks a broadphase against a brute-force scan. Adds a floor, a wall and
+ * boxes and circles of mixed sizes to the broadphase, some of which only
+ * collide with the floor and wall, then moves them around for a number of
+ * ticks, taking bodies out and putting them back. Each tick every pair of
+ * tracked bodies whose boxes overlap and whose filters match must be found.
+ * With exact set, no other pair may be found either; without it, the extra
+ * pairs must still pass the filters (e.g. fat boxes in an AABB tree).
+ * Frees the bodies but not the broadphase.
+ */
+void check_broadphase_brute_force(broadphase_t *broadphase, bool exact);
+
 #endif // #ifndef __TEST_UTIL_H__
@@ -0,0 +1,82 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "aabb.h"
+
+/**
+Computes the bounding box of a shape's vertices.
+*/
+aabb_t aabb_of_shape(const shape_t *shape) {
+  assert(shape->size > 0);
+  aabb_t box = {shape->points[0], shape->points[0]};
+  for (size_t i = 1; i < shape->size; i++) {
+    vector_t point = shape->points[i];
+    if (point.x < box.min.x) {
+      box.min.x = point.x;
+    }
+    if (point.x > box.max.x) {
+      box.max.x = point.x;
+    }
+    if (point.y < box.min.y) {
+      box.min.y = point.y;
+    }
+    if (point.y > box.max.y) {
+      box.max.y = point.y;
+    }
+  }
+  return box;
+}
+
+/**
+Returns whether two boxes overlap or touch.
+*/
+bool aabb_overlap(aabb_t a, aabb_t b) {
+  return a.min.x <= b.max.x && b.min.x <= a.max.x &&
+    a.min.y <= b.max.y && b.min.y <= a.max.y;
+}
+
+/**
+Returns whether inner lies inside outer.
+*/
+bool aabb_contains(aabb_t outer, aabb_t inner) {
+  return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y &&
+    inner.max.x <= outer.max.x && inner.max.y <= outer.max.y;
+}
+
+/**
+Computes the smallest box containing both boxes.
+*/
+aabb_t aabb_union(aabb_t a, aabb_t b) {
+  aabb_t box = a;
+  if (b.min.x < box.min.x) {
+    box.min.x = b.min.x;
+  }
+  if (b.min.y < box.min.y) {
+    box.min.y = b.min.y;
+  }
+  if (b.max.x > box.max.x) {
+    box.max.x = b.max.x;
+  }
+  if (b.max.y > box.max.y) {
+    box.max.y = b.max.y;
+  }
+  return box;
+}
+
+/**
+Grows a box by margin on every side.
+*/
+aabb_t aabb_fatten(aabb_t box, double margin) {
+  box.min.x -= margin;
+  box.min.y -= margin;
+  box.max.x += margin;
+  box.max.y += margin;
+  return box;
+}
+
+/**
+Computes the perimeter of a box.
+*/
+double aabb_perimeter(aabb_t box) {
+  return 2 * ((box.max.x - box.min.x) + (box.max.y - box.min.y));
+}
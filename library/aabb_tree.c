@@ -0,0 +1,510 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <math.h>
+#include "aabb_tree.h"
+
+const size_t TREE_INIT_SIZE = 16;
+const size_t TREE_NULL = (size_t) -1;
+
+/**
+A node of the tree. Leaves have no children; free nodes have height -1 and
+use parent to link the free list.
+*/
+typedef struct tree_node {
+  aabb_t box;
+  void *data;
+  size_t parent;
+  size_t left;
+  size_t right;
+  long height;
+} tree_node_t;
+
+typedef struct aabb_tree {
+  tree_node_t *nodes;
+  size_t capacity;
+  size_t root;
+  size_t free_list;
+  double margin;
+  // scratch stack for queries
+  size_t *stack;
+  size_t stack_capacity;
+} aabb_tree_t;
+
+static bool tree_is_leaf(tree_node_t *node) {
+  return node->left == TREE_NULL;
+}
+
+/**
+Links nodes [from, capacity) into the free list.
+*/
+static void tree_link_free(aabb_tree_t *tree, size_t from) {
+  for (size_t i = from; i < tree->capacity; i++) {
+    tree->nodes[i].height = -1;
+    tree->nodes[i].parent = i + 1 < tree->capacity ? i + 1 : TREE_NULL;
+  }
+  tree->free_list = from;
+}
+
+aabb_tree_t *aabb_tree_init(double margin) {
+  aabb_tree_t *tree = malloc(sizeof(aabb_tree_t));
+  assert(tree != NULL);
+  tree->capacity = TREE_INIT_SIZE;
+  tree->nodes = malloc(tree->capacity * sizeof(tree_node_t));
+  assert(tree->nodes != NULL);
+  tree_link_free(tree, 0);
+  tree->root = TREE_NULL;
+  tree->margin = margin;
+  tree->stack_capacity = TREE_INIT_SIZE;
+  tree->stack = malloc(tree->stack_capacity * sizeof(size_t));
+  assert(tree->stack != NULL);
+  return tree;
+}
+
+void aabb_tree_free(aabb_tree_t *tree) {
+  free(tree->nodes);
+  free(tree->stack);
+  free(tree);
+}
+
+/**
+Takes a node off the free list, doubling the node array if it is empty.
+Node pointers are invalidated when the array grows.
+*/
+static size_t tree_alloc_node(aabb_tree_t *tree) {
+  if (tree->free_list == TREE_NULL) {
+    size_t old_capacity = tree->capacity;
+    tree->capacity *= 2;
+    tree->nodes = realloc(tree->nodes, tree->capacity * sizeof(tree_node_t));
+    assert(tree->nodes != NULL);
+    tree_link_free(tree, old_capacity);
+  }
+  size_t index = tree->free_list;
+  tree_node_t *node = &tree->nodes[index];
+  tree->free_list = node->parent;
+  node->parent = TREE_NULL;
+  node->left = TREE_NULL;
+  node->right = TREE_NULL;
+  node->height = 0;
+  node->data = NULL;
+  return index;
+}
+
+static void tree_free_node(aabb_tree_t *tree, size_t index) {
+  tree->nodes[index].height = -1;
+  tree->nodes[index].parent = tree->free_list;
+  tree->free_list = index;
+}
+
+/**
+Points parent's child slot that held old_child at new_child, or makes
+new_child the root if parent is TREE_NULL.
+*/
+static void tree_replace_child(aabb_tree_t *tree, size_t parent,
+  size_t old_child, size_t new_child) {
+    if (parent == TREE_NULL) {
+      tree->root = new_child;
+    }
+    else if (tree->nodes[parent].left == old_child) {
+      tree->nodes[parent].left = new_child;
+    }
+    else {
+      tree->nodes[parent].right = new_child;
+    }
+}
+
+static void tree_refit(aabb_tree_t *tree, size_t index) {
+  tree_node_t *node = &tree->nodes[index];
+  tree_node_t *left = &tree->nodes[node->left];
+  tree_node_t *right = &tree->nodes[node->right];
+  node->box = aabb_union(left->box, right->box);
+  node->height = 1 + (left->height > right->height ? left->height :
+    right->height);
+}
+
+/**
+Lifts the taller grandchild of a node up over one of its children.
+*/
+static size_t tree_rotate(aabb_tree_t *tree, size_t a, bool right_heavy) {
+  tree_node_t *nodes = tree->nodes;
+  size_t high = right_heavy ? nodes[a].right : nodes[a].left;
+  size_t f = nodes[high].left;
+  size_t g = nodes[high].right;
+
+  // high takes a's place, and a becomes high's left child
+  nodes[high].left = a;
+  nodes[high].parent = nodes[a].parent;
+  nodes[a].parent = high;
+  tree_replace_child(tree, nodes[high].parent, a, high);
+
+  // The taller of high's old children stays with high, the other goes to a
+  size_t keep = nodes[f].height > nodes[g].height ? f : g;
+  size_t give = keep == f ? g : f;
+  nodes[high].right = keep;
+  if (right_heavy) {
+    nodes[a].right = give;
+  }
+  else {
+    nodes[a].left = give;
+  }
+  nodes[give].parent = a;
+  tree_refit(tree, a);
+  tree_refit(tree, high);
+  return high;
+}
+
+/**
+Rotates a node if its children's heights differ by more than one.
+Returns the node now in its place.
+*/
+static size_t tree_balance(aabb_tree_t *tree, size_t a) {
+  tree_node_t *node = &tree->nodes[a];
+  if (tree_is_leaf(node) || node->height < 2) {
+    return a;
+  }
+  long balance = tree->nodes[node->right].height -
+    tree->nodes[node->left].height;
+  if (balance > 1) {
+    return tree_rotate(tree, a, true);
+  }
+  if (balance < -1) {
+    return tree_rotate(tree, a, false);
+  }
+  return a;
+}
+
+/**
+Rebalances and refits every ancestor from index up to the root.
+*/
+static void tree_fix_upwards(aabb_tree_t *tree, size_t index) {
+  while (index != TREE_NULL) {
+    index = tree_balance(tree, index);
+    tree_refit(tree, index);
+    index = tree->nodes[index].parent;
+  }
+}
+
+/**
+Cost of making leaf_box a sibling of a node, not counting the ancestors.
+*/
+static double tree_descend_cost(tree_node_t *node, aabb_t leaf_box,
+  double inheritance) {
+    double cost = aabb_perimeter(aabb_union(leaf_box, node->box));
+    if (!tree_is_leaf(node)) {
+      cost -= aabb_perimeter(node->box);
+    }
+    return cost + inheritance;
+}
+
+static void tree_insert_leaf(aabb_tree_t *tree, size_t leaf) {
+  if (tree->root == TREE_NULL) {
+    tree->root = leaf;
+    tree->nodes[leaf].parent = TREE_NULL;
+    return;
+  }
+
+  // Walk down to the sibling that grows the total perimeter least
+  aabb_t leaf_box = tree->nodes[leaf].box;
+  size_t index = tree->root;
+  while (!tree_is_leaf(&tree->nodes[index])) {
+    tree_node_t *node = &tree->nodes[index];
+    double perimeter = aabb_perimeter(node->box);
+    double combined = aabb_perimeter(aabb_union(node->box, leaf_box));
+    double cost = 2 * combined;
+    double inheritance = 2 * (combined - perimeter);
+    double left_cost = tree_descend_cost(&tree->nodes[node->left], leaf_box,
+      inheritance);
+    double right_cost = tree_descend_cost(&tree->nodes[node->right],
+      leaf_box, inheritance);
+    if (cost < left_cost && cost < right_cost) {
+      break;
+    }
+    index = left_cost < right_cost ? node->left : node->right;
+  }
+
+  size_t sibling = index;
+  size_t old_parent = tree->nodes[sibling].parent;
+  size_t new_parent = tree_alloc_node(tree);
+  tree_node_t *nodes = tree->nodes;
+  nodes[new_parent].parent = old_parent;
+  nodes[new_parent].left = sibling;
+  nodes[new_parent].right = leaf;
+  nodes[new_parent].box = aabb_union(leaf_box, nodes[sibling].box);
+  nodes[new_parent].height = nodes[sibling].height + 1;
+  nodes[sibling].parent = new_parent;
+  nodes[leaf].parent = new_parent;
+  tree_replace_child(tree, old_parent, sibling, new_parent);
+
+  tree_fix_upwards(tree, new_parent);
+}
+
+static void tree_remove_leaf(aabb_tree_t *tree, size_t leaf) {
+  if (leaf == tree->root) {
+    tree->root = TREE_NULL;
+    return;
+  }
+  tree_node_t *nodes = tree->nodes;
+  size_t parent = nodes[leaf].parent;
+  size_t grandparent = nodes[parent].parent;
+  size_t sibling = nodes[parent].left == leaf ? nodes[parent].right :
+    nodes[parent].left;
+
+  // The sibling takes the parent's place
+  tree_replace_child(tree, grandparent, parent, sibling);
+  nodes[sibling].parent = grandparent;
+  tree_free_node(tree, parent);
+  tree_fix_upwards(tree, grandparent);
+}
+
+size_t aabb_tree_insert(aabb_tree_t *tree, aabb_t box, void *data) {
+  size_t leaf = tree_alloc_node(tree);
+  tree->nodes[leaf].box = aabb_fatten(box, tree->margin);
+  tree->nodes[leaf].data = data;
+  tree_insert_leaf(tree, leaf);
+  return leaf;
+}
+
+void aabb_tree_remove(aabb_tree_t *tree, size_t leaf) {
+  assert(leaf < tree->capacity && tree_is_leaf(&tree->nodes[leaf]));
+  tree_remove_leaf(tree, leaf);
+  tree_free_node(tree, leaf);
+}
+
+bool aabb_tree_move(aabb_tree_t *tree, size_t leaf, aabb_t box) {
+  if (aabb_contains(tree->nodes[leaf].box, box)) {
+    return false;
+  }
+  tree_remove_leaf(tree, leaf);
+  tree->nodes[leaf].box = aabb_fatten(box, tree->margin);
+  tree_insert_leaf(tree, leaf);
+  return true;
+}
+
+aabb_t aabb_tree_get_box(aabb_tree_t *tree, size_t leaf) {
+  return tree->nodes[leaf].box;
+}
+
+void *aabb_tree_get_data(aabb_tree_t *tree, size_t leaf) {
+  return tree->nodes[leaf].data;
+}
+
+size_t aabb_tree_height(aabb_tree_t *tree) {
+  if (tree->root == TREE_NULL) {
+    return 0;
+  }
+  return (size_t) tree->nodes[tree->root].height;
+}
+
+static void tree_push(aabb_tree_t *tree, size_t *count, size_t index) {
+  if (*count == tree->stack_capacity) {
+    tree->stack_capacity *= 2;
+    tree->stack = realloc(tree->stack, tree->stack_capacity * sizeof(size_t));
+    assert(tree->stack != NULL);
+  }
+  tree->stack[(*count)++] = index;
+}
+
+void aabb_tree_query(aabb_tree_t *tree, aabb_t region, tree_query_t callback,
+  void *aux) {
+    if (tree->root == TREE_NULL) {
+      return;
+    }
+    size_t count = 0;
+    tree_push(tree, &count, tree->root);
+    while (count > 0) {
+      tree_node_t *node = &tree->nodes[tree->stack[--count]];
+      if (!aabb_overlap(node->box, region)) {
+        continue;
+      }
+      if (tree_is_leaf(node)) {
+        if (!callback(node->data, aux)) {
+          return;
+        }
+      }
+      else {
+        size_t left = node->left;
+        size_t right = node->right;
+        tree_push(tree, &count, left);
+        tree_push(tree, &count, right);
+      }
+    }
+}
+
+/**
+Returns whether the ray origin + t * direction for t in [0, max_t] hits a box
+(slab test).
+*/
+static bool ray_hits_box(vector_t origin, vector_t direction, double max_t,
+  aabb_t box) {
+    double t_min = 0.0;
+    double t_max = max_t;
+    double origins[2] = {origin.x, origin.y};
+    double directions[2] = {direction.x, direction.y};
+    double mins[2] = {box.min.x, box.min.y};
+    double maxs[2] = {box.max.x, box.max.y};
+    for (size_t axis = 0; axis < 2; axis++) {
+      if (directions[axis] == 0.0) {
+        if (origins[axis] < mins[axis] || origins[axis] > maxs[axis]) {
+          return false;
+        }
+        continue;
+      }
+      double t1 = (mins[axis] - origins[axis]) / directions[axis];
+      double t2 = (maxs[axis] - origins[axis]) / directions[axis];
+      if (t1 > t2) {
+        double temp = t1;
+        t1 = t2;
+        t2 = temp;
+      }
+      t_min = fmax(t_min, t1);
+      t_max = fmin(t_max, t2);
+      if (t_min > t_max) {
+        return false;
+      }
+    }
+    return true;
+}
+
+void aabb_tree_raycast(aabb_tree_t *tree, vector_t origin, vector_t direction,
+  double max_t, tree_raycast_t callback, void *aux) {
+    if (tree->root == TREE_NULL) {
+      return;
+    }
+    size_t count = 0;
+    tree_push(tree, &count, tree->root);
+    while (count > 0 && max_t > 0) {
+      tree_node_t *node = &tree->nodes[tree->stack[--count]];
+      if (!ray_hits_box(origin, direction, max_t, node->box)) {
+        continue;
+      }
+      if (tree_is_leaf(node)) {
+        max_t = callback(node->data, origin, direction, max_t, aux);
+      }
+      else {
+        size_t left = node->left;
+        size_t right = node->right;
+        tree_push(tree, &count, left);
+        tree_push(tree, &count, right);
+      }
+    }
+}
+
+/**
+A broadphase over an aabb_tree_t. Bodies are kept in a dense array so every
+leaf can be updated and queried each tick.
+*/
+typedef struct tree_broadphase {
+  aabb_tree_t *tree;
+  body_t **bodies;
+  size_t *leaves;
+  size_t size;
+  size_t capacity;
+  // body id -> index in bodies
+  pair_map_t *index_of;
+} tree_broadphase_t;
+
+static void tree_broadphase_free(tree_broadphase_t *state) {
+  aabb_tree_free(state->tree);
+  free(state->bodies);
+  free(state->leaves);
+  pair_map_free(state->index_of);
+  free(state);
+}
+
+static void tree_broadphase_add(tree_broadphase_t *state, body_t *body) {
+  if (state->size == state->capacity) {
+    state->capacity *= 2;
+    state->bodies = realloc(state->bodies, state->capacity * sizeof(body_t *));
+    assert(state->bodies != NULL);
+    state->leaves = realloc(state->leaves, state->capacity * sizeof(size_t));
+    assert(state->leaves != NULL);
+  }
+  size_t index = state->size++;
+  state->bodies[index] = body;
+  state->leaves[index] = aabb_tree_insert(state->tree, body_get_aabb(body),
+    body);
+  *(size_t *) pair_map_put(state->index_of, body_get_id(body)) = index;
+}
+
+static void tree_broadphase_remove(tree_broadphase_t *state, body_t *body) {
+  size_t *found = pair_map_get(state->index_of, body_get_id(body));
+  assert(found != NULL);
+  size_t index = *found;
+  pair_map_remove(state->index_of, body_get_id(body));
+  aabb_tree_remove(state->tree, state->leaves[index]);
+  size_t last = --state->size;
+  if (index != last) {
+    state->bodies[index] = state->bodies[last];
+    state->leaves[index] = state->leaves[last];
+    *(size_t *) pair_map_get(state->index_of,
+      body_get_id(state->bodies[index])) = index;
+  }
+}
+
+typedef struct tree_pair_query {
+  body_t *body;
+  pair_map_t *pairs;
+} tree_pair_query_t;
+
+static bool tree_add_pair(void *data, void *aux) {
+  tree_pair_query_t *query = aux;
+  body_t *other = data;
+  // Both bodies find each other; only record the pair from one side
+  if (body_get_id(query->body) < body_get_id(other)) {
+    broadphase_add_pair(query->pairs, query->body, other);
+  }
+  return true;
+}
+
+static void tree_broadphase_find_pairs(tree_broadphase_t *state,
+  pair_map_t *pairs) {
+    for (size_t i = 0; i < state->size; i++) {
+      aabb_tree_move(state->tree, state->leaves[i],
+        body_get_aabb(state->bodies[i]));
+    }
+    for (size_t i = 0; i < state->size; i++) {
+      tree_pair_query_t query = {state->bodies[i], pairs};
+      aabb_tree_query(state->tree,
+        aabb_tree_get_box(state->tree, state->leaves[i]), tree_add_pair,
+        &query);
+    }
+}
+
+static void tree_broadphase_query(tree_broadphase_t *state, aabb_t region,
+  body_query_t callback, void *aux) {
+    aabb_tree_query(state->tree, region, (tree_query_t) callback, aux);
+}
+
+static void tree_broadphase_raycast(tree_broadphase_t *state,
+  vector_t origin, vector_t direction, double max_t, body_raycast_t callback,
+  void *aux) {
+    aabb_tree_raycast(state->tree, origin, direction, max_t,
+      (tree_raycast_t) callback, aux);
+}
+
+broadphase_t *aabb_tree_broadphase_init(double margin) {
+  tree_broadphase_t *state = malloc(sizeof(tree_broadphase_t));
+  assert(state != NULL);
+  state->tree = aabb_tree_init(margin);
+  state->capacity = TREE_INIT_SIZE;
+  state->size = 0;
+  state->bodies = malloc(state->capacity * sizeof(body_t *));
+  assert(state->bodies != NULL);
+  state->leaves = malloc(state->capacity * sizeof(size_t));
+  assert(state->leaves != NULL);
+  state->index_of = pair_map_init(TREE_INIT_SIZE, sizeof(size_t));
+  broadphase_t *broadphase = broadphase_init(state,
+    (broadphase_add_t) tree_broadphase_add,
+    (broadphase_remove_t) tree_broadphase_remove,
+    (broadphase_pairs_t) tree_broadphase_find_pairs,
+    (free_func_t) tree_broadphase_free);
+  broadphase_set_query(broadphase, (broadphase_query_t) tree_broadphase_query);
+  broadphase_set_raycast(broadphase,
+    (broadphase_raycast_t) tree_broadphase_raycast);
+  return broadphase;
+}
+
+aabb_tree_t *aabb_tree_broadphase_get_tree(broadphase_t *broadphase) {
+  tree_broadphase_t *state = broadphase_get_state(broadphase);
+  return state->tree;
+}
@@ -0,0 +1,434 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <math.h>
+#include "barnes_hut.h"
+
+const size_t BARNES_HUT_INIT_SIZE = 16;
+// Cells stop splitting this deep, so bodies on top of each other share a leaf
+#define BARNES_HUT_MAX_DEPTH 32
+// Matches the scaling grav_calc_helper() applies to the Newtonian force
+const double BARNES_HUT_FORCE_SCALE = 0.1;
+const size_t NO_STAR = (size_t) -1;
+// Leaves split once they hold more stars than this
+const size_t BARNES_HUT_LEAF_SIZE = 4;
+
+/**
+The state gravity needs of one body, copied out at the start of each tick.
+*/
+typedef struct star {
+  body_t *body;
+  vector_t centroid;
+  double mass;
+  // how close others may get before they are treated as touching it
+  double radius;
+  // whether the body is awake, i.e. gets pulled (sleeping bodies still pull)
+  bool awake;
+  // the next star in the same leaf
+  size_t next;
+} star_t;
+
+/**
+A square cell of the quadtree. Cells with children are split into four
+quarters stored next to each other; the others are leaves holding a list of
+stars.
+*/
+typedef struct quad_node {
+  vector_t corner;
+  double width;
+  double mass;
+  // the stars' positions weighted by their masses, then their center of mass
+  vector_t mass_center;
+  // the index of the first of the four children, or 0 for a leaf
+  size_t children;
+  // a leaf's stars: a list starting at first while the tree is built, then
+  // count stars in a row from first
+  size_t first;
+  size_t count;
+} quad_node_t;
+
+typedef struct barnes_hut {
+  scene_t *scene;
+  double G;
+  double theta;
+  star_t *stars;
+  // scratch space for putting the stars of each leaf next to each other
+  star_t *sorted;
+  size_t star_count;
+  size_t star_capacity;
+  size_t awake_count;
+  quad_node_t *nodes;
+  size_t node_count;
+  size_t node_capacity;
+  // the cells pulling on the leaf being visited: far ones as a whole, and the
+  // leaves whose stars pull one by one
+  size_t *far;
+  size_t far_count;
+  size_t far_capacity;
+  size_t *near;
+  size_t near_count;
+  size_t near_capacity;
+} barnes_hut_t;
+
+barnes_hut_t *barnes_hut_init(scene_t *scene, double G, double theta) {
+  barnes_hut_t *gravity = malloc(sizeof(barnes_hut_t));
+  assert(gravity != NULL);
+  gravity->scene = scene;
+  gravity->G = G;
+  gravity->theta = theta;
+  gravity->star_capacity = BARNES_HUT_INIT_SIZE;
+  gravity->stars = malloc(gravity->star_capacity * sizeof(star_t));
+  assert(gravity->stars != NULL);
+  gravity->sorted = malloc(gravity->star_capacity * sizeof(star_t));
+  assert(gravity->sorted != NULL);
+  gravity->star_count = 0;
+  gravity->node_capacity = BARNES_HUT_INIT_SIZE;
+  gravity->nodes = malloc(gravity->node_capacity * sizeof(quad_node_t));
+  assert(gravity->nodes != NULL);
+  gravity->node_count = 0;
+  gravity->far_capacity = BARNES_HUT_INIT_SIZE;
+  gravity->far = malloc(gravity->far_capacity * sizeof(size_t));
+  assert(gravity->far != NULL);
+  gravity->near_capacity = BARNES_HUT_INIT_SIZE;
+  gravity->near = malloc(gravity->near_capacity * sizeof(size_t));
+  assert(gravity->near != NULL);
+  return gravity;
+}
+
+void barnes_hut_free(barnes_hut_t *gravity) {
+  free(gravity->stars);
+  free(gravity->sorted);
+  free(gravity->nodes);
+  free(gravity->far);
+  free(gravity->near);
+  free(gravity);
+}
+
+/**
+Copies the position, mass and reach of every body that takes part, and counts
+the awake ones. Reaches come from body_get_reach(), as in
+calc_gravity_force(), which does not need the bodies' world shapes.
+*/
+static void barnes_hut_gather_stars(barnes_hut_t *gravity) {
+  scene_t *scene = gravity->scene;
+  if (scene_bodies(scene) > gravity->star_capacity) {
+    gravity->star_capacity = scene_bodies(scene);
+    gravity->stars = realloc(gravity->stars,
+      gravity->star_capacity * sizeof(star_t));
+    assert(gravity->stars != NULL);
+    gravity->sorted = realloc(gravity->sorted,
+      gravity->star_capacity * sizeof(star_t));
+    assert(gravity->sorted != NULL);
+  }
+  gravity->star_count = 0;
+  gravity->awake_count = 0;
+  for (size_t i = 0; i < scene_bodies(scene); i++) {
+    body_t *body = scene_get_body(scene, i);
+    double mass = body_get_mass(body);
+    if (body_is_removed(body) || mass == INFINITY) {
+      continue;
+    }
+    star_t *star = &gravity->stars[gravity->star_count++];
+    star->body = body;
+    star->centroid = body_get_centroid(body);
+    star->mass = mass;
+    star->radius = body_get_reach(body);
+    star->awake = !body_is_sleeping(body);
+    star->next = NO_STAR;
+    gravity->awake_count += star->awake;
+  }
+}
+
+/**
+Appends an empty leaf to the quadtree and returns its index.
+*/
+static size_t barnes_hut_add_node(barnes_hut_t *gravity, vector_t corner,
+  double width) {
+    if (gravity->node_count == gravity->node_capacity) {
+      gravity->node_capacity *= 2;
+      gravity->nodes = realloc(gravity->nodes,
+        gravity->node_capacity * sizeof(quad_node_t));
+      assert(gravity->nodes != NULL);
+    }
+    size_t index = gravity->node_count++;
+    gravity->nodes[index] = (quad_node_t) {
+      .corner = corner,
+      .width = width,
+      .mass = 0,
+      .mass_center = VEC_ZERO,
+      .children = 0,
+      .first = NO_STAR,
+      .count = 0,
+    };
+    return index;
+}
+
+/**
+Finds which child of a split cell a point falls in.
+*/
+static size_t barnes_hut_quarter(const quad_node_t *node, vector_t point) {
+  double half = node->width / 2;
+  size_t quarter = 0;
+  if (point.x >= node->corner.x + half) {
+    quarter |= 1;
+  }
+  if (point.y >= node->corner.y + half) {
+    quarter |= 2;
+  }
+  return node->children + quarter;
+}
+
+/**
+Adds a star to a leaf's list.
+*/
+static void barnes_hut_add_star(barnes_hut_t *gravity, quad_node_t *leaf,
+  size_t index) {
+    gravity->stars[index].next = leaf->first;
+    leaf->first = index;
+    leaf->count++;
+}
+
+/**
+Splits a full leaf into four quarters, moving its stars down.
+*/
+static void barnes_hut_split(barnes_hut_t *gravity, size_t index) {
+  vector_t corner = gravity->nodes[index].corner;
+  double half = gravity->nodes[index].width / 2;
+  size_t children = gravity->node_count;
+  for (size_t quarter = 0; quarter < 4; quarter++) {
+    barnes_hut_add_node(gravity, vec_init(
+      corner.x + (quarter & 1 ? half : 0),
+      corner.y + (quarter & 2 ? half : 0)), half);
+  }
+  quad_node_t *node = &gravity->nodes[index];
+  node->children = children;
+  size_t moved = node->first;
+  node->first = NO_STAR;
+  node->count = 0;
+  while (moved != NO_STAR) {
+    star_t *star = &gravity->stars[moved];
+    size_t next = star->next;
+    quad_node_t *child = &gravity->nodes[barnes_hut_quarter(node,
+      star->centroid)];
+    child->mass += star->mass;
+    child->mass_center = vec_add(child->mass_center,
+      vec_multiply(star->mass, star->centroid));
+    barnes_hut_add_star(gravity, child, moved);
+    moved = next;
+  }
+}
+
+/**
+Inserts a star, adding its mass to every cell on the way down.
+*/
+static void barnes_hut_insert(barnes_hut_t *gravity, size_t index) {
+  star_t *star = &gravity->stars[index];
+  size_t node = 0;
+  for (size_t depth = 0; ; depth++) {
+    quad_node_t *cell = &gravity->nodes[node];
+    cell->mass += star->mass;
+    cell->mass_center = vec_add(cell->mass_center,
+      vec_multiply(star->mass, star->centroid));
+    if (cell->children == 0) {
+      if (cell->count < BARNES_HUT_LEAF_SIZE
+        || depth == BARNES_HUT_MAX_DEPTH) {
+          barnes_hut_add_star(gravity, cell, index);
+          return;
+      }
+      barnes_hut_split(gravity, node);
+      cell = &gravity->nodes[node];
+    }
+    node = barnes_hut_quarter(cell, star->centroid);
+  }
+}
+
+/**
+Builds the quadtree over the stars, in a square cell around all of them.
+*/
+static void barnes_hut_build(barnes_hut_t *gravity) {
+  gravity->node_count = 0;
+  vector_t min = {INFINITY, INFINITY};
+  vector_t max = {-INFINITY, -INFINITY};
+  for (size_t i = 0; i < gravity->star_count; i++) {
+    vector_t centroid = gravity->stars[i].centroid;
+    min = vec_init(fmin(min.x, centroid.x), fmin(min.y, centroid.y));
+    max = vec_init(fmax(max.x, centroid.x), fmax(max.y, centroid.y));
+  }
+  // widened a little so the stars on the far edges fall inside
+  double width = fmax(max.x - min.x, max.y - min.y) * 1.001 + 1e-9;
+  barnes_hut_add_node(gravity, min, width);
+  for (size_t i = 0; i < gravity->star_count; i++) {
+    barnes_hut_insert(gravity, i);
+  }
+  for (size_t i = 0; i < gravity->node_count; i++) {
+    quad_node_t *node = &gravity->nodes[i];
+    if (node->mass > 0) {
+      node->mass_center = vec_multiply(1 / node->mass, node->mass_center);
+    }
+  }
+
+  // lay out each leaf's stars in a row, so a leaf's first star and count say
+  // where all of them are
+  size_t sorted = 0;
+  for (size_t i = 0; i < gravity->node_count; i++) {
+    quad_node_t *node = &gravity->nodes[i];
+    size_t star = node->first;
+    node->first = sorted;
+    while (star != NO_STAR) {
+      gravity->sorted[sorted++] = gravity->stars[star];
+      star = gravity->stars[star].next;
+    }
+  }
+  star_t *stars = gravity->stars;
+  gravity->stars = gravity->sorted;
+  gravity->sorted = stars;
+}
+
+/**
+Returns whether a point lies inside a cell.
+*/
+static bool barnes_hut_contains(const quad_node_t *node, vector_t point) {
+  return point.x >= node->corner.x && point.x < node->corner.x + node->width
+    && point.y >= node->corner.y && point.y < node->corner.y + node->width;
+}
+
+/**
+Appends a cell's index to a growable list.
+*/
+static void barnes_hut_push(size_t **list, size_t *count, size_t *capacity,
+  size_t node) {
+    if (*count == *capacity) {
+      *capacity *= 2;
+      *list = realloc(*list, *capacity * sizeof(size_t));
+      assert(*list != NULL);
+    }
+    (*list)[(*count)++] = node;
+}
+
+/**
+Finds the cells that pull on the stars of a leaf. A cell far enough from
+the whole leaf pulls as one body; the leaves that are not pull star by star.
+*/
+static void barnes_hut_gather_pulls(barnes_hut_t *gravity,
+  const quad_node_t *leaf) {
+    double theta_squared = gravity->theta * gravity->theta;
+    vector_t middle = vec_init(leaf->corner.x + leaf->width / 2,
+      leaf->corner.y + leaf->width / 2);
+    gravity->far_count = 0;
+    gravity->near_count = 0;
+    // every popped cell pushes at most four, so this holds the deepest path
+    size_t stack[3 * BARNES_HUT_MAX_DEPTH + 4];
+    size_t size = 0;
+    stack[size++] = 0;
+    while (size > 0) {
+      size_t index = stack[--size];
+      const quad_node_t *node = &gravity->nodes[index];
+      if (node->mass == 0) {
+        continue;
+      }
+      if (node->children == 0) {
+        barnes_hut_push(&gravity->near, &gravity->near_count,
+          &gravity->near_capacity, index);
+        continue;
+      }
+      // the distance from the center of mass to the nearest point of the leaf
+      double dx = fmax(fmax(leaf->corner.x - node->mass_center.x, 0),
+        node->mass_center.x - leaf->corner.x - leaf->width);
+      double dy = fmax(fmax(leaf->corner.y - node->mass_center.y, 0),
+        node->mass_center.y - leaf->corner.y - leaf->width);
+      if (node->width * node->width < theta_squared * (dx * dx + dy * dy)
+        && !barnes_hut_contains(node, middle)) {
+          barnes_hut_push(&gravity->far, &gravity->far_count,
+            &gravity->far_capacity, index);
+          continue;
+      }
+      for (size_t quarter = 0; quarter < 4; quarter++) {
+        stack[size++] = node->children + quarter;
+      }
+    }
+}
+
+/**
+Adds up the pull on one star of the cells found by barnes_hut_gather_pulls(),
+and whether anything pulls it at all. This runs for every star against many
+cells, so it works on plain doubles rather than calling the vector functions.
+*/
+static vector_t barnes_hut_pull(barnes_hut_t *gravity, size_t index,
+  bool *pulled) {
+    const star_t *star = &gravity->stars[index];
+    double x = star->centroid.x;
+    double y = star->centroid.y;
+    double force_x = 0;
+    double force_y = 0;
+    for (size_t i = 0; i < gravity->far_count; i++) {
+      const quad_node_t *node = &gravity->nodes[gravity->far[i]];
+      double dx = node->mass_center.x - x;
+      double dy = node->mass_center.y - y;
+      double distance = sqrt(dx * dx + dy * dy);
+      double scale = node->mass / (distance * distance * distance);
+      force_x += scale * dx;
+      force_y += scale * dy;
+      *pulled = true;
+    }
+    for (size_t i = 0; i < gravity->near_count; i++) {
+      const quad_node_t *node = &gravity->nodes[gravity->near[i]];
+      for (size_t other = node->first; other < node->first + node->count;
+        other++) {
+          const star_t *source = &gravity->stars[other];
+          double dx = source->centroid.x - x;
+          double dy = source->centroid.y - y;
+          double distance = sqrt(dx * dx + dy * dy);
+          if (other == index || distance < star->radius + source->radius) {
+            continue;
+          }
+          double scale = source->mass / (distance * distance * distance);
+          force_x += scale * dx;
+          force_y += scale * dy;
+          *pulled = true;
+      }
+    }
+    double scale = BARNES_HUT_FORCE_SCALE * gravity->G * star->mass;
+    return vec_init(scale * force_x, scale * force_y);
+}
+
+void barnes_hut_apply(barnes_hut_t *gravity) {
+  barnes_hut_gather_stars(gravity);
+  // sleeping bodies are not pulled, so a scene at rest needs no tree
+  if (gravity->star_count < 2 || gravity->awake_count == 0) {
+    return;
+  }
+  barnes_hut_build(gravity);
+  size_t stack[3 * BARNES_HUT_MAX_DEPTH + 4];
+  size_t size = 0;
+  stack[size++] = 0;
+  while (size > 0) {
+    const quad_node_t *node = &gravity->nodes[stack[--size]];
+    if (node->children != 0) {
+      for (size_t quarter = 0; quarter < 4; quarter++) {
+        stack[size++] = node->children + quarter;
+      }
+      continue;
+    }
+    if (node->count == 0) {
+      continue;
+    }
+    // the stars of a leaf share the cells that pull on them, which are only
+    // gathered once an awake star needs them
+    bool gathered = false;
+    for (size_t i = node->first; i < node->first + node->count; i++) {
+      if (!gravity->stars[i].awake) {
+        continue;
+      }
+      if (!gathered) {
+        barnes_hut_gather_pulls(gravity, node);
+        gathered = true;
+      }
+      bool pulled = false;
+      vector_t force = barnes_hut_pull(gravity, i, &pulled);
+      if (pulled) {
+        body_t *body = gravity->stars[i].body;
+        body_add_force_imp_pos(body, force, body_get_imp_pos(body));
+      }
+    }
+  }
+}
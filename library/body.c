@@ -4,70 +4,228 @@
 #include <math.h>
 #include "body.h"
 #include "polygon.h"
+#include "body_store.h"
 
-const double ACC_MULT = 0.5;
 const size_t DEFAULT_SIZE = 10;
 const double PI = 3.14159265359;
 const int BEAVER = 1;
 const int CORONA = 5;
 const int FANCY_BEAVER = 8;
+const uint32_t DEFAULT_CATEGORY = 1;
+const uint32_t DEFAULT_MASK = 0xffffffff;
+
+// Ids are never reused, so a pair of ids always names the same two bodies
+static size_t next_body_id = 0;
 
 typedef struct body {
-  list_t *points;
-  vector_t velocity;
-  vector_t acceleration;
-  vector_t centroid;
-  vector_t force;
-  vector_t impulse;
+  size_t id;
+  body_store_t *store;
+  size_t slot;
+  shape_t *local_shape;
+  shape_t *world_shape;
+  // the convex pieces of a concave polygon, or none if it is convex
+  size_t piece_count;
+  shape_t **local_pieces;
+  shape_t **world_pieces;
+  aabb_t *piece_boxes;
+  double radius;
+  bool world_valid;
+  vector_t world_centroid;
+  double world_angle;
   double mass;
   rgb_color_t color;
-  double angle;
   void *info;
   free_func_t info_freer;
   bool removed;
-  bool collided_with;
-  list_t *bodies_collided_with;
   vector_t impact_pos;
-  double torque;
-  double angular_impulse;
-  double angular_velocity;
   bool is_launched;
-  double scale_factor;
+  bool is_bullet;
+  bool is_sleeping;
+  double still_time;
+  uint32_t category;
+  uint32_t mask;
   vector_t rotate_point;
   vector_t ground;
+  body_store_t own_store;
+  double own_fields[STORE_FIELDS];
+  unsigned char own_flags;
+  body_t *own_body;
 } body_t;
 
 /**
- * Allocates memory for a body with the given parameters.
- * The body is initially at rest.
+ * The hot state of a body (position, velocity, forces, angular state) lives
+ * in a slot of a body_store_t. A body outside any scene store uses the
+ * one-slot store embedded in it, so it needs no extra allocation.
  */
-body_t *body_init_with_info(list_t *shape, double mass, rgb_color_t color,
-  void *info, free_func_t info_freer){
+static double *body_field(body_t *body, store_field_t field) {
+  return &body->store->fields[field][body->slot];
+}
+
+static vector_t body_get_pair(body_t *body, store_field_t x_field,
+  store_field_t y_field) {
+    return vec_init(*body_field(body, x_field), *body_field(body, y_field));
+}
+
+static void body_set_pair(body_t *body, store_field_t x_field,
+  store_field_t y_field, vector_t v) {
+    *body_field(body, x_field) = v.x;
+    *body_field(body, y_field) = v.y;
+}
+
+static unsigned char *body_flags(body_t *body) {
+  return &body->store->flags[body->slot];
+}
+
+/**
+ * Wakes a sleeping body that something pushed. Pushing an awake body does not
+ * restart its still time, so bodies under small forces such as drag can still
+ * fall asleep.
+ */
+static void body_disturb(body_t *body, bool pushed) {
+  if (pushed && body->is_sleeping) {
+    body->is_sleeping = false;
+    *body_flags(body) &= ~STORE_ASLEEP;
+    body->still_time = 0;
+  }
+}
+
+/**
+ * Removes a body from its current store, fixing up the slot of the body
+ * that was moved into its place.
+ */
+static void body_detach(body_t *body) {
+  body_t *moved = body_store_remove(body->store, body->slot);
+  if (moved != NULL) {
+    moved->slot = body->slot;
+  }
+}
+
+/**
+ * Splits a concave polygon body's local shape into convex pieces.
+ */
+static void body_init_pieces(body_t *body) {
+  body->piece_count = 0;
+  body->local_pieces = NULL;
+  body->world_pieces = NULL;
+  body->piece_boxes = NULL;
+  if (body->radius > 0 || shape_is_convex(body->local_shape)) {
+    return;
+  }
+  list_t *pieces = shape_decompose(body->local_shape);
+  size_t count = list_size(pieces);
+  if (count > 1) {
+    body->piece_count = count;
+    body->local_pieces = malloc(count * sizeof(shape_t *));
+    body->world_pieces = malloc(count * sizeof(shape_t *));
+    body->piece_boxes = malloc(count * sizeof(aabb_t));
+    assert(body->local_pieces != NULL && body->world_pieces != NULL);
+    assert(body->piece_boxes != NULL);
+    for (size_t i = 0; i < count; i++) {
+      body->local_pieces[i] = list_remove(pieces, 0);
+      body->world_pieces[i] = shape_init(body->local_pieces[i]->size);
+    }
+  }
+  list_free(pieces);
+}
+
+static void body_free_pieces(body_t *body) {
+  for (size_t i = 0; i < body->piece_count; i++) {
+    shape_free(body->local_pieces[i]);
+    shape_free(body->world_pieces[i]);
+  }
+  free(body->local_pieces);
+  free(body->world_pieces);
+  free(body->piece_boxes);
+}
+
+/**
+ * Allocates memory for a body that takes ownership of a packed shape whose
+ * centroid is known. The body is initially at rest.
+ * The shape is moved into the body's local space (centroid at the origin,
+ * angle 0) once here; the world vertices are derived from it on demand.
+ */
+static body_t *body_init_local(shape_t *shape, vector_t centroid,
+  double radius, double mass, rgb_color_t color, void *info,
+  free_func_t info_freer){
     body_t *body = malloc(sizeof(body_t));
     assert(body != NULL);
-    body->points = list_init(DEFAULT_SIZE, (free_func_t) vec_free);
-    assert(body->points != NULL);
-    body->points = shape;
-    body->centroid = polygon_centroid(shape);
+    assert(shape != NULL);
+    body->id = next_body_id++;
+    body->own_body = body;
+    body_store_init_single(&body->own_store, body->own_fields,
+      &body->own_flags, &body->own_body);
+    body->store = &body->own_store;
+    body->slot = body_store_add(body->store, body);
+    shape_translate(shape, vec_negate(centroid));
+    body_set_pair(body, STORE_CENTROID_X, STORE_CENTROID_Y, centroid);
+    body->local_shape = shape;
+    body->world_shape = shape_init(shape->size);
+    body->world_valid = false;
+    body->radius = radius;
+    body_init_pieces(body);
     assert(mass >= 0);
     body->mass = mass;
+    *body_field(body, STORE_INV_MASS) = 1.0 / mass;
+    *body_field(body, STORE_INV_INERTIA) = 1.0 / (mass * 100);
     body->color = color;
-    body->velocity = VEC_ZERO;
-    body->force = VEC_ZERO;
     body->info = info;
     body->info_freer = info_freer;
     body->removed = false;
-    body->angle = 0.0;
-    body->collided_with = false;
-    body->bodies_collided_with = list_init(1, (free_func_t) body_free);
-    body-> impact_pos = body->centroid; 
-    body->torque = 0.0;
-    body->angular_impulse = 0.0;
-    body->angular_velocity = 0.0;
-    body->scale_factor = 1.0;
-    body->rotate_point = body->centroid;
-    return body;
+    body->is_launched = false;
+    body->is_bullet = false;
+    body->is_sleeping = false;
+    body->still_time = 0;
+    body->category = DEFAULT_CATEGORY;
+    body->mask = DEFAULT_MASK;
     body->ground = VEC_ZERO;
+    return body;
+}
+
+/**
+ * Allocates memory for a polygon body that takes ownership of a packed shape.
+ */
+body_t *body_init_with_shape(shape_t *shape, double mass, rgb_color_t color,
+  void *info, free_func_t info_freer){
+    return body_init_local(shape, shape_centroid(shape), 0, mass, color, info,
+      info_freer);
+}
+
+/**
+ * Allocates memory for a circle body. Its shape is just its center.
+ */
+body_t *body_init_circle(vector_t center, double radius, double mass,
+  rgb_color_t color, void *info, free_func_t info_freer){
+    assert(radius > 0);
+    shape_t *core = shape_init(1);
+    core->points[0] = center;
+    return body_init_local(core, center, radius, mass, color, info,
+      info_freer);
+}
+
+/**
+ * Allocates memory for a capsule body. Its shape is the segment between the
+ * centers of its end caps.
+ */
+body_t *body_init_capsule(vector_t start, vector_t end, double radius,
+  double mass, rgb_color_t color, void *info, free_func_t info_freer){
+    assert(radius > 0);
+    shape_t *core = shape_init(2);
+    core->points[0] = start;
+    core->points[1] = end;
+    return body_init_local(core, vec_multiply(0.5, vec_add(start, end)),
+      radius, mass, color, info, info_freer);
+}
+
+/**
+ * Allocates memory for a body with the given parameters.
+ * The vertices are packed into the body's own storage and the list is freed.
+ */
+body_t *body_init_with_info(list_t *shape, double mass, rgb_color_t color,
+  void *info, free_func_t info_freer){
+    body_t *body = body_init_with_shape(shape_from_list(shape), mass, color,
+      info, info_freer);
+    list_free(shape);
+    return body;
 }
 
 /**
@@ -82,7 +240,10 @@ body_t *body_init(list_t *shape, double mass, rgb_color_t color) {
 Releases the memory allocated for a body.
   */
 void body_free(body_t *body) {
-  list_free(body->points);
+  body_detach(body);
+  shape_free(body->local_shape);
+  shape_free(body->world_shape);
+  body_free_pieces(body);
   if(body->info_freer != NULL){
     body->info_freer(body->info);
   }
@@ -94,39 +255,138 @@ Gets the current shape of a body. Returns a newly allocated vector list,
 which must be list_free()d.
  */
 list_t *body_get_shape(body_t *body) {
-  list_t *points = body->points;
-  size_t n = list_size(points);
-  list_t *returnList = list_init(n, (free_func_t) vec_free);
-  for(size_t i = 0; i < n; i++){
-    vector_t *newVec = malloc(sizeof(vector_t));
-    assert(newVec!= NULL);
-    vector_t *oldVec = list_get(points, i);
-    newVec->x = oldVec->x;
-    newVec->y = oldVec->y;
-    list_add(returnList, newVec);
+  return shape_to_list(body_get_shape_view(body));
+}
+
+/**
+Moves a local shape to a position and angle, writing the result into world.
+*/
+static void place_shape(const shape_t *local, shape_t *world,
+  vector_t centroid, double cos_angle, double sin_angle) {
+    for (size_t i = 0; i < local->size; i++) {
+      vector_t point = local->points[i];
+      world->points[i].x = centroid.x + point.x * cos_angle -
+        point.y * sin_angle;
+      world->points[i].y = centroid.y + point.x * sin_angle +
+        point.y * cos_angle;
+    }
+}
+
+/**
+Gets a read-only view of a body's current shape without copying it.
+The world vertices are only recomputed from the local shape when the body's
+position or angle changed since they were last asked for.
+The view is owned by the body and stays valid until the body is next moved,
+rotated, reshaped, or freed.
+ */
+const shape_t *body_get_shape_view(body_t *body) {
+  vector_t centroid = body_get_centroid(body);
+  double angle = *body_field(body, STORE_ANGLE);
+  if (body->world_valid && body->world_angle == angle &&
+      body->world_centroid.x == centroid.x &&
+      body->world_centroid.y == centroid.y) {
+    return body->world_shape;
+  }
+  double cos_angle = cos(angle);
+  double sin_angle = sin(angle);
+  place_shape(body->local_shape, body->world_shape, centroid, cos_angle,
+    sin_angle);
+  for (size_t i = 0; i < body->piece_count; i++) {
+    place_shape(body->local_pieces[i], body->world_pieces[i], centroid,
+      cos_angle, sin_angle);
+    body->piece_boxes[i] = aabb_of_shape(body->world_pieces[i]);
+  }
+  body->world_valid = true;
+  body->world_centroid = centroid;
+  body->world_angle = angle;
+  return body->world_shape;
+}
+
+/**
+Gets the bounding box of a body's current shape.
+*/
+aabb_t body_get_aabb(body_t *body) {
+  aabb_t box = aabb_of_shape(body_get_shape_view(body));
+  if (body->radius > 0) {
+    box = aabb_fatten(box, body->radius);
+  }
+  return box;
+}
+
+size_t body_get_piece_count(body_t *body) {
+  return body->piece_count > 0 ? body->piece_count : 1;
+}
+
+const shape_t *body_get_piece_view(body_t *body, size_t index) {
+  assert(index < body_get_piece_count(body));
+  const shape_t *shape = body_get_shape_view(body);
+  return body->piece_count > 0 ? body->world_pieces[index] : shape;
+}
+
+aabb_t body_get_piece_aabb(body_t *body, size_t index) {
+  assert(index < body_get_piece_count(body));
+  if (body->piece_count == 0) {
+    return body_get_aabb(body);
+  }
+  body_get_shape_view(body);
+  return body->piece_boxes[index];
+}
+
+/**
+Gets the kind of geometry a body has, from the size of its core shape.
+*/
+body_kind_t body_get_kind(body_t *body) {
+  if (body->radius == 0) {
+    return BODY_POLYGON;
+  }
+  return body->local_shape->size == 1 ? BODY_CIRCLE : BODY_CAPSULE;
+}
+
+/**
+Gets the radius of a circle or capsule body, or 0 for polygons.
+*/
+double body_get_radius(body_t *body) {
+  return body->radius;
+}
+
+/**
+Gets the radius of a round body, or the distance from a polygon's centroid to
+its first vertex. The local shape is centered on the centroid, and turning or
+moving the body does not change the distance.
+*/
+double body_get_reach(body_t *body) {
+  if (body->radius > 0) {
+    return body->radius;
   }
-  return returnList;
+  return vec_magnitude(body->local_shape->points[0]);
+}
+
+/**
+Gets the id that identifies a body for its whole lifetime.
+*/
+size_t body_get_id(body_t *body) {
+  return body->id;
 }
 
 /**
 Gets the current center of mass of a body.
 */
 vector_t body_get_centroid(body_t *body) {
-  return body->centroid;
+  return body_get_pair(body, STORE_CENTROID_X, STORE_CENTROID_Y);
 }
 
 /**
 Gets the current velocity of a body.
 */
 vector_t body_get_velocity(body_t *body) {
-  return body->velocity;
+  return body_get_pair(body, STORE_VELOCITY_X, STORE_VELOCITY_Y);
 }
 
 /**
 Gets the current force on a body.
 */
 vector_t body_get_force(body_t *body) {
-  return body->force;
+  return body_get_pair(body, STORE_FORCE_X, STORE_FORCE_Y);
 }
 
 /**
@@ -169,19 +429,28 @@ Translates a body to a new position.
 The position is specified by the position of the body's center of mass.
 */
 void body_set_centroid(body_t *body, vector_t x) {
-  vector_t translationVector = vec_negate(body_get_centroid(body));
-  polygon_translate(body->points, translationVector);
-  body->centroid.x = x.x;
-  body->centroid.y = x.y;
-  polygon_translate(body->points, x);
+  body_disturb(body, true);
+  body_set_pair(body, STORE_CENTROID_X, STORE_CENTROID_Y, x);
 }
 
 /**
-Sets a body's point list.
+Sets a body's point list. The vertices are packed and the list is freed.
+The new points become the body's local shape at angle 0.
 */
 void body_set_points(body_t *body, list_t *list) {
-  body->points = list;
-  body->centroid = polygon_centroid(list);
+  shape_free(body->local_shape);
+  shape_free(body->world_shape);
+  body_free_pieces(body);
+  body->local_shape = shape_from_list(list);
+  vector_t centroid = shape_centroid(body->local_shape);
+  shape_translate(body->local_shape, vec_negate(centroid));
+  body_set_centroid(body, centroid);
+  body->world_shape = shape_init(body->local_shape->size);
+  body->world_valid = false;
+  body->radius = 0;
+  body_init_pieces(body);
+  *body_field(body, STORE_ANGLE) = 0.0;
+  list_free(list);
 }
 
 /**
@@ -199,38 +468,113 @@ void body_set_launched(body_t *body, bool truth){
 }
 
 /**
-Gets the impact position of a body.
+Gets if the body is swept for collisions as it moves.
+*/
+bool body_is_bullet(body_t *body){
+  return body->is_bullet;
+}
+
+/**
+Sets if the body is swept for collisions as it moves.
+*/
+void body_set_bullet(body_t *body, bool bullet){
+  body->is_bullet = bullet;
+}
+
+void body_set_collision_filter(body_t *body, uint32_t category,
+  uint32_t mask){
+    body->category = category;
+    body->mask = mask;
+}
+
+uint32_t body_get_category(body_t *body){
+  return body->category;
+}
+
+uint32_t body_get_mask(body_t *body){
+  return body->mask;
+}
+
+/**
+Returns whether each body's category is in the other's mask.
+*/
+bool body_can_collide(body_t *body1, body_t *body2){
+  return (body1->category & body2->mask) != 0
+    && (body2->category & body1->mask) != 0;
+}
+
+bool body_is_sleeping(body_t *body){
+  return body->is_sleeping;
+}
+
+/**
+Stops a body and puts it to sleep.
+*/
+void body_sleep(body_t *body){
+  body->is_sleeping = true;
+  *body_flags(body) |= STORE_ASLEEP;
+  body_set_pair(body, STORE_VELOCITY_X, STORE_VELOCITY_Y, VEC_ZERO);
+  *body_field(body, STORE_ANGULAR_VELOCITY) = 0.0;
+}
+
+void body_wake(body_t *body){
+  body->is_sleeping = false;
+  *body_flags(body) &= ~STORE_ASLEEP;
+  body->still_time = 0;
+}
+
+double body_get_still_time(body_t *body){
+  return body->still_time;
+}
+
+void body_set_still_time(body_t *body, double time){
+  body->still_time = time;
+}
+
+/**
+Gets the impact position of a body. Unless one was set since the last tick,
+this is the body's centroid.
 */
 vector_t body_get_imp_pos(body_t *body) {
-  return body->impact_pos;
+  if (*body_flags(body) & STORE_HAS_IMPACT) {
+    return body->impact_pos;
+  }
+  return body_get_centroid(body);
 }
 
 /**
-Gets the rotation point of a body.
+Gets the rotation point of a body. Unless one was set since the last tick,
+this is the body's centroid.
 */
 vector_t body_get_rot_point(body_t *body) {
-  return body->rotate_point;
+  if (*body_flags(body) & STORE_HAS_PIVOT) {
+    return body->rotate_point;
+  }
+  return body_get_centroid(body);
 }
 
 /**
 Changes a body's velocity (the time-derivative of its position).
 */
 void body_set_velocity(body_t *body, vector_t v) {
-  body->velocity = v;
+  body_disturb(body, v.x != 0 || v.y != 0);
+  body_set_pair(body, STORE_VELOCITY_X, STORE_VELOCITY_Y, v);
 }
 
 /**
 Sets angular velocity.
 */
 void body_set_angular_velocity(body_t *body, double v) {
-  body->angular_velocity = v;
+  body_disturb(body, v != 0);
+  *body_field(body, STORE_ANGULAR_VELOCITY) = v;
 }
 
 /**
 Sets torque of body.
 */
 void body_set_torque (body_t *body, double v) {
-  body->torque = v;
+  body_disturb(body, v != 0);
+  *body_field(body, STORE_TORQUE) = v;
 }
 
 /**
@@ -239,17 +583,23 @@ Sets impact position of a body.
 void body_set_impact_pos(body_t *body, vector_t pos){
   body->impact_pos = pos;
   body->rotate_point = body->impact_pos;
+  *body_flags(body) |= STORE_HAS_IMPACT | STORE_HAS_PIVOT;
 }
 
 
 /**
-Changes a body's orientation in the plane.
-The body is rotated about its center of mass.
-Note that the angle is *absolute*, not relative to the current orientation.
+Rotates a body by an angle relative to its current orientation, about its
+rotation point. When that point is not the centroid, the centroid swings
+around it too, so body_get_centroid() changes along with the angle.
 */
 void body_set_rotation(body_t *body, double angle_to_rotate) {
-  polygon_rotate(body->points, angle_to_rotate, body->rotate_point);
-  body->angle = (body->angle + angle_to_rotate) ;
+  // Rotating about a point other than the centroid also swings the centroid
+  // around that point; the local shape itself never changes.
+  vector_t rotate_point = body_get_rot_point(body);
+  vector_t offset = vec_subtract(body_get_centroid(body), rotate_point);
+  body_set_centroid(body, vec_add(rotate_point,
+    vec_rotate(offset, angle_to_rotate)));
+  *body_field(body, STORE_ANGLE) += angle_to_rotate;
 }
 
 /**
@@ -257,13 +607,16 @@ Sets a body's rotation point.
 */
 void body_set_rotation_point(body_t* body, vector_t rotation_point){
   body->rotate_point = rotation_point;
+  *body_flags(body) |= STORE_HAS_PIVOT;
 }
 
 /**
 Adds a force to a body. This is for backwards compatibility.
 */
 void body_add_force(body_t *body, vector_t force) {
-  body->force = vec_add(body->force, force);
+  body_disturb(body, force.x != 0 || force.y != 0);
+  body_set_pair(body, STORE_FORCE_X, STORE_FORCE_Y,
+    vec_add(body_get_force(body), force));
 }
 
 
@@ -271,14 +624,15 @@ void body_add_force(body_t *body, vector_t force) {
 Adds torque to a body.
 */
 void body_add_torque(body_t *body, double add){
-  body->torque += add;
+  body_disturb(body, add != 0);
+  *body_field(body, STORE_TORQUE) += add;
 }
 
 /**
 Gets torque of a body.
 */
 double body_get_torque(body_t *body){
-  return body->torque;
+  return *body_field(body, STORE_TORQUE);
 }
 
 /**
@@ -286,55 +640,58 @@ Adds the force with an impact position set to add torque.
 */
 void body_add_force_imp_pos(body_t *body, vector_t force, vector_t imp_pos) {
 
-  body->force = vec_add(body->force, force);
+  body_add_force(body, force);
 
-  double force_mag = vec_magnitude(body->force);////
-  vector_t radial_line = vec_subtract(body->impact_pos, body->rotate_point);
-  double angle_btwn = ang_diff(radial_line, body->force); ////
+  vector_t total_force = body_get_force(body);
+  vector_t impact_pos = body_get_imp_pos(body);
+  vector_t centroid = body_get_centroid(body);
+  double force_mag = vec_magnitude(total_force);////
+  vector_t radial_line = vec_subtract(impact_pos, body_get_rot_point(body));
+  double angle_btwn = ang_diff(radial_line, total_force); ////
   double translational = force_mag * cos(angle_btwn);
   double rotational =  force_mag * sin(angle_btwn);
-  if(force_mag != 0.0){
-    body->scale_factor = translational / force_mag;
-  }
 
   double distance = vec_magnitude(radial_line);
-  if(((body->impact_pos.x == body->centroid.x) && (body->impact_pos.y ==
-    body->centroid.y))){
+  if(((impact_pos.x == centroid.x) && (impact_pos.y ==
+    centroid.y))){
     distance = 0.0;
   }
   if(translational == 0.0){
     rotational = 0.0;
   }
 
-  body->torque = distance * rotational;
+  body_set_torque(body, distance * rotational);
 
 }
 /**
 Add impulse to a body.
 */
 void body_add_impulse(body_t *body, vector_t impulse) {
-  body->impulse = vec_add(body->impulse, impulse);
+  body_disturb(body, impulse.x != 0 || impulse.y != 0);
+  body_set_pair(body, STORE_IMPULSE_X, STORE_IMPULSE_Y,
+    vec_add(body_get_pair(body, STORE_IMPULSE_X, STORE_IMPULSE_Y), impulse));
 }
 
 /**
 Sets angular impulse of a body to v.
 */
 void body_set_angular_impulse(body_t *body, double v){
-  body->angular_velocity = v;
+  body_set_angular_velocity(body, v);
 }
 
 /**
 Adds v to current angular impulse.
 */
 void body_add_angular_impulse(body_t *body, double v){
-  body->angular_impulse += v;
+  body_disturb(body, v != 0);
+  *body_field(body, STORE_ANGULAR_IMPULSE) += v;
 }
 
 /**
 Returns angular velocity.
 */
 double body_get_angular_velocity(body_t *body){
-  return body->angular_velocity;
+  return *body_field(body, STORE_ANGULAR_VELOCITY);
 }
 
 
@@ -356,46 +713,30 @@ double ang_diff(vector_t one, vector_t two){
 
 /**
 Moves a body at its current velocity over a given time interval.
+The integration itself is shared with scene stores; see body_store_tick().
 */
 void body_tick(body_t *body, double dt) {
   if(!body_is_removed(body)) {
+    body_store_tick_range(body->store, body->slot, body->slot + 1, dt);
+  }
+}
 
-  // calcuating effects of linear forces with adjusted force from above
-    vector_t old_velocity = body_get_velocity(body);
-    body->impulse.x = body->impulse.x + (dt * (body->force.x));
-    body->impulse.y = body->impulse.y + (dt * (body->force.y));
-    vector_t new_velocity = {old_velocity.x + ((1.0/body->mass) *
-      body->impulse.x),
-                            old_velocity.y + ((1.0/body->mass) *
-                            body->impulse.y)};
-
-    body_set_velocity(body, new_velocity);
-    double translate_x = (body->velocity.x + old_velocity.x) * dt * ACC_MULT;
-    double translate_y = (body->velocity.y + old_velocity.y) * dt * ACC_MULT;
-    vector_t translation_vector = {translate_x, translate_y};
-
-
-     double old_ang_velo = body->angular_velocity;
-     body->angular_impulse = body->angular_impulse + (dt *(body->torque));
-     double ang_velo = old_ang_velo + ((1.0/(body->mass * 100)) *
-     body->angular_impulse);
-     body_set_angular_velocity(body, ang_velo);
-     double angle_to_move = body->angular_velocity * dt * 1.0;
-     if(angle_to_move != 0.0){
-          body_set_rotation(body, angle_to_move);
-     }
-
-     body_set_centroid(body, vec_add(body_get_centroid(body),
-     translation_vector));
-    body->impact_pos = body->centroid;
-    body->rotate_point = body->centroid;
-    body->force = VEC_ZERO;
-    body->impulse = VEC_ZERO;
-    body->torque = 0.0;
-    body->angular_impulse = 0.0;
-
-    body->scale_factor = 1.0;
+/**
+Moves a body's hot state into a store, or back into the body's own storage
+if store is NULL.
+*/
+void body_set_store(body_t *body, body_store_t *store) {
+  if (store == NULL) {
+    store = &body->own_store;
+  }
+  if (store == body->store) {
+    return;
   }
+  size_t slot = body_store_add(store, body);
+  body_store_copy_slot(store, slot, body->store, body->slot);
+  body_detach(body);
+  body->store = store;
+  body->slot = slot;
 }
 
 /**
@@ -415,23 +756,3 @@ void body_remove(body_t *body) {
 bool body_is_removed(body_t *body){
   return body->removed;
 }
-
-void body_collided(body_t *body, bool is_collided) {
-  body->collided_with = is_collided;
-}
-
-bool body_is_collided(body_t *body) {
-  return body->collided_with;
-}
-
-void body_set_collision_body(body_t *body, body_t *collided) {
-  list_add(body->bodies_collided_with, collided);
-}
-
-list_t *body_get_collision_bodies(body_t *body) {
-  return body->bodies_collided_with;
-}
-
-void body_remove_collision_body(body_t *body, int index){
-  list_remove(body->bodies_collided_with, index);
-}
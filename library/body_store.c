@@ -0,0 +1,303 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h>
+#include "body_store.h"
+#include "body.h"
+
+/*
+The integration kernel is chosen at build time: 4 bodies per instruction with
+AVX2 (e.g. -mavx2), 2 with SSE2 (the x86-64 default), or plain scalar loops.
+Define STORE_NO_SIMD to force the scalar kernel.
+*/
+#if defined(__AVX2__) && !defined(STORE_NO_SIMD)
+#include <immintrin.h>
+#define STORE_LANES 4
+typedef __m256d lanes_t;
+#define lanes_set(v) _mm256_set1_pd(v)
+#define lanes_zero() _mm256_setzero_pd()
+#define lanes_load(p) _mm256_loadu_pd(p)
+#define lanes_store(p, v) _mm256_storeu_pd(p, v)
+#define lanes_add(a, b) _mm256_add_pd(a, b)
+#define lanes_mul(a, b) _mm256_mul_pd(a, b)
+#elif defined(__SSE2__) && !defined(STORE_NO_SIMD)
+#include <emmintrin.h>
+#define STORE_LANES 2
+typedef __m128d lanes_t;
+#define lanes_set(v) _mm_set1_pd(v)
+#define lanes_zero() _mm_setzero_pd()
+#define lanes_load(p) _mm_loadu_pd(p)
+#define lanes_store(p, v) _mm_storeu_pd(p, v)
+#define lanes_add(a, b) _mm_add_pd(a, b)
+#define lanes_mul(a, b) _mm_mul_pd(a, b)
+#else
+#define STORE_LANES 1
+#endif
+
+const double STORE_ACC_MULT = 0.5;
+const size_t STORE_MIN_CAPACITY = 4;
+
+/**
+Points each field array into one block of capacity * STORE_FIELDS doubles.
+*/
+static void body_store_alloc(body_store_t *store, size_t capacity) {
+  double *data = calloc(capacity * STORE_FIELDS, sizeof(double));
+  assert(data != NULL);
+  for (size_t f = 0; f < STORE_FIELDS; f++) {
+    store->fields[f] = data + f * capacity;
+  }
+  store->flags = calloc(capacity, sizeof(unsigned char));
+  assert(store->flags != NULL);
+  store->bodies = malloc(capacity * sizeof(body_t *));
+  assert(store->bodies != NULL);
+  store->capacity = capacity;
+}
+
+/**
+Allocates memory for an empty store with room for capacity bodies.
+*/
+body_store_t *body_store_init(size_t capacity) {
+  body_store_t *store = malloc(sizeof(body_store_t));
+  assert(store != NULL);
+  if (capacity < STORE_MIN_CAPACITY) {
+    capacity = STORE_MIN_CAPACITY;
+  }
+  body_store_alloc(store, capacity);
+  store->size = 0;
+  store->owns_memory = true;
+  return store;
+}
+
+/**
+Initializes a one-slot store on memory owned by the caller.
+*/
+void body_store_init_single(body_store_t *store, double *fields,
+  unsigned char *flags, body_t **bodies) {
+    for (size_t f = 0; f < STORE_FIELDS; f++) {
+      store->fields[f] = fields + f;
+    }
+    store->flags = flags;
+    store->bodies = bodies;
+    store->size = 0;
+    store->capacity = 1;
+    store->owns_memory = false;
+}
+
+/**
+Releases the memory allocated for a store. Does not free its bodies.
+*/
+void body_store_free(body_store_t *store) {
+  assert(store->owns_memory);
+  free(store->fields[0]);
+  free(store->flags);
+  free(store->bodies);
+  free(store);
+}
+
+/**
+Doubles the capacity of a store, keeping the occupied slots.
+*/
+static void body_store_grow(body_store_t *store) {
+  assert(store->owns_memory);
+  body_store_t old = *store;
+  body_store_alloc(store, 2 * old.capacity);
+  for (size_t f = 0; f < STORE_FIELDS; f++) {
+    memcpy(store->fields[f], old.fields[f], old.size * sizeof(double));
+  }
+  memcpy(store->flags, old.flags, old.size * sizeof(unsigned char));
+  memcpy(store->bodies, old.bodies, old.size * sizeof(body_t *));
+  free(old.fields[0]);
+  free(old.flags);
+  free(old.bodies);
+}
+
+/**
+Appends a zeroed slot for a body and returns its index.
+*/
+size_t body_store_add(body_store_t *store, body_t *body) {
+  if (store->size == store->capacity) {
+    body_store_grow(store);
+  }
+  size_t slot = store->size++;
+  for (size_t f = 0; f < STORE_FIELDS; f++) {
+    store->fields[f][slot] = 0.0;
+  }
+  store->flags[slot] = 0;
+  store->bodies[slot] = body;
+  return slot;
+}
+
+/**
+Removes a slot by moving the last slot into it.
+Returns the moved body so its owner can update its slot index.
+*/
+body_t *body_store_remove(body_store_t *store, size_t slot) {
+  assert(slot < store->size);
+  size_t last = --store->size;
+  if (slot == last) {
+    return NULL;
+  }
+  body_store_copy_slot(store, slot, store, last);
+  store->bodies[slot] = store->bodies[last];
+  return store->bodies[slot];
+}
+
+/**
+Copies the fields and flags of one slot into another.
+*/
+void body_store_copy_slot(body_store_t *to, size_t to_slot,
+  body_store_t *from, size_t from_slot) {
+    for (size_t f = 0; f < STORE_FIELDS; f++) {
+      to->fields[f][to_slot] = from->fields[f][from_slot];
+    }
+    to->flags[to_slot] = from->flags[from_slot];
+}
+
+#if STORE_LANES > 1
+/**
+Integrates slots [start, end) STORE_LANES bodies at a time, with the same
+operations in the same order as the scalar loop below.
+Returns the first slot that was left for the scalar loop.
+*/
+static size_t body_store_tick_lanes(body_store_t *store, size_t start,
+  size_t end, double dt) {
+    double *restrict x = store->fields[STORE_CENTROID_X];
+    double *restrict y = store->fields[STORE_CENTROID_Y];
+    double *restrict vx = store->fields[STORE_VELOCITY_X];
+    double *restrict vy = store->fields[STORE_VELOCITY_Y];
+    double *restrict fx = store->fields[STORE_FORCE_X];
+    double *restrict fy = store->fields[STORE_FORCE_Y];
+    double *restrict jx = store->fields[STORE_IMPULSE_X];
+    double *restrict jy = store->fields[STORE_IMPULSE_Y];
+    double *restrict inv_mass = store->fields[STORE_INV_MASS];
+    double *restrict angle = store->fields[STORE_ANGLE];
+    double *restrict omega = store->fields[STORE_ANGULAR_VELOCITY];
+    double *restrict torque = store->fields[STORE_TORQUE];
+    double *restrict ang_impulse = store->fields[STORE_ANGULAR_IMPULSE];
+    double *restrict inv_inertia = store->fields[STORE_INV_INERTIA];
+    lanes_t dt_lanes = lanes_set(dt);
+    lanes_t half_dt = lanes_set(dt * STORE_ACC_MULT);
+    lanes_t zero = lanes_zero();
+
+    size_t i = start;
+    for (; i + STORE_LANES <= end; i += STORE_LANES) {
+      lanes_t new_ang_impulse = lanes_add(lanes_load(ang_impulse + i),
+        lanes_mul(dt_lanes, lanes_load(torque + i)));
+      lanes_t new_omega = lanes_add(lanes_load(omega + i),
+        lanes_mul(lanes_load(inv_inertia + i), new_ang_impulse));
+      lanes_store(omega + i, new_omega);
+      lanes_store(angle + i, lanes_add(lanes_load(angle + i),
+        lanes_mul(new_omega, dt_lanes)));
+      lanes_store(torque + i, zero);
+      lanes_store(ang_impulse + i, zero);
+
+      lanes_t lanes_inv_mass = lanes_load(inv_mass + i);
+      lanes_t old_vx = lanes_load(vx + i);
+      lanes_t old_vy = lanes_load(vy + i);
+      lanes_t new_vx = lanes_add(old_vx, lanes_mul(lanes_inv_mass,
+        lanes_add(lanes_load(jx + i), lanes_mul(dt_lanes,
+        lanes_load(fx + i)))));
+      lanes_t new_vy = lanes_add(old_vy, lanes_mul(lanes_inv_mass,
+        lanes_add(lanes_load(jy + i), lanes_mul(dt_lanes,
+        lanes_load(fy + i)))));
+      lanes_store(vx + i, new_vx);
+      lanes_store(vy + i, new_vy);
+      lanes_store(x + i, lanes_add(lanes_load(x + i),
+        lanes_mul(lanes_add(new_vx, old_vx), half_dt)));
+      lanes_store(y + i, lanes_add(lanes_load(y + i),
+        lanes_mul(lanes_add(new_vy, old_vy), half_dt)));
+      lanes_store(fx + i, zero);
+      lanes_store(fy + i, zero);
+      lanes_store(jx + i, zero);
+      lanes_store(jy + i, zero);
+    }
+    return i;
+}
+#endif
+
+/**
+Integrates slots [start, end). Whole groups of bodies go through the SIMD
+kernel when there is one; the rest go through the scalar loop. Only bodies
+rotating about a point other than their centroid need a look at their body_t.
+*/
+void body_store_tick_range(body_store_t *store, size_t start, size_t end,
+  double dt) {
+    double *restrict x = store->fields[STORE_CENTROID_X];
+    double *restrict y = store->fields[STORE_CENTROID_Y];
+    double *restrict vx = store->fields[STORE_VELOCITY_X];
+    double *restrict vy = store->fields[STORE_VELOCITY_Y];
+    double *restrict fx = store->fields[STORE_FORCE_X];
+    double *restrict fy = store->fields[STORE_FORCE_Y];
+    double *restrict jx = store->fields[STORE_IMPULSE_X];
+    double *restrict jy = store->fields[STORE_IMPULSE_Y];
+    double *restrict inv_mass = store->fields[STORE_INV_MASS];
+    double *restrict angle = store->fields[STORE_ANGLE];
+    double *restrict omega = store->fields[STORE_ANGULAR_VELOCITY];
+    double *restrict torque = store->fields[STORE_TORQUE];
+    double *restrict ang_impulse = store->fields[STORE_ANGULAR_IMPULSE];
+    double *restrict inv_inertia = store->fields[STORE_INV_INERTIA];
+
+    // Pivoting swings the centroid about the rotation point, which has to
+    // happen before the centroid is translated (as body_tick() always did).
+    for (size_t i = start; i < end; i++) {
+      if (store->flags[i] & STORE_HAS_PIVOT) {
+        double angle_to_move = (omega[i] + inv_inertia[i] *
+          (ang_impulse[i] + dt * torque[i])) * dt;
+        if (angle_to_move != 0.0) {
+          vector_t pivot = body_get_rot_point(store->bodies[i]);
+          vector_t offset = vec_rotate(vec_init(x[i] - pivot.x,
+            y[i] - pivot.y), angle_to_move);
+          x[i] = pivot.x + offset.x;
+          y[i] = pivot.y + offset.y;
+        }
+      }
+    }
+
+    size_t i = start;
+#if STORE_LANES > 1
+    i = body_store_tick_lanes(store, start, end, dt);
+#endif
+    for (; i < end; i++) {
+      ang_impulse[i] = ang_impulse[i] + dt * torque[i];
+      omega[i] = omega[i] + inv_inertia[i] * ang_impulse[i];
+      angle[i] = angle[i] + omega[i] * dt;
+      torque[i] = 0.0;
+      ang_impulse[i] = 0.0;
+
+      double old_vx = vx[i];
+      double old_vy = vy[i];
+      jx[i] = jx[i] + dt * fx[i];
+      jy[i] = jy[i] + dt * fy[i];
+      vx[i] = old_vx + inv_mass[i] * jx[i];
+      vy[i] = old_vy + inv_mass[i] * jy[i];
+      x[i] = x[i] + (vx[i] + old_vx) * dt * STORE_ACC_MULT;
+      y[i] = y[i] + (vy[i] + old_vy) * dt * STORE_ACC_MULT;
+      fx[i] = 0.0;
+      fy[i] = 0.0;
+      jx[i] = 0.0;
+      jy[i] = 0.0;
+    }
+
+    for (size_t j = start; j < end; j++) {
+      store->flags[j] &= STORE_ASLEEP;
+    }
+}
+
+/**
+Integrates every awake body in a store, one run of awake slots at a time.
+*/
+void body_store_tick(body_store_t *store, double dt) {
+  size_t start = 0;
+  while (start < store->size) {
+    while (start < store->size && (store->flags[start] & STORE_ASLEEP)) {
+      start++;
+    }
+    size_t end = start;
+    while (end < store->size && !(store->flags[end] & STORE_ASLEEP)) {
+      end++;
+    }
+    body_store_tick_range(store, start, end, dt);
+    start = end;
+  }
+}
@@ -37,26 +37,18 @@ double get_color(void) {
  * Function that creates a star of a provided number of sides and at a given
  center
 */
-list_t *create_star(int sides, vector_t center) {
+shape_t *create_star(int sides, vector_t center) {
   double starTipLength = (double) random_number(MIN_RAD, MAX_RAD);
   double starBendLength = starTipLength * BEND_SCALAR;
-  list_t *listOfPoints = list_init(sides * 2, (free_func_t) vec_free);
-  vector_t *startingPoint = malloc(sizeof(vector_t));
-  *startingPoint = vec_init(center.x, center.y);
+  shape_t *star = shape_init(sides * 2);
   double angleToRotate = FULL_CIRCLE / (sides * 2);
   for (int i = 0; i < sides * 2; i++) {
-    if(i % 2 == 0) {
-      vector_t *starTip = malloc(sizeof(vector_t));
-      *starTip = vec_init(startingPoint->x, startingPoint->y + starTipLength);
-      list_add(listOfPoints, starTip);
-    }
-    else {
-      vector_t *starBend = malloc(sizeof(vector_t));
-      *starBend = vec_init(startingPoint->x, startingPoint->y + starBendLength);
-      list_add(listOfPoints, starBend);
-    }
-    polygon_rotate(listOfPoints, -angleToRotate, *startingPoint);
+    // Each new vertex starts straight above the center and then is rotated
+    // into place, so vertex i ends up rotated by (sides * 2 - i) steps.
+    double length = (i % 2 == 0) ? starTipLength : starBendLength;
+    vector_t point = vec_init(0, length);
+    point = vec_rotate(point, -angleToRotate * (sides * 2 - i));
+    star->points[i] = vec_add(center, point);
   }
-  free(startingPoint);
-  return listOfPoints;
+  return star;
 }
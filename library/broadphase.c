@@ -0,0 +1,100 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "broadphase.h"
+
+typedef struct broadphase {
+  void *state;
+  broadphase_add_t add;
+  broadphase_remove_t remove;
+  broadphase_pairs_t find_pairs;
+  broadphase_query_t query;
+  broadphase_raycast_t raycast;
+  free_func_t freer;
+} broadphase_t;
+
+/**
+Allocates a broadphase wrapping an implementation's state and functions.
+*/
+broadphase_t *broadphase_init(void *state, broadphase_add_t add,
+  broadphase_remove_t remove, broadphase_pairs_t find_pairs,
+  free_func_t freer) {
+    broadphase_t *broadphase = malloc(sizeof(broadphase_t));
+    assert(broadphase != NULL);
+    broadphase->state = state;
+    broadphase->add = add;
+    broadphase->remove = remove;
+    broadphase->find_pairs = find_pairs;
+    broadphase->query = NULL;
+    broadphase->raycast = NULL;
+    broadphase->freer = freer;
+    return broadphase;
+}
+
+/**
+Releases a broadphase and its state, but not the bodies it tracks.
+*/
+void broadphase_free(broadphase_t *broadphase) {
+  if (broadphase->freer != NULL) {
+    broadphase->freer(broadphase->state);
+  }
+  free(broadphase);
+}
+
+void *broadphase_get_state(broadphase_t *broadphase) {
+  return broadphase->state;
+}
+
+void broadphase_add(broadphase_t *broadphase, body_t *body) {
+  broadphase->add(broadphase->state, body);
+}
+
+void broadphase_remove(broadphase_t *broadphase, body_t *body) {
+  broadphase->remove(broadphase->state, body);
+}
+
+void broadphase_find_pairs(broadphase_t *broadphase, pair_map_t *pairs) {
+  broadphase->find_pairs(broadphase->state, pairs);
+}
+
+void broadphase_set_query(broadphase_t *broadphase, broadphase_query_t query) {
+  broadphase->query = query;
+}
+
+bool broadphase_query(broadphase_t *broadphase, aabb_t region,
+  body_query_t callback, void *aux) {
+    if (broadphase->query == NULL) {
+      return false;
+    }
+    broadphase->query(broadphase->state, region, callback, aux);
+    return true;
+}
+
+void broadphase_set_raycast(broadphase_t *broadphase,
+  broadphase_raycast_t raycast) {
+    broadphase->raycast = raycast;
+}
+
+bool broadphase_raycast(broadphase_t *broadphase, vector_t origin,
+  vector_t direction, double max_t, body_raycast_t callback, void *aux) {
+    if (broadphase->raycast == NULL) {
+      return false;
+    }
+    broadphase->raycast(broadphase->state, origin, direction, max_t, callback,
+      aux);
+    return true;
+}
+
+/**
+Records a pair of possibly colliding bodies, once per pair, unless their
+collision filters rule it out.
+*/
+void broadphase_add_pair(pair_map_t *pairs, body_t *body1, body_t *body2) {
+  if (!body_can_collide(body1, body2)) {
+    return;
+  }
+  body_pair_t *pair = pair_map_put(pairs,
+    pair_key(body_get_id(body1), body_get_id(body2)));
+  pair->body1 = body1;
+  pair->body2 = body2;
+}
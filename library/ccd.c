@@ -0,0 +1,230 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "ccd.h"
+#include "collision.h"
+
+// How close bodies must get for conservative advancement to stop
+const double CCD_TOLERANCE = 0.05;
+// How far past their first contact the bodies are allowed to sink
+const double CCD_PENETRATION = 0.5;
+const size_t CCD_MAX_ITERATIONS = 32;
+
+/**
+Gets the number of edges of a shape. A segment has one and a point has one
+of length 0.
+*/
+static size_t ccd_edges(const shape_t *shape) {
+  return shape->size > 2 ? shape->size : 1;
+}
+
+/**
+Finds the distance between the boundaries of two shapes, the second moved by
+an offset, the unit direction from the first's closest point towards the
+second's, and the first's closest point. All are only meaningful if the shapes
+do not overlap.
+*/
+static double ccd_distance(const shape_t *shape1, const shape_t *shape2,
+  vector_t offset, vector_t *direction, vector_t *closest) {
+    double least_distance = INFINITY;
+    vector_t between = VEC_ZERO;
+    for (size_t i = 0; i < ccd_edges(shape1); i++) {
+      vector_t p1 = shape1->points[i];
+      vector_t q1 = shape1->points[(i + 1) % shape1->size];
+      for (size_t j = 0; j < ccd_edges(shape2); j++) {
+        vector_t p2 = vec_add(shape2->points[j], offset);
+        vector_t q2 = vec_add(shape2->points[(j + 1) % shape2->size], offset);
+        vector_t c1, c2;
+        double distance = closest_segment_points(p1, q1, p2, q2, &c1, &c2);
+        if (distance < least_distance) {
+          least_distance = distance;
+          between = vec_subtract(c2, c1);
+          *closest = c1;
+        }
+      }
+    }
+    least_distance = sqrt(least_distance);
+    *direction = least_distance > 0
+      ? vec_multiply(1 / least_distance, between) : VEC_ZERO;
+    return least_distance;
+}
+
+double shape_time_of_impact(const shape_t *still, double still_radius,
+  const shape_t *moving, double moving_radius, vector_t velocity, double dt,
+  vector_t *normal, vector_t *point) {
+    double radius = still_radius + moving_radius;
+    double t = 0;
+    *normal = VEC_ZERO;
+    for (size_t i = 0; i < CCD_MAX_ITERATIONS; i++) {
+      vector_t direction;
+      vector_t closest;
+      double distance = ccd_distance(still, moving,
+        vec_multiply(t, velocity), &direction, &closest) - radius;
+      // the distance shrinks no faster than this while the shapes translate;
+      // touching shapes have no direction, so any motion might close them
+      double closing_speed = distance > -radius
+        ? -vec_dot(velocity, direction) : vec_magnitude(velocity);
+      if (closing_speed <= 0) {
+        return INFINITY;
+      }
+      // shapes that end up exactly touching keep the last direction found
+      if (distance > -radius) {
+        *normal = direction;
+      }
+      *point = vec_add(closest, vec_multiply(still_radius, *normal));
+      if (distance <= CCD_TOLERANCE) {
+        return t;
+      }
+      t += distance / closing_speed;
+      if (t > dt) {
+        return INFINITY;
+      }
+    }
+    // still approaching after every iteration, so the shapes are nearly there
+    return t;
+}
+
+double time_of_impact(body_t *body1, body_t *body2, double dt) {
+  if (get_if_collided(find_collision(body1, body2))) {
+    return INFINITY;
+  }
+  // body1 stays put while body2 moves at the velocity relative to it
+  vector_t velocity = vec_subtract(body_get_velocity(body2),
+    body_get_velocity(body1));
+  vector_t normal;
+  vector_t point;
+  double t = shape_time_of_impact(body_get_shape_view(body1),
+    body_get_radius(body1), body_get_shape_view(body2),
+    body_get_radius(body2), velocity, dt, &normal, &point);
+  if (t == INFINITY) {
+    return INFINITY;
+  }
+  double closing_speed = normal.x != 0 || normal.y != 0
+    ? -vec_dot(velocity, normal) : vec_magnitude(velocity);
+  return fmin(t + CCD_PENETRATION / closing_speed, dt);
+}
+
+/**
+Finds where a ray enters a convex polygon by clipping it against each edge's
+half-plane (the Cyrus-Beck algorithm).
+*/
+static double ray_polygon(const vector_t *points, size_t size,
+  vector_t origin, vector_t direction, double max_t, vector_t *normal) {
+    // the sign of the area tells which way the polygon winds
+    double area = 0;
+    for (size_t i = 0; i < size; i++) {
+      area += vec_cross(points[i], points[(i + 1) % size]);
+    }
+    double enter = -INFINITY;
+    double leave = max_t;
+    vector_t enter_normal = VEC_ZERO;
+    for (size_t i = 0; i < size; i++) {
+      vector_t start = points[i];
+      vector_t edge = vec_subtract(points[(i + 1) % size], start);
+      vector_t outwards = area > 0
+        ? vec_init(edge.y, -edge.x) : vec_init(-edge.y, edge.x);
+      double distance = vec_dot(outwards, vec_subtract(start, origin));
+      double speed = vec_dot(outwards, direction);
+      if (speed == 0) {
+        // parallel to the edge, so the ray stays on one side of it
+        if (distance < 0) {
+          return INFINITY;
+        }
+        continue;
+      }
+      double t = distance / speed;
+      if (speed < 0 && t > enter) {
+        enter = t;
+        enter_normal = outwards;
+      }
+      else if (speed > 0 && t < leave) {
+        leave = t;
+      }
+      if (enter > leave) {
+        return INFINITY;
+      }
+    }
+    // rays starting inside the polygon do not hit it
+    if (enter < 0) {
+      return INFINITY;
+    }
+    *normal = vec_unit(enter_normal);
+    return enter;
+}
+
+/**
+Finds where a ray enters a circle, by solving |origin + t * direction -
+center| = radius for the smaller t.
+*/
+static double ray_circle(vector_t center, double radius, vector_t origin,
+  vector_t direction, double max_t, vector_t *normal) {
+    vector_t from_center = vec_subtract(origin, center);
+    double a = vec_dot(direction, direction);
+    double b = vec_dot(from_center, direction);
+    double c = vec_dot(from_center, from_center) - radius * radius;
+    double discriminant = b * b - a * c;
+    if (a == 0 || discriminant < 0) {
+      return INFINITY;
+    }
+    double t = (-b - sqrt(discriminant)) / a;
+    if (t < 0 || t > max_t) {
+      return INFINITY;
+    }
+    *normal = vec_unit(vec_add(from_center, vec_multiply(t, direction)));
+    return t;
+}
+
+double ray_time_of_impact(body_t *body, vector_t origin, vector_t direction,
+  double max_t, vector_t *normal) {
+    const shape_t *shape = body_get_shape_view(body);
+    double radius = body_get_radius(body);
+    if (radius == 0) {
+      // concave polygons are entered where the ray first enters a piece
+      double t = INFINITY;
+      for (size_t i = 0; i < body_get_piece_count(body); i++) {
+        const shape_t *piece = body_get_piece_view(body, i);
+        vector_t piece_normal;
+        double piece_t = ray_polygon(piece->points, piece->size, origin,
+          direction, fmin(t, max_t), &piece_normal);
+        if (piece_t < t) {
+          t = piece_t;
+          *normal = piece_normal;
+        }
+      }
+      return t;
+    }
+    // a capsule is a rectangle along its core with a circle at each end
+    vector_t start = shape->points[0];
+    vector_t end = shape->points[shape->size - 1];
+    vector_t on_core;
+    vector_t on_ray;
+    if (closest_segment_points(start, end, origin, origin, &on_core, &on_ray)
+      <= radius * radius) {
+        return INFINITY;
+    }
+    double t = ray_circle(start, radius, origin, direction, max_t, normal);
+    vector_t end_normal;
+    double end_t = ray_circle(end, radius, origin, direction, fmin(t, max_t),
+      &end_normal);
+    if (end_t < t) {
+      t = end_t;
+      *normal = end_normal;
+    }
+    vector_t along = vec_subtract(end, start);
+    if (along.x != 0 || along.y != 0) {
+      vector_t side = vec_multiply(radius / vec_magnitude(along),
+        vec_init(-along.y, along.x));
+      vector_t rectangle[] = {
+        vec_add(start, side), vec_subtract(start, side),
+        vec_subtract(end, side), vec_add(end, side)
+      };
+      vector_t side_normal;
+      double side_t = ray_polygon(rectangle, 4, origin, direction,
+        fmin(t, max_t), &side_normal);
+      if (side_t < t) {
+        t = side_t;
+        *normal = side_normal;
+      }
+    }
+    return t;
+}
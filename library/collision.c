@@ -9,7 +9,6 @@
 #include "collision.h"
 
 
-const double NINETY_DEGREES = 1.5070796327;
 const double NEGATE = -1;
 const int TYPE_MIN = 1;
 const int TYPE_MAX = 2;
@@ -34,6 +33,16 @@ void set_collided(collision_info_t collision_info, bool collided) {
   collision_info.collided = collided;
 }
 
+/**
+* Clamps a value to [0, 1].
+**/
+static double clamp_unit(double value){
+  if(value < 0){
+    return 0;
+  }
+  return value > 1 ? 1 : value;
+}
+
 double extrema(double a, double b, int type) {
   if (type == 0) {
     if (a < b) {
@@ -93,56 +102,6 @@ bool do_intersect(vector_t p1, vector_t q1, vector_t p2, vector_t q2)
     return false;
 }
 
-vector_t point_of_intersect(vector_t p1, vector_t q1, vector_t p2, vector_t q2){
-  double dy1 = q1.y - p1.y;
-  double dx1 = q1.x - p1.x;
-  double m1 = dy1/dx1;
-  double b1 = p1.y - (m1 * p1.x);
-
-  double dy2 = q2.y - p2.y;
-  double dx2 = q2.x - p2.x;
-
-  double m2 = dy2 / dx2;
-  double b2 = p2.y - (m2 * p2.x);
-  double good_x = (b2 -b1)/(m1-m2);
-  double good_y = m1 * good_x + b1;
-  if (dx2 != 0 && dx1 != 0) {
-    return(vec_init(good_x, good_y));
-  }
-  //now handle cases where dx is 0
-  if(dx1 == 0){
-    good_x = q1.x;
-    good_y = m2 * good_x + b2;
-    return(vec_init(good_x, good_y));
-  }
-  if(dx2 == 0){
-    good_x = q2.x;
-    good_y = m1 * good_x + b1;
-    return(vec_init(good_x, good_y));
-  }
-  return(vec_init(0,0));
-}
-
-//only call this if you know that two bodies do indeed intersect
-vector_t bodies_intersect(body_t *bod1, body_t *bod2){
-  list_t *shape1 = body_get_shape(bod1);
-  list_t *shape2 = body_get_shape(bod2);
-  int size1 = list_size(shape1);
-  int size2 = list_size(shape2);
-  for(size_t i = 0; i < size1; i++){
-    for(size_t j = 0; j < size2; j++){
-      vector_t *p1 = list_get(shape1, i);
-      vector_t *q1 = list_get(shape1, (i + 1) % size1);
-      vector_t *p2 = list_get(shape2, j);
-      vector_t *q2 = list_get(shape2, (j + 1) % size2);
-      if(do_intersect(*p1, *q1, *p2, *q2)){
-        return point_of_intersect(*p1, *q1, *p2, *q2);
-      }
-    }
-  }
-  return(vec_init(0, 0));
-}
-
 //Will return the min of the list or max of the list depending on what
 // type is passed in
 double find_extrema(list_t *numbers, int type){
@@ -160,119 +119,581 @@ double find_extrema(list_t *numbers, int type){
 }
 
 /**
-* finds the projection of each point in the provided shape onto the line given
-* it then adds the magnitude of that projection to the list given
+* Projects every point of a shape onto a line in one pass, giving the extent
+* of the shape along the line scaled by the line's length.
 **/
-void add_mag(vector_t line, list_t *shape, list_t *magnitude){
-  for(int i = 0; i < list_size(shape); i++){
-    vector_t *point = list_get(shape, i);
-    vector_t projection =  vec_projection(*point, line);
-    double *mag = malloc(sizeof(double));
-    *mag = vec_magnitude(projection);
-    //this corrects for projections that are negative
-    if(vec_dot(*point, line) < 0){
-      *mag *= NEGATE;
-    }
-    list_add(magnitude, mag);
+void project_shape(vector_t line, const shape_t *shape, double *min,
+  double *max){
+    *min = vec_dot(shape->points[0], line);
+    *max = *min;
+    for(size_t i = 1; i < shape->size; i++){
+      double dot = vec_dot(shape->points[i], line);
+      if(dot < *min){
+        *min = dot;
+      }
+      else if(dot > *max){
+        *max = dot;
+      }
+    }
+}
+
+double overlap(vector_t line, const shape_t *shape1, const shape_t *shape2){
+  double min1, max1, min2, max2;
+  project_shape(line, shape1, &min1, &max1);
+  project_shape(line, shape2, &min2, &max2);
+
+  double length = vec_magnitude(line);
+  if(min1 <= min2){
+    return (max1 - min2) / length;
   }
+  return (max2 - min1) / length;
 }
 
 /**
-*takes in a list that will contain the perpendicular vectors we are searching
-* for and adds the vectors it gets from the given shape.
+* An edge of a polygon, along with its vertex furthest along some direction.
+**/
+typedef struct {
+  vector_t start;
+  vector_t end;
+  vector_t furthest;
+} feature_edge_t;
+
+/**
+* Finds the edge of a polygon facing a direction most squarely: of the two
+* edges at the vertex furthest along the direction, the more perpendicular one.
 **/
-void perpendicular_lines(list_t *perp_vectors, list_t *shape){
-  size_t size = list_size(shape);
-  for(size_t i = 0; i < size; i++){
-    vector_t *point1 = list_get(shape, i);
-    vector_t *point2 = list_get(shape, (i + 1) % size);
-    vector_t difference = vec_subtract(*point1, *point2);
-    vector_t *to_add = malloc(sizeof(vector_t));
-    *to_add = vec_rotate(difference, NINETY_DEGREES);
-    list_add(perp_vectors, to_add);
+static feature_edge_t best_edge(const shape_t *shape, vector_t direction){
+  size_t size = shape->size;
+  size_t furthest = 0;
+  double furthest_dot = vec_dot(shape->points[0], direction);
+  for(size_t i = 1; i < size; i++){
+    double dot = vec_dot(shape->points[i], direction);
+    if(dot > furthest_dot){
+      furthest = i;
+      furthest_dot = dot;
+    }
+  }
+  vector_t vertex = shape->points[furthest];
+  vector_t previous = shape->points[(furthest + size - 1) % size];
+  vector_t next = shape->points[(furthest + 1) % size];
+  vector_t to_next = vec_unit(vec_subtract(next, vertex));
+  vector_t to_previous = vec_unit(vec_subtract(vertex, previous));
+  feature_edge_t edge = {vertex, next, vertex};
+  if(fabs(vec_dot(to_previous, direction)) < fabs(vec_dot(to_next, direction))){
+    edge.start = previous;
+    edge.end = vertex;
   }
+  return edge;
 }
 
-double overlap(vector_t line, list_t *shape1, list_t *shape2){
-  //lists of doubles that represent the magnitude of the projected vectors
-  list_t *mag1 = list_init(list_size(shape1), (free_func_t) free);
-  list_t *mag2 = list_init(list_size(shape2), (free_func_t) free);
+/**
+* Clips a segment to the points p with vec_dot(direction, p) >= offset.
+* Returns the number of points left, written to clipped.
+**/
+static size_t clip_segment(vector_t start, vector_t end, vector_t direction,
+  double offset, vector_t *clipped){
+    double start_distance = vec_dot(direction, start) - offset;
+    double end_distance = vec_dot(direction, end) - offset;
+    size_t count = 0;
+    if(start_distance >= 0){
+      clipped[count++] = start;
+    }
+    if(end_distance >= 0){
+      clipped[count++] = end;
+    }
+    if(start_distance * end_distance < 0){
+      double fraction = start_distance / (start_distance - end_distance);
+      clipped[count++] = vec_add(start,
+        vec_multiply(fraction, vec_subtract(end, start)));
+    }
+    return count;
+}
 
-  add_mag(line, shape1, mag1);
-  add_mag(line, shape2, mag2);
+void contact_manifold(const shape_t *shape1, const shape_t *shape2,
+  vector_t axis, collision_info_t *information){
+    feature_edge_t edge1 = best_edge(shape1, axis);
+    feature_edge_t edge2 = best_edge(shape2, vec_negate(axis));
+    vector_t direction1 = vec_unit(vec_subtract(edge1.end, edge1.start));
+    vector_t direction2 = vec_unit(vec_subtract(edge2.end, edge2.start));
 
-  double max1 = find_extrema(mag1, TYPE_MAX);
-  double max2 = find_extrema(mag2, TYPE_MAX);
-  double min1 = find_extrema(mag1, TYPE_MIN);
-  double min2 = find_extrema(mag2, TYPE_MIN);
+    // the edge more perpendicular to the axis is the reference edge; the
+    // other one (the incident edge) is clipped to the reference edge's sides
+    feature_edge_t reference = edge1;
+    feature_edge_t incident = edge2;
+    vector_t direction = direction1;
+    vector_t outwards = axis;
+    if(fabs(vec_dot(direction2, axis)) < fabs(vec_dot(direction1, axis))){
+      reference = edge2;
+      incident = edge1;
+      direction = direction2;
+      outwards = vec_negate(axis);
+    }
 
-  list_free(mag1);
-  list_free(mag2);
+    vector_t clipped[2];
+    vector_t twice_clipped[2];
+    size_t count = clip_segment(incident.start, incident.end, direction,
+      vec_dot(direction, reference.start), clipped);
+    if(count == 2){
+      count = clip_segment(clipped[0], clipped[1], vec_negate(direction),
+        -vec_dot(direction, reference.end), twice_clipped);
+    }
+    else{
+      count = 0;
+    }
 
-  if(min1 <= min2){
-    return(max1 - min2);
-  }
-  return(max2 - min1);
+    // keep the points that are inside the reference polygon
+    vector_t normal = vec_init(-direction.y, direction.x);
+    if(vec_dot(normal, outwards) < 0){
+      normal = vec_negate(normal);
+    }
+    double face = vec_dot(normal, reference.furthest);
+    information->contact_count = 0;
+    for(size_t i = 0; i < count; i++){
+      if(vec_dot(normal, twice_clipped[i]) <= face){
+        information->contacts[information->contact_count++] =
+          twice_clipped[i];
+      }
+    }
+    if(information->contact_count == 0){
+      // rounding left nothing; the incident vertex is the best guess
+      information->contacts[information->contact_count++] = incident.furthest;
+    }
 }
 
-collision_info_t find_collision(body_t *body1, body_t *body2){
-  list_t *shape1 = body_get_shape(body1);
-  list_t *shape2 = body_get_shape(body2);
-  collision_info_t information = {
-    .collided = false,
-    .axis = {-1, -1},
-  };
-  int size_of_perp = list_size(shape1) + list_size(shape2);
-    //create a list of vectors that are the perpendicular lines and add to it
-  list_t *perp_vectors = list_init(size_of_perp, (free_func_t) vec_free);
-  perpendicular_lines(perp_vectors, shape1);
-  perpendicular_lines(perp_vectors, shape2);
-  vector_t overlap_vec = vec_init(0, 0);
-  double least_overlap = LARGE_NUMBER;
-  for(int i = 0; i < list_size(perp_vectors); i++){
-    //if they do not overlap, return false because they are not colliding
-    vector_t *line = list_get(perp_vectors, i);
-    double temp_overlap = overlap(*line, shape1, shape2);
-    if(temp_overlap < 0){
-      list_free(perp_vectors);
-
-      bool collided_last_tick = false;
-      int index1 = -1;
-      int index2 = -1;
-      list_t *one_collidedWith = body_get_collision_bodies(body1);
-      list_t *two_collidedWith = body_get_collision_bodies(body2);
-      for (size_t i = 0; i < list_size(one_collidedWith); i++) {
-        body_t *collided = (body_t *)list_get(one_collidedWith, i);
-        if (collided == body2) {
-            collided_last_tick = true;
-            index1 = i;
-            break;
+/**
+* Gets the normal of the edge from a shape's i-th vertex to the next one:
+* the edge turned a right angle, which needs no trigonometry.
+**/
+static vector_t edge_normal(const shape_t *shape, size_t i){
+  vector_t difference = vec_subtract(shape->points[i],
+    shape->points[(i + 1) % shape->size]);
+  return vec_init(-difference.y, difference.x);
+}
+
+/**
+* Tests the edge normals of one shape as separating axes, keeping the one
+* with the least overlap. Returns false as soon as an axis separates them,
+* setting separating to the index of its edge.
+**/
+static bool least_overlap_axis(const shape_t *edges, const shape_t *shape1,
+  const shape_t *shape2, double *least_overlap, vector_t *axis,
+  size_t *separating){
+    for(size_t i = 0; i < edges->size; i++){
+      vector_t line = edge_normal(edges, i);
+      double temp_overlap = overlap(line, shape1, shape2);
+      if(temp_overlap < 0){
+        *separating = i;
+        return false;
+      }
+      if(temp_overlap < *least_overlap){
+        *axis = line;
+        *least_overlap = temp_overlap;
+      }
+    }
+    return true;
+}
+
+/**
+* Runs the full separating axis test. If the shapes are separated, sets
+* first_separates to whether an edge of shape1 separated them and edge to
+* that edge.
+**/
+static collision_info_t sat_shapes(const shape_t *shape1,
+  const shape_t *shape2, bool *first_separates, size_t *edge){
+    collision_info_t information = {
+      .collided = false,
+      .axis = {-1, -1},
+      .depth = 0,
+      .contact_count = 0,
+    };
+    vector_t overlap_vec = vec_init(0, 0);
+    double least_overlap = LARGE_NUMBER;
+    //if any edge normal separates the shapes, they are not colliding
+    if(!least_overlap_axis(shape1, shape1, shape2, &least_overlap,
+      &overlap_vec, edge)){
+        *first_separates = true;
+        return information;
+    }
+    if(!least_overlap_axis(shape2, shape1, shape2, &least_overlap,
+      &overlap_vec, edge)){
+        *first_separates = false;
+        return information;
+    }
+    information.collided = true;
+    information.axis = vec_unit(overlap_vec);
+    information.depth = least_overlap;
+
+    // the edge normal may point either way; turn it from shape1 to shape2
+    double min1, max1, min2, max2;
+    project_shape(information.axis, shape1, &min1, &max1);
+    project_shape(information.axis, shape2, &min2, &max2);
+    if(min1 > min2){
+      information.axis = vec_negate(information.axis);
+    }
+    contact_manifold(shape1, shape2, information.axis, &information);
+    return information;
+}
+
+/**
+* Runs the separating axis test on two bodies' shapes. If they are separated,
+* sets separator to the body whose edge separated them and edge to that edge.
+**/
+static collision_info_t sat_collision(body_t *body1, body_t *body2,
+  body_t **separator, size_t *edge){
+    bool first_separates = false;
+    collision_info_t information = sat_shapes(body_get_shape_view(body1),
+      body_get_shape_view(body2), &first_separates, edge);
+    *separator = first_separates ? body1 : body2;
+    return information;
+}
+
+static collision_info_t sat_pieces(const shape_t *shape1, double radius1,
+  const shape_t *shape2, double radius2){
+    (void) radius1;
+    (void) radius2;
+    bool first_separates;
+    size_t edge;
+    return sat_shapes(shape1, shape2, &first_separates, &edge);
+}
+
+static bool has_pieces(body_t *body1, body_t *body2){
+  return body_get_piece_count(body1) > 1 || body_get_piece_count(body2) > 1;
+}
+
+collision_info_t find_piece_collision(body_t *body1, body_t *body2,
+  piece_test_t test){
+    collision_info_t deepest = {
+      .collided = false,
+      .axis = {-1, -1},
+      .depth = 0,
+      .contact_count = 0,
+    };
+    double radius1 = body_get_radius(body1);
+    double radius2 = body_get_radius(body2);
+    for(size_t i = 0; i < body_get_piece_count(body1); i++){
+      aabb_t box1 = body_get_piece_aabb(body1, i);
+      for(size_t j = 0; j < body_get_piece_count(body2); j++){
+        if(!aabb_overlap(box1, body_get_piece_aabb(body2, j))){
+          continue;
+        }
+        collision_info_t information = test(body_get_piece_view(body1, i),
+          radius1, body_get_piece_view(body2, j), radius2);
+        if(information.collided
+          && (!deepest.collided || information.depth > deepest.depth)){
+            deepest = information;
+        }
+      }
+    }
+    return deepest;
+}
+
+/**
+* Finds the closest points c1 on segment p1q1 and c2 on segment p2q2, either
+* of which may be a single point. Returns the squared distance between them.
+**/
+double closest_segment_points(vector_t p1, vector_t q1, vector_t p2,
+  vector_t q2, vector_t *c1, vector_t *c2){
+    vector_t d1 = vec_subtract(q1, p1);
+    vector_t d2 = vec_subtract(q2, p2);
+    vector_t r = vec_subtract(p1, p2);
+    double a = vec_dot(d1, d1);
+    double e = vec_dot(d2, d2);
+    double f = vec_dot(d2, r);
+    double s = 0;
+    double t = 0;
+    if(a == 0 && e > 0){
+      t = clamp_unit(f / e);
+    }
+    else if(a > 0){
+      double c = vec_dot(d1, r);
+      if(e == 0){
+        s = clamp_unit(-c / a);
+      }
+      else{
+        double b = vec_dot(d1, d2);
+        double denominator = a * e - b * b;
+        // parallel segments have no unique closest pair, so start from p1
+        if(denominator != 0){
+          s = clamp_unit((b * f - c * e) / denominator);
+        }
+        t = (b * s + f) / e;
+        if(t < 0){
+          t = 0;
+          s = clamp_unit(-c / a);
         }
+        else if(t > 1){
+          t = 1;
+          s = clamp_unit((b - c) / a);
+        }
+      }
+    }
+    *c1 = vec_add(p1, vec_multiply(s, d1));
+    *c2 = vec_add(p2, vec_multiply(t, d2));
+    vector_t difference = vec_subtract(*c2, *c1);
+    return vec_dot(difference, difference);
+}
+
+/**
+* Returns whether a point is inside (or on) a convex polygon, whichever way
+* its vertices wind.
+**/
+static bool convex_contains(const shape_t *shape, vector_t point){
+  bool has_left = false;
+  bool has_right = false;
+  for(size_t i = 0; i < shape->size; i++){
+    vector_t start = shape->points[i];
+    vector_t edge = vec_subtract(shape->points[(i + 1) % shape->size], start);
+    double side = vec_cross(edge, vec_subtract(point, start));
+    has_left = has_left || side > 0;
+    has_right = has_right || side < 0;
+  }
+  return !(has_left && has_right);
+}
+
+/**
+* Finds the closest points c1 on core1 and c2 on core2, at most one of which
+* is a polygon while the others are segments or points. Returns the squared
+* distance between them.
+**/
+static double closest_core_points(const shape_t *core1, const shape_t *core2,
+  vector_t *c1, vector_t *c2){
+    if(core2->size > 2){
+      return closest_core_points(core2, core1, c2, c1);
+    }
+    vector_t start = core2->points[0];
+    vector_t end = core2->points[core2->size - 1];
+    if(core1->size <= 2){
+      return closest_segment_points(core1->points[0],
+        core1->points[core1->size - 1], start, end, c1, c2);
+    }
+    double least_distance = INFINITY;
+    for(size_t i = 0; i < core1->size; i++){
+      vector_t on1, on2;
+      double distance = closest_segment_points(core1->points[i],
+        core1->points[(i + 1) % core1->size], start, end, &on1, &on2);
+      if(distance < least_distance){
+        least_distance = distance;
+        *c1 = on1;
+        *c2 = on2;
       }
-      for (size_t i = 0; i < list_size(two_collidedWith); i++) {
-        body_t *collided = (body_t *)list_get(two_collidedWith, i);
-        if (collided == body1) {
-            collided_last_tick = true;
-            index2 = i;
-            break;
+    }
+    return least_distance;
+}
+
+/**
+* Returns whether two cores, at most one of which is a polygon, overlap.
+* Uses exact orientation tests, since closest points found for crossing
+* segments are only approximately apart by 0.
+**/
+static bool cores_overlap(const shape_t *core1, const shape_t *core2){
+  if(core2->size > 2){
+    return cores_overlap(core2, core1);
+  }
+  vector_t start = core2->points[0];
+  vector_t end = core2->points[core2->size - 1];
+  if(core1->size <= 2){
+    return do_intersect(core1->points[0], core1->points[core1->size - 1],
+      start, end);
+  }
+  if(convex_contains(core1, start)){
+    return true;
+  }
+  for(size_t i = 0; i < core1->size; i++){
+    if(do_intersect(core1->points[i], core1->points[(i + 1) % core1->size],
+      start, end)){
+        return true;
+    }
+  }
+  return false;
+}
+
+/**
+* Tests one axis of rounded_sat(), keeping it if the cores overlap least
+* along it. The axis is flipped to point from core1 towards core2.
+**/
+static void rounded_sat_axis(vector_t normal, const shape_t *core1,
+  double radius1, const shape_t *core2, double radius2,
+  collision_info_t *information){
+    double min1, max1, min2, max2;
+    project_shape(normal, core1, &min1, &max1);
+    project_shape(normal, core2, &min2, &max2);
+    double forwards = max1 + radius1 - (min2 - radius2);
+    double backwards = max2 + radius2 - (min1 - radius1);
+    if(forwards < information->depth){
+      information->depth = forwards;
+      information->axis = normal;
+    }
+    if(backwards < information->depth){
+      information->depth = backwards;
+      information->axis = vec_negate(normal);
+    }
+}
+
+/**
+* Finds the vertex of a core furthest along a direction.
+**/
+static vector_t core_support(const shape_t *core, vector_t direction){
+  vector_t best = core->points[0];
+  for(size_t i = 1; i < core->size; i++){
+    if(vec_dot(core->points[i], direction) > vec_dot(best, direction)){
+      best = core->points[i];
+    }
+  }
+  return best;
+}
+
+/**
+* Finds the axis of least overlap between two overlapping rounded cores.
+* Besides the cores' edge normals, the rounded corners of their Minkowski
+* difference make every direction between two core vertices a candidate.
+**/
+static collision_info_t rounded_sat(const shape_t *core1, double radius1,
+  const shape_t *core2, double radius2){
+    collision_info_t information = {
+      .collided = true,
+      .axis = {0, 1},
+      .depth = INFINITY,
+      .contact_count = 0,
+    };
+    const shape_t *cores[] = {core1, core2};
+    for(size_t c = 0; c < 2; c++){
+      const shape_t *core = cores[c];
+      // a segment has one edge, a point none
+      size_t edges = core->size > 2 ? core->size : core->size - 1;
+      for(size_t i = 0; i < edges; i++){
+        vector_t edge = vec_subtract(core->points[(i + 1) % core->size],
+          core->points[i]);
+        if(edge.x != 0 || edge.y != 0){
+          rounded_sat_axis(vec_unit(vec_init(-edge.y, edge.x)), core1,
+            radius1, core2, radius2, &information);
         }
       }
-      if(collided_last_tick){
-        body_remove_collision_body(body1, index1);
-        body_remove_collision_body(body2, index2);
-        body_collided(body1, false);
-        body_collided(body2, false);
+    }
+    for(size_t i = 0; i < core1->size; i++){
+      for(size_t j = 0; j < core2->size; j++){
+        vector_t between = vec_subtract(core2->points[j], core1->points[i]);
+        if(between.x != 0 || between.y != 0){
+          rounded_sat_axis(vec_unit(between), core1, radius1, core2, radius2,
+            &information);
+        }
       }
-      return information;
     }
-    else if(temp_overlap < least_overlap){
-      overlap_vec = *line;
-      least_overlap = temp_overlap;
+    // the contact is halfway between the deepest points of the two bodies
+    vector_t deepest1 = vec_add(core_support(core1, information.axis),
+      vec_multiply(radius1, information.axis));
+    vector_t deepest2 = vec_subtract(
+      core_support(core2, vec_negate(information.axis)),
+      vec_multiply(radius2, information.axis));
+    information.contact_count = 1;
+    information.contacts[0] = vec_multiply(0.5, vec_add(deepest1, deepest2));
+    return information;
+}
+
+/**
+* Tests convex cores grown by their radii (0 for polygons). While the cores
+* are apart, the closest points between them decide the collision in closed
+* form; once they overlap, rounded_sat() finds the way out.
+**/
+static collision_info_t round_collision(const shape_t *core1,
+  double radius1, const shape_t *core2, double radius2){
+    if(cores_overlap(core1, core2)){
+      return rounded_sat(core1, radius1, core2, radius2);
+    }
+    vector_t c1, c2;
+    double distance_squared = closest_core_points(core1, core2, &c1, &c2);
+    if(distance_squared == 0){
+      return rounded_sat(core1, radius1, core2, radius2);
+    }
+
+    collision_info_t information = {
+      .collided = false,
+      .axis = {-1, -1},
+      .depth = 0,
+      .contact_count = 0,
+    };
+    double radius = radius1 + radius2;
+    if(distance_squared > radius * radius){
+      return information;
     }
+    double distance = sqrt(distance_squared);
+    information.collided = true;
+    information.axis = vec_multiply(1 / distance, vec_subtract(c2, c1));
+    information.depth = radius - distance;
+    information.contact_count = 1;
+    information.contacts[0] = vec_multiply(0.5, vec_add(
+      vec_add(c1, vec_multiply(radius1, information.axis)),
+      vec_subtract(c2, vec_multiply(radius2, information.axis))));
+    return information;
+}
+
+collision_info_t find_round_collision(body_t *body1, body_t *body2){
+  double radius1 = body_get_radius(body1);
+  double radius2 = body_get_radius(body2);
+  assert(radius1 > 0 || radius2 > 0);
+  if(has_pieces(body1, body2)){
+    return find_piece_collision(body1, body2, round_collision);
+  }
+  return round_collision(body_get_shape_view(body1), radius1,
+    body_get_shape_view(body2), radius2);
+}
+
+collision_info_t find_collision(body_t *body1, body_t *body2){
+  if(body_get_radius(body1) > 0 || body_get_radius(body2) > 0){
+    return find_round_collision(body1, body2);
+  }
+  if(has_pieces(body1, body2)){
+    return find_piece_collision(body1, body2, sat_pieces);
   }
-  vector_t overlap_axis = vec_unit(overlap_vec);
-  information.collided = true;
-  information.axis = overlap_axis;
-  list_free(perp_vectors);
-  return information;
+  body_t *separator;
+  size_t edge;
+  return sat_collision(body1, body2, &separator, &edge);
+}
+
+/**
+* Tests the axis that last separated the bodies before running the full test,
+* and remembers the new separating axis afterwards.
+**/
+collision_info_t find_collision_cached(contact_cache_t *cache, body_t *body1,
+  body_t *body2){
+    // closed-form tests are already cheaper than looking up a hint
+    if(body_get_radius(body1) > 0 || body_get_radius(body2) > 0){
+      return find_round_collision(body1, body2);
+    }
+    // the hint names an edge of a whole shape, which pieces do not share
+    if(has_pieces(body1, body2)){
+      return find_piece_collision(body1, body2, sat_pieces);
+    }
+    separating_axis_t *hint = contact_cache_separating_axis(cache, body1,
+      body2);
+    if(hint->valid){
+      body_t *owner = hint->body_id == body_get_id(body1) ? body1 : body2;
+      const shape_t *edges = body_get_shape_view(owner);
+      // the body's shape may have been replaced since
+      if(hint->edge < edges->size){
+        vector_t line = edge_normal(edges, hint->edge);
+        if(overlap(line, body_get_shape_view(body1),
+          body_get_shape_view(body2)) < 0){
+            contact_cache_count_axis(cache, true);
+            collision_info_t information = {
+              .collided = false,
+              .axis = {-1, -1},
+              .depth = 0,
+              .contact_count = 0,
+            };
+            return information;
+        }
+      }
+    }
+    contact_cache_count_axis(cache, false);
+
+    body_t *separator;
+    size_t edge;
+    collision_info_t information = sat_collision(body1, body2, &separator,
+      &edge);
+    hint->valid = !information.collided;
+    if(hint->valid){
+      hint->body_id = body_get_id(separator);
+      hint->edge = edge;
+    }
+    return information;
 }
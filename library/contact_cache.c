@@ -0,0 +1,310 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "contact_cache.h"
+#include "pair_map.h"
+
+const size_t CONTACT_INIT_SIZE = 16;
+// separating axes not looked up for this many ticks are dropped
+const size_t AXIS_MAX_AGE = 32;
+
+typedef struct {
+  separating_axis_t axis;
+  // the tick in which the axis was last looked up
+  size_t last_tick;
+} axis_entry_t;
+
+// where a pair's key is stored in each of its bodies' key lists
+typedef struct {
+  size_t ids[2];
+  size_t slots[2];
+} pair_links_t;
+
+typedef struct {
+  uint64_t *keys;
+  size_t size;
+  size_t capacity;
+} key_list_t;
+
+typedef struct contact_cache {
+  // pair_key of the body ids -> contact_t
+  pair_map_t *contacts;
+  // pair_key of the body ids -> axis_entry_t
+  pair_map_t *axes;
+  // pair_key of the body ids -> pair_links_t, for every pair in either map
+  pair_map_t *pairs;
+  // body id -> key_list_t of the pairs it is in
+  pair_map_t *bodies;
+  size_t axis_hits;
+  size_t axis_misses;
+  size_t tick;
+  // keys waiting to be removed, so the map is not changed mid-iteration
+  uint64_t *doomed;
+  size_t doomed_capacity;
+} contact_cache_t;
+
+contact_cache_t *contact_cache_init(void) {
+  contact_cache_t *cache = malloc(sizeof(contact_cache_t));
+  assert(cache != NULL);
+  cache->contacts = pair_map_init(CONTACT_INIT_SIZE, sizeof(contact_t));
+  cache->axes = pair_map_init(CONTACT_INIT_SIZE, sizeof(axis_entry_t));
+  cache->pairs = pair_map_init(CONTACT_INIT_SIZE, sizeof(pair_links_t));
+  cache->bodies = pair_map_init(CONTACT_INIT_SIZE, sizeof(key_list_t));
+  cache->axis_hits = 0;
+  cache->axis_misses = 0;
+  cache->tick = 0;
+  cache->doomed_capacity = CONTACT_INIT_SIZE;
+  cache->doomed = malloc(cache->doomed_capacity * sizeof(uint64_t));
+  assert(cache->doomed != NULL);
+  return cache;
+}
+
+static void contact_cache_free_key_lists(contact_cache_t *cache) {
+  for (size_t i = 0; i < pair_map_capacity(cache->bodies); i++) {
+    void *value;
+    if (pair_map_slot(cache->bodies, i, NULL, &value)) {
+      free(((key_list_t *) value)->keys);
+    }
+  }
+}
+
+void contact_cache_free(contact_cache_t *cache) {
+  contact_cache_free_key_lists(cache);
+  pair_map_free(cache->contacts);
+  pair_map_free(cache->axes);
+  pair_map_free(cache->pairs);
+  pair_map_free(cache->bodies);
+  free(cache->doomed);
+  free(cache);
+}
+
+size_t contact_cache_size(contact_cache_t *cache) {
+  return pair_map_size(cache->contacts);
+}
+
+size_t contact_cache_get_tick(contact_cache_t *cache) {
+  return cache->tick;
+}
+
+static uint64_t contact_key(body_t *body1, body_t *body2) {
+  return pair_key(body_get_id(body1), body_get_id(body2));
+}
+
+/**
+Adds a pair's key to both of its bodies' key lists, unless it is there already.
+*/
+static void contact_cache_index_pair(contact_cache_t *cache, uint64_t key,
+  body_t *body1, body_t *body2) {
+    if (pair_map_contains(cache->pairs, key)) {
+      return;
+    }
+    pair_links_t *links = pair_map_put(cache->pairs, key);
+    links->ids[0] = body_get_id(body1);
+    links->ids[1] = body_get_id(body2);
+    for (size_t side = 0; side < 2; side++) {
+      key_list_t *list = pair_map_put(cache->bodies, links->ids[side]);
+      if (list->size == list->capacity) {
+        list->capacity = list->capacity == 0 ? 4 : list->capacity * 2;
+        list->keys = realloc(list->keys, list->capacity * sizeof(uint64_t));
+        assert(list->keys != NULL);
+      }
+      links->slots[side] = list->size;
+      list->keys[list->size++] = key;
+    }
+}
+
+/**
+Removes a pair's key from its bodies' key lists, moving each list's last key
+into the hole. Called once the pair is in neither the contacts nor the axes.
+*/
+static void contact_cache_unindex_pair(contact_cache_t *cache, uint64_t key) {
+  pair_links_t *links = pair_map_get(cache->pairs, key);
+  if (links == NULL) {
+    return;
+  }
+  for (size_t side = 0; side < 2; side++) {
+    size_t id = links->ids[side];
+    key_list_t *list = pair_map_get(cache->bodies, id);
+    uint64_t moved = list->keys[--list->size];
+    if (moved != key) {
+      size_t slot = links->slots[side];
+      list->keys[slot] = moved;
+      pair_links_t *moved_links = pair_map_get(cache->pairs, moved);
+      moved_links->slots[moved_links->ids[0] == id ? 0 : 1] = slot;
+    }
+    if (list->size == 0) {
+      free(list->keys);
+      pair_map_remove(cache->bodies, id);
+    }
+  }
+  pair_map_remove(cache->pairs, key);
+}
+
+contact_t *contact_cache_get(contact_cache_t *cache, body_t *body1,
+  body_t *body2) {
+    return pair_map_get(cache->contacts, contact_key(body1, body2));
+}
+
+/**
+Records a touching pair, starting a new contact if it was not touching.
+*/
+contact_t *contact_cache_touch(contact_cache_t *cache, body_t *body1,
+  body_t *body2, vector_t axis) {
+    contact_t *contact = pair_map_get(cache->contacts,
+      contact_key(body1, body2));
+    if (contact == NULL || contact->state == CONTACT_ENDED) {
+      uint64_t key = contact_key(body1, body2);
+      contact = pair_map_put(cache->contacts, key);
+      contact_cache_index_pair(cache, key, body1, body2);
+      contact->body1 = body1;
+      contact->body2 = body2;
+      contact->state = CONTACT_NEW;
+      contact->impulse = VEC_ZERO;
+      contact->resolved = false;
+      contact->point_count = 0;
+    }
+    else if (contact->last_tick != cache->tick) {
+      contact->state = CONTACT_PERSISTING;
+    }
+    contact->axis = contact->body1 == body1 ? axis : vec_negate(axis);
+    contact->last_tick = cache->tick;
+    return contact;
+}
+
+void contact_cache_separate(contact_cache_t *cache, body_t *body1,
+  body_t *body2) {
+    contact_t *contact = contact_cache_get(cache, body1, body2);
+    if (contact != NULL) {
+      contact->state = CONTACT_ENDED;
+    }
+}
+
+static void contact_cache_doom(contact_cache_t *cache, size_t *count,
+  uint64_t key) {
+    if (*count == cache->doomed_capacity) {
+      cache->doomed_capacity *= 2;
+      cache->doomed = realloc(cache->doomed,
+        cache->doomed_capacity * sizeof(uint64_t));
+      assert(cache->doomed != NULL);
+    }
+    cache->doomed[(*count)++] = key;
+}
+
+/**
+Removes the doomed keys from one map, and unindexes the pairs that are now in
+neither map.
+*/
+static void contact_cache_remove_doomed(contact_cache_t *cache,
+  pair_map_t *map, pair_map_t *other, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+      uint64_t key = cache->doomed[i];
+      pair_map_remove(map, key);
+      if (!pair_map_contains(other, key)) {
+        contact_cache_unindex_pair(cache, key);
+      }
+    }
+}
+
+/**
+Drops the separating axes that were not looked up since the last time this
+ran, so pairs that stopped being tested do not keep theirs forever.
+*/
+static void contact_cache_age_axes(contact_cache_t *cache) {
+  size_t count = 0;
+  for (size_t i = 0; i < pair_map_capacity(cache->axes); i++) {
+    uint64_t key;
+    void *value;
+    if (pair_map_slot(cache->axes, i, &key, &value)
+      && ((axis_entry_t *) value)->last_tick + AXIS_MAX_AGE <= cache->tick) {
+        contact_cache_doom(cache, &count, key);
+    }
+  }
+  contact_cache_remove_doomed(cache, cache->axes, cache->contacts, count);
+}
+
+/**
+Drops ended contacts and ends the ones nobody saw touching last tick.
+Every AXIS_MAX_AGE ticks, also drops the axes nobody looked up since.
+*/
+void contact_cache_tick(contact_cache_t *cache) {
+  size_t count = 0;
+  for (size_t i = 0; i < pair_map_capacity(cache->contacts); i++) {
+    uint64_t key;
+    void *value;
+    if (!pair_map_slot(cache->contacts, i, &key, &value)) {
+      continue;
+    }
+    contact_t *contact = value;
+    if (contact->state == CONTACT_ENDED) {
+      contact_cache_doom(cache, &count, key);
+    }
+    else if (contact->last_tick != cache->tick) {
+      contact->state = CONTACT_ENDED;
+    }
+  }
+  contact_cache_remove_doomed(cache, cache->contacts, cache->axes, count);
+  cache->tick++;
+  if (cache->tick % AXIS_MAX_AGE == 0) {
+    contact_cache_age_axes(cache);
+  }
+}
+
+/**
+Drops the pairs in the body's key list, which unindexing shrinks from the end.
+*/
+void contact_cache_remove_body(contact_cache_t *cache, body_t *body) {
+  size_t id = body_get_id(body);
+  key_list_t *list;
+  while ((list = pair_map_get(cache->bodies, id)) != NULL) {
+    uint64_t key = list->keys[list->size - 1];
+    pair_map_remove(cache->contacts, key);
+    pair_map_remove(cache->axes, key);
+    contact_cache_unindex_pair(cache, key);
+  }
+}
+
+separating_axis_t *contact_cache_separating_axis(contact_cache_t *cache,
+  body_t *body1, body_t *body2) {
+    uint64_t key = contact_key(body1, body2);
+    axis_entry_t *entry = pair_map_put(cache->axes, key);
+    contact_cache_index_pair(cache, key, body1, body2);
+    entry->last_tick = cache->tick;
+    return &entry->axis;
+}
+
+void contact_cache_count_axis(contact_cache_t *cache, bool hit) {
+  if (hit) {
+    cache->axis_hits++;
+  }
+  else {
+    cache->axis_misses++;
+  }
+}
+
+size_t contact_cache_axis_hits(contact_cache_t *cache) {
+  return cache->axis_hits;
+}
+
+size_t contact_cache_axis_misses(contact_cache_t *cache) {
+  return cache->axis_misses;
+}
+
+void contact_cache_clear(contact_cache_t *cache) {
+  contact_cache_free_key_lists(cache);
+  pair_map_clear(cache->contacts);
+  pair_map_clear(cache->axes);
+  pair_map_clear(cache->pairs);
+  pair_map_clear(cache->bodies);
+}
+
+size_t contact_cache_capacity(contact_cache_t *cache) {
+  return pair_map_capacity(cache->contacts);
+}
+
+contact_t *contact_cache_slot(contact_cache_t *cache, size_t index) {
+  void *value;
+  if (!pair_map_slot(cache->contacts, index, NULL, &value)) {
+    return NULL;
+  }
+  return value;
+}
@@ -7,15 +7,17 @@
 #include "body.h"
 #include "scene.h"
 #include "collision.h"
+#include "barnes_hut.h"
 
 const double ELASTICITY_TERM = 1.0;
-const double FALSE_CONSTANT = -1.0;
 
 typedef struct auxillary {
   double constant;
   list_t *bodies;
   collision_handler_t collision;
   void *aux;
+  scene_t *scene;
+  uint32_t mask;
 } auxillary_t;
 
 /**
@@ -28,6 +30,8 @@ auxillary_t *aux_init(double constant) {
   new_aux->bodies = list_init(2, (free_func_t) body_free);
   new_aux->constant = constant;
   new_aux->collision = NULL;
+  new_aux->scene = NULL;
+  new_aux->mask = 0;
   return new_aux;
 }
 
@@ -103,11 +107,11 @@ void aux_free(auxillary_t *aux) {
 
 //Returns a list of all the y coordinates of a body's shape
 list_t *y_vals(body_t *body){
-  list_t *shape = body_get_shape(body);
-  list_t *values = list_init(5, NULL);
-  for(size_t i = 0; i < list_size(shape); i++){
+  const shape_t *shape = body_get_shape_view(body);
+  list_t *values = list_init(shape->size, free);
+  for(size_t i = 0; i < shape->size; i++){
     double *y = malloc(sizeof(double));
-    *y = (*(vector_t*) list_get(shape, i)).y;
+    *y = shape->points[i].y;
     list_add(values, y);
   }
   return values;
@@ -167,19 +171,22 @@ void calc_gravity_force(void *aux) {
   body_t *body1 = aux_get_body(aux, 0);
   body_t *body2 = aux_get_body(aux, 1);
 
-  vector_t body_tip1 = *(vector_t *) list_get(body_get_shape(body1), 0);
-  vector_t body_tip2 = *(vector_t *) list_get(body_get_shape(body2), 0);
-
-  vector_t radius1 = vec_subtract(body_get_centroid(body1), body_tip1);
-  vector_t radius2 = vec_subtract(body_get_centroid(body2), body_tip2);
-
-  double touching = vec_magnitude(radius1) + vec_magnitude(radius2);
+  double touching = body_get_reach(body1) + body_get_reach(body2);
 
     if(vec_magnitude(diff_centroids(body1, body2)) >= touching){
         grav_calc_helper(aux_get_constant(aux), body1, body2);
     }
 }
 
+/**
+ * Creates one force creator that applies gravity between every pair of bodies
+ * in a scene, approximated with a Barnes-Hut quadtree.
+ */
+void create_barnes_hut_gravity(scene_t *scene, double G, double theta) {
+  scene_add_force_creator(scene, (force_creator_t) barnes_hut_apply,
+    barnes_hut_init(scene, G, theta), (free_func_t) barnes_hut_free);
+}
+
 /**
  * Creates a gravitational force creator on a body that simulates Earth gravity.
  */
@@ -203,9 +210,13 @@ void calc_earth_force(void *aux) {
     body_t *body1 = aux_get_body(aux, 0);
     body_t *body2 = aux_get_body(aux, 1);
       //here, the body is the shape. will find min
-    double min = find_extrema(y_vals(body1), 1);
+    list_t *body_ys = y_vals(body1);
+    double min = find_extrema(body_ys, 1);
+    list_free(body_ys);
     // here, the body is the floor. will find max
-    double max = find_extrema(y_vals(body2), 2);
+    list_t *floor_ys = y_vals(body2);
+    double max = find_extrema(floor_ys, 2);
+    list_free(floor_ys);
     if(min > max){
       grav_calc_helper(aux_get_constant(aux), body1, body2);
     }
@@ -216,6 +227,36 @@ void calc_earth_force(void *aux) {
     }
 }
 
+/**
+ * Creates a force creator that pulls every body in the mask's categories
+ * downwards.
+ */
+void create_uniform_gravity(scene_t *scene, double g, uint32_t mask) {
+  auxillary_t *aux = aux_init(g);
+  aux->scene = scene;
+  aux->mask = mask;
+  scene_add_force_creator(scene, (force_creator_t) calc_uniform_gravity, aux,
+    (free_func_t) aux_free);
+}
+
+/**
+ * Applies m * g downwards to each body. Helper function to
+ * create_uniform_gravity.
+ */
+void calc_uniform_gravity(void *aux) {
+  auxillary_t *gravity = aux;
+  scene_t *scene = gravity->scene;
+  for (size_t i = 0; i < scene_bodies(scene); i++) {
+    body_t *body = scene_get_body(scene, i);
+    double mass = body_get_mass(body);
+    if ((body_get_category(body) & gravity->mask) == 0 || mass == INFINITY
+      || body_is_sleeping(body) || body_is_removed(body)) {
+        continue;
+    }
+    body_add_force(body, vec_init(0, -mass * gravity->constant));
+  }
+}
+
 /**
  * Creates a spring force creator on a body.
  */
@@ -269,18 +310,21 @@ void create_drag(scene_t *scene, double gamma, body_t *body) {
 void calc_drag_force(void *aux) {
   double gamma = aux_get_constant(aux);
   body_t *body = aux_get_body(aux, 0);
+  if (body_is_sleeping(body)) {
+    return;
+  }
   vector_t velo = body_get_velocity(body);
   vector_t drag = vec_multiply(-1.0 * gamma, velo);
   body_add_force_imp_pos(body, drag, body_get_centroid(body));
 }
 
 /**
- * Adds a force creator to a scene that calls a given collision handler
- * function each time two bodies collide.
+ * Makes a scene call a given collision handler function each time two bodies
+ * collide.
  * This generalizes create_destructive_collision() from last week,
  * allowing different things to happen on a collision.
  * The handler is passed the bodies, the collision axis, and an auxiliary value.
- * It should only be called once while the bodies are still colliding.
+ * The scene's collision system dispatches it, so no force creator is added.
  */
 void create_collision(
     scene_t *scene,
@@ -291,35 +335,8 @@ void create_collision(
     free_func_t freer
 )
   {
-    auxillary_t *new_aux = aux_init(FALSE_CONSTANT);
-    aux_add_body(new_aux, body1);
-    aux_add_body(new_aux, body2);
-    list_t *bodies = list_init(1, (free_func_t) body_free);
-    list_add(bodies, body1);
-    list_add(bodies, body2);
-    aux_set_collision(new_aux, handler);
-    aux_set_aux(new_aux, aux);
-
-    scene_add_bodies_force_creator(scene, (force_creator_t) calc_collison,
-    new_aux, bodies, freer);
-  }
-
-  /**
-   * Calculates the collision using the force handler
-   * Allows us to have the abstraction for the collisions using the
-   * collision_handler_t and its parameters. Calls methods that will add
-   * the forces to the body.
-   */
-void calc_collison(void *aux) {
-  body_t *body1 = aux_get_body(aux, 0);
-  body_t *body2 = aux_get_body(aux, 1);
-  collision_info_t info = find_collision(body1, body2);
-  void *other_aux = aux_get_aux(aux);
-  if (get_if_collided(info)) {
-    vector_t axis = get_collision_axis(info);
-    (aux_get_collision(aux))(body1, body2, axis, other_aux);
+    scene_register_collision(scene, body1, body2, handler, aux, freer);
   }
-}
 
 /**
  * Adds a force creator to a scene that destroys two bodies when they collide.
@@ -354,16 +371,31 @@ void create_physics_collision(
     body_t *body1,
     body_t *body2
 ){
+    // the handler is passed the bodies, so its aux holds none and freeing it
+    // (for a duplicate registration) leaves them alone
     auxillary_t *new_aux = aux_init(elasticity);
-    aux_add_body(new_aux, body1);
-    aux_add_body(new_aux, body2);
-    list_t *bodies = list_init(1, (free_func_t) body_free);
-    list_add(bodies, body1);
-    list_add(bodies, body2);
+    new_aux->scene = scene;
 
-    create_collision(scene, body1, body2, calc_physics_collision, new_aux, NULL);
+    create_collision(scene, body1, body2, calc_physics_collision, new_aux,
+      (free_func_t) aux_free);
   }
 
+/**
+ * Adds a collision rule to a scene that applies impulses to resolve
+ * collisions between any bodies in two categories.
+ */
+void create_physics_collision_rule(
+    scene_t *scene,
+    double elasticity,
+    uint32_t category1,
+    uint32_t category2
+){
+    auxillary_t *new_aux = aux_init(elasticity);
+    new_aux->scene = scene;
+    scene_add_collision_rule(scene, category1, category2,
+      calc_physics_collision, new_aux, (free_func_t) aux_free);
+}
+
   /**
    * Calculates the impulses associated with a given collision
    * Uses the aux to get the bodies and constants needed
@@ -371,38 +403,37 @@ void create_physics_collision(
    * Might need to be changed.
    */
   void calc_physics_collision(body_t *body1, body_t *body2, vector_t axis, void *aux) {
-    bool can_proceed = true;
-    list_t *collidedWith = body_get_collision_bodies(body1);
-    for (size_t i = 0; i < list_size(collidedWith); i++) {
-      body_t *collided = (body_t *)list_get(collidedWith, i);
-      if (collided == body2) {
-          can_proceed = false;
-          break;
-      }
-    }
+    // Only bounce once per contact, while the bodies are still overlapping
+    scene_t *scene = ((auxillary_t *) aux)->scene;
+    contact_t *contact = contact_cache_get(scene_get_contacts(scene),
+      body1, body2);
+    assert(contact != NULL);
 
-    if (can_proceed) {
+    if (!contact->resolved) {
       double impulse_magnitude = impulse_mag(body1, body2, axis, aux);
       vector_t impulse = vec_multiply(impulse_magnitude, axis);
 
       body_add_impulse(body1, vec_multiply(1, impulse));
       body_add_impulse(body2, vec_multiply(-1, impulse));
 
-      vector_t intersect = bodies_intersect(body1, body2);
+      // the manifold's points share the impulse, so it acts at their middle
+      vector_t intersect = VEC_ZERO;
+      for (size_t i = 0; i < contact->point_count; i++) {
+        intersect = vec_add(intersect, vec_multiply(
+          1.0 / contact->point_count, contact->points[i]));
+      }
 
       body_set_impact_pos(body1,intersect);
       body_set_impact_pos(body2,intersect);
       vector_t radial_line = vec_subtract(body_get_imp_pos(body2), body_get_centroid(body2));
       double angle_btwn = ang_diff(impulse, radial_line);
 
-      body_collided(body1, true);
-      body_collided(body2, true);
-
-      body_set_collision_body(body1, body2);
-      body_set_collision_body(body2, body1);
+      contact->resolved = true;
+      contact->impulse = vec_add(contact->impulse,
+        contact->body1 == body1 ? impulse : vec_negate(impulse));
 
 
-      if(intersect.x != 0.0 || intersect.y != 0.0){
+      if(contact->point_count > 0){
 
         double distance = vec_magnitude(radial_line);
         if(((body_get_imp_pos(body2).x == body_get_centroid(body2).x) && (body_get_imp_pos(body2).y == body_get_centroid(body2).y))){
@@ -0,0 +1,209 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h>
+#include "gjk.h"
+
+// A define rather than a const so the EPA polygon is a fixed-size array
+#define EPA_MAX_VERTICES 64
+
+const size_t GJK_MAX_ITERATIONS = 64;
+const double EPA_TOLERANCE = 1e-9;
+
+/**
+Finds the vertex of a shape furthest along a direction.
+*/
+static vector_t support_point(const shape_t *shape, vector_t direction) {
+  vector_t best = shape->points[0];
+  double best_dot = vec_dot(best, direction);
+  for (size_t i = 1; i < shape->size; i++) {
+    double dot = vec_dot(shape->points[i], direction);
+    if (dot > best_dot) {
+      best = shape->points[i];
+      best_dot = dot;
+    }
+  }
+  return best;
+}
+
+/**
+Finds the point of the Minkowski difference shape1 - shape2 furthest along a
+direction. The shapes collide exactly when the difference contains the origin.
+*/
+static vector_t support(const shape_t *shape1, const shape_t *shape2,
+  vector_t direction) {
+    return vec_subtract(support_point(shape1, direction),
+      support_point(shape2, vec_negate(direction)));
+}
+
+/**
+Computes (a x b) x c, which for a == c is the part of b perpendicular to a.
+*/
+static vector_t triple_product(vector_t a, vector_t b, vector_t c) {
+  return vec_subtract(vec_multiply(vec_dot(a, c), b),
+    vec_multiply(vec_dot(b, c), a));
+}
+
+/**
+Updates a simplex whose newest point is last, dropping the points that are not
+needed to enclose the origin. Returns whether the triangle encloses the origin;
+otherwise sets direction to where the next point should be searched for.
+*/
+static bool gjk_update(vector_t *simplex, size_t *size, vector_t *direction) {
+  vector_t a = simplex[*size - 1];
+  vector_t ao = vec_negate(a);
+  if (*size == 2) {
+    vector_t ab = vec_subtract(simplex[0], a);
+    *direction = triple_product(ab, ao, ab);
+    if (direction->x == 0 && direction->y == 0) {
+      // the origin is on the line through the segment; look beside it
+      *direction = vec_init(-ab.y, ab.x);
+    }
+    return false;
+  }
+
+  vector_t b = simplex[1];
+  vector_t c = simplex[0];
+  vector_t ab = vec_subtract(b, a);
+  vector_t ac = vec_subtract(c, a);
+  vector_t ab_perp = triple_product(ac, ab, ab);
+  vector_t ac_perp = triple_product(ab, ac, ac);
+  if (vec_dot(ab_perp, ao) > 0) {
+    // the origin is beyond edge ab, so c is not needed
+    simplex[0] = b;
+    simplex[1] = a;
+    *size = 2;
+    *direction = ab_perp;
+    return false;
+  }
+  if (vec_dot(ac_perp, ao) > 0) {
+    simplex[1] = a;
+    *size = 2;
+    *direction = ac_perp;
+    return false;
+  }
+  return true;
+}
+
+/**
+Runs GJK on the Minkowski difference of two shapes. If it contains the origin,
+returns true and leaves a triangle enclosing the origin in simplex.
+*/
+static bool gjk_intersect(const shape_t *shape1, const shape_t *shape2,
+  vector_t start, vector_t *simplex) {
+    vector_t direction = start;
+    if (direction.x == 0 && direction.y == 0) {
+      direction = vec_init(1, 0);
+    }
+    size_t size = 0;
+    simplex[size++] = support(shape1, shape2, direction);
+    if (vec_dot(simplex[0], direction) < 0) {
+      return false;
+    }
+    direction = vec_negate(simplex[0]);
+    for (size_t i = 0; i < GJK_MAX_ITERATIONS; i++) {
+      vector_t point = support(shape1, shape2, direction);
+      // if the furthest point does not reach the origin, nothing does; shapes
+      // that only touch reach it exactly, and collide with depth 0 as in SAT
+      if (vec_dot(point, direction) < 0) {
+        return false;
+      }
+      simplex[size++] = point;
+      if (gjk_update(simplex, &size, &direction)) {
+        return true;
+      }
+    }
+    // only reachable through rounding errors on shapes that barely touch
+    return false;
+}
+
+/**
+Runs EPA from a triangle enclosing the origin: grows the polygon towards the
+boundary of the Minkowski difference until its edge closest to the origin is
+on the boundary. That edge's normal and distance are the collision's axis and
+depth.
+*/
+static void epa_penetration(const shape_t *shape1, const shape_t *shape2,
+  const vector_t *simplex, vector_t *axis, double *depth) {
+    vector_t polytope[EPA_MAX_VERTICES];
+    size_t size = 3;
+    memcpy(polytope, simplex, size * sizeof(vector_t));
+    // keep the polygon counterclockwise so edge normals point outwards
+    if (vec_cross(vec_subtract(polytope[1], polytope[0]),
+      vec_subtract(polytope[2], polytope[0])) < 0) {
+        vector_t temp = polytope[1];
+        polytope[1] = polytope[2];
+        polytope[2] = temp;
+    }
+
+    while (true) {
+      size_t closest = 0;
+      double closest_distance = INFINITY;
+      vector_t closest_normal = VEC_ZERO;
+      for (size_t i = 0; i < size; i++) {
+        vector_t edge = vec_subtract(polytope[(i + 1) % size], polytope[i]);
+        vector_t normal = vec_unit(vec_init(edge.y, -edge.x));
+        double distance = vec_dot(normal, polytope[i]);
+        if (distance < closest_distance) {
+          closest = i;
+          closest_distance = distance;
+          closest_normal = normal;
+        }
+      }
+
+      vector_t point = support(shape1, shape2, closest_normal);
+      if (vec_dot(point, closest_normal) - closest_distance < EPA_TOLERANCE
+        || size == EPA_MAX_VERTICES) {
+          *axis = closest_normal;
+          *depth = closest_distance;
+          return;
+      }
+      memmove(&polytope[closest + 2], &polytope[closest + 1],
+        (size - closest - 1) * sizeof(vector_t));
+      polytope[closest + 1] = point;
+      size++;
+    }
+}
+
+/**
+Runs GJK, then EPA and the contact manifold if the shapes collide. The search
+starts along start, ideally from shape2 towards shape1.
+*/
+static collision_info_t gjk_shapes(const shape_t *shape1,
+  const shape_t *shape2, vector_t start) {
+    collision_info_t information = {
+      .collided = false,
+      .axis = {-1, -1},
+      .depth = 0,
+      .contact_count = 0,
+    };
+    vector_t simplex[3];
+    if (!gjk_intersect(shape1, shape2, start, simplex)) {
+      return information;
+    }
+    information.collided = true;
+    epa_penetration(shape1, shape2, simplex, &information.axis,
+      &information.depth);
+    contact_manifold(shape1, shape2, information.axis, &information);
+    return information;
+}
+
+static collision_info_t gjk_pieces(const shape_t *shape1, double radius1,
+  const shape_t *shape2, double radius2) {
+    (void) radius1;
+    (void) radius2;
+    return gjk_shapes(shape1, shape2,
+      vec_subtract(shape1->points[0], shape2->points[0]));
+}
+
+collision_info_t find_collision_gjk(body_t *body1, body_t *body2) {
+  if (body_get_radius(body1) > 0 || body_get_radius(body2) > 0) {
+    return find_round_collision(body1, body2);
+  }
+  if (body_get_piece_count(body1) > 1 || body_get_piece_count(body2) > 1) {
+    return find_piece_collision(body1, body2, gjk_pieces);
+  }
+  return gjk_shapes(body_get_shape_view(body1), body_get_shape_view(body2),
+    vec_subtract(body_get_centroid(body1), body_get_centroid(body2)));
+}
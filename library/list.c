@@ -72,6 +72,14 @@ void *list_get(list_t *list, size_t index) {
   return temp;
 }
 
+/**
+Replaces the element at a given index in a list.
+*/
+void list_set(list_t *list, size_t index, void *value) {
+  assert(list->size > index && value != NULL);
+  list->data[index] = value;
+}
+
 /**
 Appends an element to the end of a list.
 */
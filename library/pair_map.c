@@ -0,0 +1,221 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "pair_map.h"
+
+const size_t PAIR_MAP_MIN_CAPACITY = 16;
+// The map grows once it is more than MAX_LOAD_NUM / MAX_LOAD_DEN full
+const size_t MAX_LOAD_NUM = 3;
+const size_t MAX_LOAD_DEN = 4;
+
+/**
+An open-addressing hash table with linear probing.
+The capacity is always a power of two so slots can be found with a mask.
+*/
+typedef struct pair_map {
+  size_t size;
+  size_t capacity;
+  size_t value_size;
+  uint64_t *keys;
+  unsigned char *used;
+  unsigned char *values;
+} pair_map_t;
+
+/**
+Builds an order-independent key for two ids.
+*/
+uint64_t pair_key(size_t id1, size_t id2) {
+  assert(id1 <= UINT32_MAX && id2 <= UINT32_MAX);
+  uint64_t low = id1 < id2 ? id1 : id2;
+  uint64_t high = id1 < id2 ? id2 : id1;
+  return (high << 32) | low;
+}
+
+/**
+Mixes the bits of a key so that nearby keys land in distant slots.
+*/
+static size_t pair_map_hash(uint64_t key) {
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccdULL;
+  key ^= key >> 33;
+  key *= 0xc4ceb9fe1a85ec53ULL;
+  key ^= key >> 33;
+  return (size_t) key;
+}
+
+static void pair_map_alloc(pair_map_t *map, size_t capacity) {
+  map->capacity = capacity;
+  map->keys = malloc(capacity * sizeof(uint64_t));
+  assert(map->keys != NULL);
+  map->used = calloc(capacity, sizeof(unsigned char));
+  assert(map->used != NULL);
+  map->values = NULL;
+  if (map->value_size > 0) {
+    map->values = malloc(capacity * map->value_size);
+    assert(map->values != NULL);
+  }
+}
+
+/**
+Allocates an empty map with room for at least initial_size entries.
+*/
+pair_map_t *pair_map_init(size_t initial_size, size_t value_size) {
+  pair_map_t *map = malloc(sizeof(pair_map_t));
+  assert(map != NULL);
+  size_t capacity = PAIR_MAP_MIN_CAPACITY;
+  while (capacity * MAX_LOAD_NUM < initial_size * MAX_LOAD_DEN) {
+    capacity *= 2;
+  }
+  map->size = 0;
+  map->value_size = value_size;
+  pair_map_alloc(map, capacity);
+  return map;
+}
+
+/**
+Releases the memory allocated for a map.
+*/
+void pair_map_free(pair_map_t *map) {
+  free(map->keys);
+  free(map->used);
+  free(map->values);
+  free(map);
+}
+
+size_t pair_map_size(pair_map_t *map) {
+  return map->size;
+}
+
+/**
+Finds the slot holding key, or the empty slot where it would go.
+*/
+static size_t pair_map_find(pair_map_t *map, uint64_t key) {
+  size_t mask = map->capacity - 1;
+  size_t index = pair_map_hash(key) & mask;
+  while (map->used[index] && map->keys[index] != key) {
+    index = (index + 1) & mask;
+  }
+  return index;
+}
+
+static void *pair_map_value(pair_map_t *map, size_t index) {
+  if (map->value_size == 0) {
+    return &map->keys[index];
+  }
+  return map->values + index * map->value_size;
+}
+
+bool pair_map_contains(pair_map_t *map, uint64_t key) {
+  return map->used[pair_map_find(map, key)];
+}
+
+void *pair_map_get(pair_map_t *map, uint64_t key) {
+  size_t index = pair_map_find(map, key);
+  if (!map->used[index]) {
+    return NULL;
+  }
+  return pair_map_value(map, index);
+}
+
+/**
+Doubles the capacity of a map, rehashing every entry.
+*/
+static void pair_map_grow(pair_map_t *map) {
+  pair_map_t old = *map;
+  pair_map_alloc(map, 2 * old.capacity);
+  for (size_t i = 0; i < old.capacity; i++) {
+    if (old.used[i]) {
+      size_t index = pair_map_find(map, old.keys[i]);
+      map->used[index] = 1;
+      map->keys[index] = old.keys[i];
+      if (map->value_size > 0) {
+        memcpy(pair_map_value(map, index), pair_map_value(&old, i),
+          map->value_size);
+      }
+    }
+  }
+  free(old.keys);
+  free(old.used);
+  free(old.values);
+}
+
+void *pair_map_put(pair_map_t *map, uint64_t key) {
+  size_t index = pair_map_find(map, key);
+  if (map->used[index]) {
+    return pair_map_value(map, index);
+  }
+  if ((map->size + 1) * MAX_LOAD_DEN > map->capacity * MAX_LOAD_NUM) {
+    pair_map_grow(map);
+    index = pair_map_find(map, key);
+  }
+  map->used[index] = 1;
+  map->keys[index] = key;
+  map->size++;
+  void *value = pair_map_value(map, index);
+  if (map->value_size > 0) {
+    memset(value, 0, map->value_size);
+  }
+  return value;
+}
+
+/**
+Removes a key, shifting later entries of its probe run back into the gap
+so lookups never need tombstones.
+*/
+bool pair_map_remove(pair_map_t *map, uint64_t key) {
+  size_t mask = map->capacity - 1;
+  size_t hole = pair_map_find(map, key);
+  if (!map->used[hole]) {
+    return false;
+  }
+  size_t index = hole;
+  while (true) {
+    index = (index + 1) & mask;
+    if (!map->used[index]) {
+      break;
+    }
+    size_t home = pair_map_hash(map->keys[index]) & mask;
+    // Move the entry back only if its home slot is not between the hole
+    // and its current slot (cyclically).
+    bool stays = hole <= index ? (hole < home && home <= index)
+      : (hole < home || home <= index);
+    if (!stays) {
+      map->keys[hole] = map->keys[index];
+      if (map->value_size > 0) {
+        memcpy(pair_map_value(map, hole), pair_map_value(map, index),
+          map->value_size);
+      }
+      hole = index;
+    }
+  }
+  map->used[hole] = 0;
+  map->size--;
+  return true;
+}
+
+void pair_map_clear(pair_map_t *map) {
+  if (map->size > 0) {
+    memset(map->used, 0, map->capacity * sizeof(unsigned char));
+    map->size = 0;
+  }
+}
+
+size_t pair_map_capacity(pair_map_t *map) {
+  return map->capacity;
+}
+
+bool pair_map_slot(pair_map_t *map, size_t index, uint64_t *key,
+  void **value) {
+    assert(index < map->capacity);
+    if (!map->used[index]) {
+      return false;
+    }
+    if (key != NULL) {
+      *key = map->keys[index];
+    }
+    if (value != NULL) {
+      *value = pair_map_value(map, index);
+    }
+    return true;
+}
@@ -3,6 +3,8 @@
 #include "polygon.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <assert.h>
 #include <math.h>
 
 const double CENTROID_CONST = 6.0;
@@ -69,3 +71,268 @@ void polygon_rotate(list_t *polygon, double angle, vector_t point) {
   }
   polygon_translate(polygon, translator);
 }
+
+/**
+Computes the area of a packed polygon, positive if its vertices are listed
+counterclockwise and negative otherwise.
+*/
+static double shape_area_signed(const shape_t *shape) {
+  double sum = 0.0;
+  size_t size = shape->size;
+  for (size_t i = 0; i < size; i++) {
+    vector_t one = shape->points[i];
+    vector_t two = shape->points[(i + 1) % size];
+    sum += SUM_SCALE * vec_cross(one, two);
+  }
+  return sum;
+}
+
+/**
+Computes the area of a packed polygon.
+*/
+double shape_area(const shape_t *shape) {
+  return fabs(shape_area_signed(shape));
+}
+
+/**
+Computes the center of mass of a packed polygon.
+*/
+vector_t shape_centroid(const shape_t *shape) {
+  double area = shape_area(shape);
+  size_t size = shape->size;
+  vector_t centroid = {0, 0};
+  for (size_t i = 0; i < size; i++) {
+    vector_t one = shape->points[i];
+    vector_t two = shape->points[(i + 1) % size];
+    double cross = vec_cross(one, two);
+    centroid.x += (one.x + two.x) * cross;
+    centroid.y += (one.y + two.y) * cross;
+  }
+  if (area == 0) {
+    return centroid;
+  }
+  centroid.x /= (CENTROID_CONST * area);
+  centroid.y /= (CENTROID_CONST * area);
+  return centroid;
+}
+
+/**
+Translates all vertices in a packed polygon by a given vector.
+*/
+void shape_translate(shape_t *shape, vector_t translation) {
+  for (size_t i = 0; i < shape->size; i++) {
+    shape->points[i] = vec_add(shape->points[i], translation);
+  }
+}
+
+/**
+Rotates vertices in a packed polygon by a given angle about a given point.
+Computes the rotation matrix once and applies it in a single pass.
+*/
+void shape_rotate(shape_t *shape, double angle, vector_t point) {
+  double cos_angle = cos(angle);
+  double sin_angle = sin(angle);
+  for (size_t i = 0; i < shape->size; i++) {
+    vector_t offset = vec_subtract(shape->points[i], point);
+    vector_t rotated = {
+      offset.x * cos_angle - offset.y * sin_angle,
+      offset.x * sin_angle + offset.y * cos_angle
+    };
+    shape->points[i] = vec_add(rotated, point);
+  }
+}
+
+/**
+Returns whether a packed polygon turns the same way at every vertex.
+*/
+bool shape_is_convex(const shape_t *shape) {
+  bool left = false;
+  bool right = false;
+  size_t size = shape->size;
+  for (size_t i = 0; i < size; i++) {
+    vector_t one = shape->points[i];
+    vector_t two = shape->points[(i + 1) % size];
+    vector_t three = shape->points[(i + 2) % size];
+    double turn = vec_cross(vec_subtract(two, one), vec_subtract(three, two));
+    left = left || turn > 0;
+    right = right || turn < 0;
+  }
+  return !(left && right);
+}
+
+/**
+Returns whether a point is inside or on a counterclockwise triangle. Points on
+the edge c-a, the diagonal an ear is clipped along, only count if on_diagonal
+is true.
+*/
+static bool triangle_contains(vector_t a, vector_t b, vector_t c,
+  vector_t point, bool on_diagonal) {
+    double diagonal = vec_cross(vec_subtract(a, c), vec_subtract(point, c));
+    return vec_cross(vec_subtract(b, a), vec_subtract(point, a)) >= 0
+      && vec_cross(vec_subtract(c, b), vec_subtract(point, b)) >= 0
+      && (diagonal > 0 || (on_diagonal && diagonal == 0));
+}
+
+/**
+Returns whether the polygon through some of a shape's vertices never turns
+right.
+*/
+static bool piece_is_convex(const shape_t *shape, const size_t *piece,
+  size_t size) {
+    for (size_t i = 0; i < size; i++) {
+      vector_t one = shape->points[piece[i]];
+      vector_t two = shape->points[piece[(i + 1) % size]];
+      vector_t three = shape->points[piece[(i + 2) % size]];
+      if (vec_cross(vec_subtract(two, one), vec_subtract(three, two)) < 0) {
+        return false;
+      }
+    }
+    return true;
+}
+
+/**
+Triangulates a simple polygon by repeatedly clipping off ears: convex corners
+whose triangle holds no other vertex. Each triangle is written as a piece of
+vertex indices, n apart in pieces, with its size in sizes.
+Ears whose diagonal passes through another vertex are only clipped when there
+is no other ear left, since they leave pieces that merge badly.
+Returns the number of triangles, or 0 if some corner could never be clipped
+because the polygon intersects itself.
+*/
+static size_t shape_triangulate(const shape_t *shape, size_t *pieces,
+  size_t *sizes) {
+    size_t n = shape->size;
+    bool counterclockwise = shape_area_signed(shape) > 0;
+    size_t *remaining = malloc(n * sizeof(size_t));
+    assert(remaining != NULL);
+    for (size_t i = 0; i < n; i++) {
+      remaining[i] = counterclockwise ? i : n - 1 - i;
+    }
+    size_t count = n;
+    size_t triangles = 0;
+    size_t i = 0;
+    size_t misses = 0;
+    bool touching = false;
+    while (count >= 3) {
+      if (misses == count && !touching) {
+        touching = true;
+        misses = 0;
+      }
+      if (misses == count) {
+        free(remaining);
+        return 0;
+      }
+      size_t prev = remaining[(i + count - 1) % count];
+      size_t next = remaining[(i + 1) % count];
+      vector_t a = shape->points[prev];
+      vector_t b = shape->points[remaining[i]];
+      vector_t c = shape->points[next];
+      double turn = vec_cross(vec_subtract(b, a), vec_subtract(c, b));
+      bool ear = turn > 0;
+      for (size_t j = 0; ear && j < count; j++) {
+        size_t other = remaining[j];
+        ear = other == prev || other == remaining[i] || other == next
+          || !triangle_contains(a, b, c, shape->points[other], !touching);
+      }
+      // straight corners add no area, so they are dropped without a triangle
+      if (!ear && turn != 0) {
+        misses++;
+        i = (i + 1) % count;
+        continue;
+      }
+      if (ear) {
+        size_t *triangle = pieces + triangles * n;
+        triangle[0] = prev;
+        triangle[1] = remaining[i];
+        triangle[2] = next;
+        sizes[triangles++] = 3;
+      }
+      memmove(&remaining[i], &remaining[i + 1],
+        (count - i - 1) * sizeof(size_t));
+      count--;
+      misses = 0;
+      touching = false;
+      if (i == count) {
+        i = 0;
+      }
+    }
+    free(remaining);
+    return triangles;
+}
+
+/**
+Merges two counterclockwise pieces across an edge they share, into merged.
+Returns the size of the merged piece, or 0 if they share no edge or the
+merged piece would not be convex.
+*/
+static size_t merge_pieces(const shape_t *shape, const size_t *piece1,
+  size_t size1, const size_t *piece2, size_t size2, size_t *merged) {
+    for (size_t i = 0; i < size1; i++) {
+      size_t start = piece1[i];
+      size_t end = piece1[(i + 1) % size1];
+      for (size_t j = 0; j < size2; j++) {
+        if (piece2[j] != end || piece2[(j + 1) % size2] != start) {
+          continue;
+        }
+        // walk piece1 from end round to start, then piece2 back to end
+        size_t size = 0;
+        for (size_t k = 1; k <= size1; k++) {
+          merged[size++] = piece1[(i + k) % size1];
+        }
+        for (size_t k = 2; k < size2; k++) {
+          merged[size++] = piece2[(j + k) % size2];
+        }
+        return piece_is_convex(shape, merged, size) ? size : 0;
+      }
+    }
+    return 0;
+}
+
+/**
+Splits a polygon into convex pieces: triangulates it, then merges pieces
+across the diagonals that are not needed to keep every piece convex.
+*/
+list_t *shape_decompose(const shape_t *shape) {
+  size_t n = shape->size;
+  list_t *result = list_init(1, (free_func_t) shape_free);
+  if (n <= 3 || shape_is_convex(shape)) {
+    list_add(result, shape_copy(shape));
+    return result;
+  }
+  // no piece ever has more vertices than the polygon
+  size_t *pieces = malloc((n - 2) * n * sizeof(size_t));
+  size_t *sizes = malloc((n - 2) * sizeof(size_t));
+  size_t *merged = malloc(n * sizeof(size_t));
+  assert(pieces != NULL && sizes != NULL && merged != NULL);
+  size_t count = shape_triangulate(shape, pieces, sizes);
+  if (count == 0) {
+    list_add(result, shape_copy(shape));
+  }
+  for (size_t p = 0; p < count; p++) {
+    for (size_t q = p + 1; q < count; q++) {
+      size_t size = merge_pieces(shape, pieces + p * n, sizes[p],
+        pieces + q * n, sizes[q], merged);
+      if (size == 0) {
+        continue;
+      }
+      memcpy(pieces + p * n, merged, size * sizeof(size_t));
+      sizes[p] = size;
+      count--;
+      memcpy(pieces + q * n, pieces + count * n, sizes[count] * sizeof(size_t));
+      sizes[q] = sizes[count];
+      // the grown piece may now merge with ones it was already checked against
+      q = p;
+    }
+  }
+  for (size_t p = 0; p < count; p++) {
+    shape_t *piece = shape_init(sizes[p]);
+    for (size_t i = 0; i < sizes[p]; i++) {
+      piece->points[i] = shape->points[pieces[p * n + i]];
+    }
+    list_add(result, piece);
+  }
+  free(pieces);
+  free(sizes);
+  free(merged);
+  return result;
+}
@@ -1,13 +1,26 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
+#include <math.h>
 #include "scene.h"
 #include "body.h"
 #include "polygon.h"
 #include "forces.h"
 #include "collision.h"
+#include "broadphase.h"
+#include "pair_map.h"
+#include "contact_cache.h"
+#include "ccd.h"
+#include "gjk.h"
 
 const size_t INIT_SIZE = 5;
+// A tick is split at most this many times for bullets' times of impact
+const size_t CCD_MAX_SUBSTEPS = 8;
+const size_t NOT_COLLECTED = (size_t) -1;
+// Bodies slower than these for SLEEP_TIME seconds can fall asleep
+const double SLEEP_SPEED = 1.0;
+const double SLEEP_ANGULAR_SPEED = 0.05;
+const double SLEEP_TIME = 0.5;
 
 /**
  A collection of bodies. The scene automatically resizes to store arbitrarily
@@ -15,7 +28,36 @@ const size_t INIT_SIZE = 5;
  */
 typedef struct scene{
   list_t *scene_forces;
+  // body id -> holder_list_t of the force holders acting on the body
+  pair_map_t *holders_of;
   list_t *bodies;
+  body_store_t *store;
+  broadphase_t *broadphase;
+  pair_map_t *candidates;
+  bool candidates_valid;
+  contact_cache_t *contacts;
+  // the contact tick in which scene_collect_contacts() last tested every pair
+  size_t collected_tick;
+  narrowphase_t narrowphase;
+  list_t *collision_rules;
+  // pair_key of the body ids -> registered_pair_t
+  pair_map_t *registrations;
+  // body id -> key_list_t of the registered pairs the body is in
+  pair_map_t *registered_keys;
+  size_t duplicate_collisions;
+  bool sleeping;
+  // scratch space for grouping bodies into islands: body id -> body index,
+  // and per body index its parent in the island and how long it was still
+  pair_map_t *island_indices;
+  size_t *island_parents;
+  double *island_still_times;
+  size_t island_capacity;
+  // the forces and torques the force creators gave each body in the first
+  // step of a tick, for the later steps of a split tick (by body index)
+  vector_t *step_forces;
+  double *step_torques;
+  size_t step_count;
+  size_t step_capacity;
 } scene_t;
 
 typedef struct force_holder{
@@ -23,8 +65,72 @@ typedef struct force_holder{
   free_func_t freer;
   void *aux;
   list_t *bodies;
+  // set once a body it acts on is removed; dropped at the end of the tick
+  bool dead;
+  // how many lists point at it: scene_forces, and one per entry in a body's
+  // holder list; it is freed once the last of them lets go
+  size_t links;
 } force_holder_t;
 
+// The force holders acting on a body, some of which may be dead
+typedef struct holder_list{
+  list_t *holders;
+  size_t dead;
+} holder_list_t;
+
+typedef struct collision_rule{
+  uint32_t category1;
+  uint32_t category2;
+  collision_handler_t handler;
+  void *aux;
+  free_func_t freer;
+} collision_rule_t;
+
+// One handler registered for an ordered pair of bodies
+typedef struct registration{
+  body_t *body1;
+  body_t *body2;
+  collision_handler_t handler;
+  void *aux;
+  free_func_t freer;
+  struct registration *next;
+} registration_t;
+
+// The handlers registered for a pair, and where the pair's key is stored in
+// each of its bodies' key lists
+typedef struct registered_pair{
+  registration_t *head;
+  size_t ids[2];
+  size_t slots[2];
+} registered_pair_t;
+
+typedef struct key_list{
+  uint64_t *keys;
+  size_t size;
+  size_t capacity;
+} key_list_t;
+
+static void collision_rule_free(collision_rule_t *rule) {
+  if (rule->freer != NULL) {
+    rule->freer(rule->aux);
+  }
+  free(rule);
+}
+
+/**
+Frees a list of registrations and their auxiliary values.
+*/
+static void registration_free(registration_t *registration) {
+  while (registration != NULL) {
+    registration_t *next = registration->next;
+    if (registration->freer != NULL) {
+      registration->freer(registration->aux);
+    }
+    free(registration);
+    registration = next;
+  }
+}
+
 
 /**
 Allocates memory for an empty scene. Makes a reasonable guess of the number
@@ -36,6 +142,39 @@ scene_t *scene_init(void){
   assert(new_scene != NULL);
   new_scene->bodies = list_init(2 * INIT_SIZE, (free_func_t) body_free);
   new_scene->scene_forces = list_init(2 * INIT_SIZE, NULL);
+  new_scene->holders_of = pair_map_init(INIT_SIZE, sizeof(holder_list_t));
+  new_scene->store = NULL;
+  new_scene->broadphase = NULL;
+  new_scene->candidates = NULL;
+  new_scene->candidates_valid = false;
+  new_scene->contacts = contact_cache_init();
+  new_scene->collected_tick = NOT_COLLECTED;
+  new_scene->narrowphase = NARROWPHASE_SAT;
+  new_scene->collision_rules = list_init(INIT_SIZE,
+    (free_func_t) collision_rule_free);
+  new_scene->registrations = pair_map_init(INIT_SIZE,
+    sizeof(registered_pair_t));
+  new_scene->registered_keys = pair_map_init(INIT_SIZE, sizeof(key_list_t));
+  new_scene->duplicate_collisions = 0;
+  new_scene->sleeping = false;
+  new_scene->island_indices = pair_map_init(INIT_SIZE, sizeof(size_t));
+  new_scene->island_parents = NULL;
+  new_scene->island_still_times = NULL;
+  new_scene->island_capacity = 0;
+  new_scene->step_forces = NULL;
+  new_scene->step_torques = NULL;
+  new_scene->step_count = 0;
+  new_scene->step_capacity = 0;
+  return new_scene;
+}
+
+/**
+Allocates memory for an empty scene whose bodies keep their hot state in
+one structure-of-arrays store, so scene_tick() integrates them in tight loops.
+*/
+scene_t *scene_init_soa(size_t capacity){
+  scene_t *new_scene = scene_init();
+  new_scene->store = body_store_init(capacity);
   return new_scene;
 }
 
@@ -51,6 +190,8 @@ force_holder_t *force_holder_init(
     force_holder->freer = freer;
     force_holder->aux = aux;
     force_holder->bodies = bodies;
+    force_holder->dead = false;
+    force_holder->links = 0;
     return force_holder;
 }
 
@@ -62,6 +203,16 @@ void force_holder_free(force_holder_t *force) {
   free(force);
 }
 
+/**
+Drops one list's link to a force holder, freeing it if that was the last.
+*/
+static void force_holder_unlink(force_holder_t *holder){
+  holder->links--;
+  if (holder->links == 0) {
+    force_holder_free(holder);
+  }
+}
+
 void *force_get_aux(force_holder_t *force) {
     return force->aux;
   }
@@ -78,12 +229,70 @@ list_t *force_get_all_bodies(force_holder_t *force) {
 }
 
 
+/**
+Frees the lists of force holders kept for each body, leaving the map empty.
+Dead holders that only these lists still pointed at are freed too.
+*/
+static void scene_clear_holders_of(scene_t *scene){
+  for (size_t i = 0; i < pair_map_capacity(scene->holders_of); i++) {
+    void *value;
+    if (pair_map_slot(scene->holders_of, i, NULL, &value)) {
+      list_t *holders = ((holder_list_t *) value)->holders;
+      for (size_t j = 0; j < list_size(holders); j++) {
+        force_holder_unlink(list_get(holders, j));
+      }
+      list_free(holders);
+    }
+  }
+  pair_map_clear(scene->holders_of);
+}
+
+/**
+Frees every registration in a scene and the bodies' key lists, leaving both
+maps empty.
+*/
+static void scene_clear_registrations(scene_t *scene){
+  for (size_t i = 0; i < pair_map_capacity(scene->registrations); i++) {
+    void *value;
+    if (pair_map_slot(scene->registrations, i, NULL, &value)) {
+      registration_free(((registered_pair_t *) value)->head);
+    }
+  }
+  for (size_t i = 0; i < pair_map_capacity(scene->registered_keys); i++) {
+    void *value;
+    if (pair_map_slot(scene->registered_keys, i, NULL, &value)) {
+      free(((key_list_t *) value)->keys);
+    }
+  }
+  pair_map_clear(scene->registrations);
+  pair_map_clear(scene->registered_keys);
+}
+
 /**
 Releases memory allocated for a given scene and all its bodies.
 */
 void scene_free(scene_t *scene){
+  if (scene->broadphase != NULL) {
+    broadphase_free(scene->broadphase);
+    pair_map_free(scene->candidates);
+  }
   list_free(scene->bodies);
+  scene_clear_holders_of(scene);
+  pair_map_free(scene->holders_of);
   list_free(scene->scene_forces);
+  if (scene->store != NULL) {
+    body_store_free(scene->store);
+  }
+  contact_cache_free(scene->contacts);
+  list_free(scene->collision_rules);
+  scene_clear_registrations(scene);
+  pair_map_free(scene->registrations);
+  pair_map_free(scene->registered_keys);
+  pair_map_free(scene->island_indices);
+  free(scene->island_parents);
+  free(scene->island_still_times);
+  free(scene->step_forces);
+  free(scene->step_torques);
   free(scene);
 }
 
@@ -107,9 +316,553 @@ body_t *scene_get_body(scene_t *scene, size_t index){
 Adds a body to a scene.
 */
 void scene_add_body(scene_t *scene, body_t *body){
+  if (scene->store != NULL) {
+    body_set_store(body, scene->store);
+  }
+  if (scene->broadphase != NULL) {
+    broadphase_add(scene->broadphase, body);
+    scene->candidates_valid = false;
+  }
+  scene->collected_tick = NOT_COLLECTED;
   list_add(scene->bodies, body);
 }
 
+/**
+Replaces a scene's broadphase, which then tracks all of the scene's bodies.
+*/
+void scene_set_broadphase(scene_t *scene, broadphase_t *broadphase){
+  if (scene->broadphase != NULL) {
+    broadphase_free(scene->broadphase);
+    pair_map_free(scene->candidates);
+  }
+  scene->broadphase = broadphase;
+  scene->candidates = NULL;
+  if (broadphase != NULL) {
+    scene->candidates = pair_map_init(scene_bodies(scene),
+      sizeof(body_pair_t));
+    for (size_t i = 0; i < scene_bodies(scene); i++) {
+      broadphase_add(broadphase, scene_get_body(scene, i));
+    }
+    broadphase_find_pairs(broadphase, scene->candidates);
+  }
+  scene->candidates_valid = broadphase != NULL;
+  scene->collected_tick = NOT_COLLECTED;
+}
+
+/**
+Finds the pairs of bodies whose bounding boxes overlap, unless they were found
+since the bodies last moved.
+*/
+static void scene_update_candidates(scene_t *scene){
+  if (scene->broadphase != NULL && !scene->candidates_valid) {
+    pair_map_clear(scene->candidates);
+    broadphase_find_pairs(scene->broadphase, scene->candidates);
+    scene->candidates_valid = true;
+  }
+}
+
+/**
+Returns whether two bodies' bounding boxes overlapped at the start of this
+tick. Without a broadphase every pair might collide.
+*/
+bool scene_may_collide(scene_t *scene, body_t *body1, body_t *body2){
+  if (scene->broadphase == NULL) {
+    return body_can_collide(body1, body2);
+  }
+  scene_update_candidates(scene);
+  return pair_map_contains(scene->candidates,
+    pair_key(body_get_id(body1), body_get_id(body2)));
+}
+
+void scene_set_narrowphase(scene_t *scene, narrowphase_t narrowphase){
+  scene->narrowphase = narrowphase;
+}
+
+narrowphase_t scene_get_narrowphase(scene_t *scene){
+  return scene->narrowphase;
+}
+
+/**
+Returns whether a body cannot move: it is asleep, or immovable while the
+scene lets bodies sleep.
+*/
+static bool scene_is_resting(scene_t *scene, body_t *body){
+  return scene->sleeping
+    && (body_is_sleeping(body) || body_get_mass(body) == INFINITY);
+}
+
+/**
+Returns whether none of a scene's bodies can move.
+*/
+static bool scene_is_settled(scene_t *scene){
+  if (!scene->sleeping) {
+    return false;
+  }
+  for (size_t i = 0; i < scene_bodies(scene); i++) {
+    if (!scene_is_resting(scene, scene_get_body(scene, i))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void scene_set_sleeping(scene_t *scene, bool sleeping){
+  scene->sleeping = sleeping;
+  if (!sleeping) {
+    for (size_t i = 0; i < scene_bodies(scene); i++) {
+      body_t *body = scene_get_body(scene, i);
+      if (body_is_sleeping(body)) {
+        body_wake(body);
+      }
+    }
+  }
+}
+
+/**
+Gets the contacts between a scene's bodies.
+*/
+contact_cache_t *scene_get_contacts(scene_t *scene){
+  return scene->contacts;
+}
+
+/**
+Tests a pair of bodies with the scene's narrowphase and records the result in
+its contacts. A pair found touching since the bodies last moved is not
+tested again.
+*/
+contact_t *scene_test_pair(scene_t *scene, body_t *body1, body_t *body2){
+  contact_cache_t *cache = scene->contacts;
+  contact_t *contact = contact_cache_get(cache, body1, body2);
+  if (contact != NULL && contact->state != CONTACT_ENDED
+    && contact->last_tick == contact_cache_get_tick(cache)) {
+      return contact;
+  }
+  if (scene_is_resting(scene, body1) && scene_is_resting(scene, body2)) {
+    // neither body can have moved, so they touch exactly when they last did
+    if (contact == NULL || contact->state == CONTACT_ENDED) {
+      return NULL;
+    }
+    return contact_cache_touch(cache, contact->body1, contact->body2,
+      contact->axis);
+  }
+  if (!scene_may_collide(scene, body1, body2)) {
+    contact_cache_separate(cache, body1, body2);
+    return NULL;
+  }
+  collision_info_t info;
+  if (scene->narrowphase == NARROWPHASE_GJK) {
+    info = find_collision_gjk(body1, body2);
+  }
+  else {
+    info = find_collision_cached(cache, body1, body2);
+  }
+  if (!get_if_collided(info)) {
+    contact_cache_separate(cache, body1, body2);
+    return NULL;
+  }
+  contact = contact_cache_touch(cache, body1, body2, get_collision_axis(info));
+  contact->point_count = info.contact_count;
+  for (size_t i = 0; i < info.contact_count; i++) {
+    contact->points[i] = info.contacts[i];
+  }
+  return contact;
+}
+
+/**
+Tests every pair of bodies the broadphase found (or every pair, without one),
+unless that was already done since the bodies last moved.
+*/
+static void scene_test_all_pairs(scene_t *scene){
+  size_t tick = contact_cache_get_tick(scene->contacts);
+  if (scene->collected_tick == tick) {
+    return;
+  }
+  if (scene->broadphase != NULL) {
+    scene_update_candidates(scene);
+    for (size_t i = 0; i < pair_map_capacity(scene->candidates); i++) {
+      void *value;
+      if (pair_map_slot(scene->candidates, i, NULL, &value)) {
+        body_pair_t *pair = value;
+        if (!body_is_removed(pair->body1) && !body_is_removed(pair->body2)) {
+          scene_test_pair(scene, pair->body1, pair->body2);
+        }
+      }
+    }
+  }
+  else {
+    for (size_t i = 0; i < scene_bodies(scene); i++) {
+      body_t *body1 = scene_get_body(scene, i);
+      for (size_t j = i + 1; j < scene_bodies(scene); j++) {
+        body_t *body2 = scene_get_body(scene, j);
+        if (!body_is_removed(body1) && !body_is_removed(body2)) {
+          scene_test_pair(scene, body1, body2);
+        }
+      }
+    }
+  }
+  scene->collected_tick = tick;
+}
+
+/**
+Returns whether a slot of a scene's contacts holds a pair found touching since
+the bodies last moved, neither of which is being removed.
+*/
+static bool scene_is_touching(scene_t *scene, contact_t *contact){
+  return contact != NULL && contact->state != CONTACT_ENDED
+    && contact->last_tick == contact_cache_get_tick(scene->contacts)
+    && !body_is_removed(contact->body1) && !body_is_removed(contact->body2);
+}
+
+/**
+Copies the contacts of every touching pair into a list.
+*/
+void scene_collect_contacts(scene_t *scene, list_t *contacts){
+  scene_test_all_pairs(scene);
+  contact_cache_t *cache = scene->contacts;
+  for (size_t i = 0; i < contact_cache_capacity(cache); i++) {
+    contact_t *contact = contact_cache_slot(cache, i);
+    if (scene_is_touching(scene, contact)) {
+      contact_t *copy = malloc(sizeof(contact_t));
+      assert(copy != NULL);
+      *copy = *contact;
+      list_add(contacts, copy);
+    }
+  }
+}
+
+void scene_add_collision_rule(scene_t *scene, uint32_t category1,
+  uint32_t category2, collision_handler_t handler, void *aux,
+  free_func_t freer){
+    collision_rule_t *rule = malloc(sizeof(collision_rule_t));
+    assert(rule != NULL);
+    rule->category1 = category1;
+    rule->category2 = category2;
+    rule->handler = handler;
+    rule->aux = aux;
+    rule->freer = freer;
+    list_add(scene->collision_rules, rule);
+}
+
+/**
+Adds a new registered pair to its bodies' key lists. A body registered with
+itself is listed once.
+*/
+static void scene_index_pair(scene_t *scene, uint64_t key,
+  registered_pair_t *pair){
+    size_t sides = pair->ids[0] == pair->ids[1] ? 1 : 2;
+    for (size_t side = 0; side < sides; side++) {
+      key_list_t *list = pair_map_put(scene->registered_keys,
+        pair->ids[side]);
+      if (list->size == list->capacity) {
+        list->capacity = list->capacity == 0 ? 4 : list->capacity * 2;
+        list->keys = realloc(list->keys, list->capacity * sizeof(uint64_t));
+        assert(list->keys != NULL);
+      }
+      pair->slots[side] = list->size;
+      list->keys[list->size++] = key;
+    }
+}
+
+/**
+Frees a registered pair's handlers and drops it from the map and from its
+bodies' key lists, moving each list's last key into the hole.
+*/
+static void scene_unregister_pair(scene_t *scene, uint64_t key){
+  registered_pair_t *pair = pair_map_get(scene->registrations, key);
+  registration_free(pair->head);
+  size_t sides = pair->ids[0] == pair->ids[1] ? 1 : 2;
+  for (size_t side = 0; side < sides; side++) {
+    size_t id = pair->ids[side];
+    key_list_t *list = pair_map_get(scene->registered_keys, id);
+    uint64_t moved = list->keys[--list->size];
+    if (moved != key) {
+      size_t slot = pair->slots[side];
+      list->keys[slot] = moved;
+      registered_pair_t *moved_pair = pair_map_get(scene->registrations,
+        moved);
+      moved_pair->slots[moved_pair->ids[0] == id ? 0 : 1] = slot;
+    }
+    if (list->size == 0) {
+      free(list->keys);
+      pair_map_remove(scene->registered_keys, id);
+    }
+  }
+  pair_map_remove(scene->registrations, key);
+}
+
+bool scene_register_collision(scene_t *scene, body_t *body1, body_t *body2,
+  collision_handler_t handler, void *aux, free_func_t freer){
+    uint64_t key = pair_key(body_get_id(body1), body_get_id(body2));
+    registered_pair_t *pair = pair_map_get(scene->registrations, key);
+    if (pair == NULL) {
+      pair = pair_map_put(scene->registrations, key);
+      pair->head = NULL;
+      pair->ids[0] = body_get_id(body1);
+      pair->ids[1] = body_get_id(body2);
+      scene_index_pair(scene, key, pair);
+    }
+    // handlers are kept in the order they were registered in
+    registration_t **tail = &pair->head;
+    for (; *tail != NULL; tail = &(*tail)->next) {
+      if ((*tail)->body1 == body1 && (*tail)->handler == handler) {
+        scene->duplicate_collisions++;
+        if (freer != NULL) {
+          freer(aux);
+        }
+        return false;
+      }
+    }
+    registration_t *registration = malloc(sizeof(registration_t));
+    assert(registration != NULL);
+    registration->body1 = body1;
+    registration->body2 = body2;
+    registration->handler = handler;
+    registration->aux = aux;
+    registration->freer = freer;
+    registration->next = NULL;
+    *tail = registration;
+    return true;
+}
+
+size_t scene_duplicate_collisions(scene_t *scene){
+  return scene->duplicate_collisions;
+}
+
+/**
+Drops the registrations of every pair a body is in, which unregistering
+shrinks from the end of the body's key list.
+*/
+static void scene_unregister_body(scene_t *scene, body_t *body){
+  size_t id = body_get_id(body);
+  key_list_t *list;
+  while ((list = pair_map_get(scene->registered_keys, id)) != NULL) {
+    scene_unregister_pair(scene, list->keys[list->size - 1]);
+  }
+}
+
+/**
+Returns whether a collision rule or registration wants to hear about a pair
+of bodies touching.
+*/
+static bool scene_has_handler(scene_t *scene, body_t *body1, body_t *body2){
+  if (pair_map_contains(scene->registrations,
+    pair_key(body_get_id(body1), body_get_id(body2)))) {
+      return true;
+  }
+  uint32_t category1 = body_get_category(body1);
+  uint32_t category2 = body_get_category(body2);
+  for (size_t i = 0; i < list_size(scene->collision_rules); i++) {
+    collision_rule_t *rule = list_get(scene->collision_rules, i);
+    if (((category1 & rule->category1) && (category2 & rule->category2))
+      || ((category2 & rule->category1) && (category1 & rule->category2))) {
+        return true;
+    }
+  }
+  return false;
+}
+
+/**
+Tests a pair of bodies if some handler wants to hear about it.
+*/
+static void scene_test_handled_pair(scene_t *scene, body_t *body1,
+  body_t *body2){
+    if (!body_is_removed(body1) && !body_is_removed(body2)
+      && scene_has_handler(scene, body1, body2)) {
+        scene_test_pair(scene, body1, body2);
+    }
+}
+
+/**
+Tests the pairs of bodies that have collision handlers: the broadphase's
+candidates, or without one, every registered pair (and every pair once there
+are collision rules). Pairs no handler cares about are never tested.
+*/
+static void scene_test_handled_pairs(scene_t *scene){
+  if (scene->collected_tick == contact_cache_get_tick(scene->contacts)) {
+    return;
+  }
+  if (scene->broadphase != NULL) {
+    scene_update_candidates(scene);
+    for (size_t i = 0; i < pair_map_capacity(scene->candidates); i++) {
+      void *value;
+      if (pair_map_slot(scene->candidates, i, NULL, &value)) {
+        body_pair_t *pair = value;
+        scene_test_handled_pair(scene, pair->body1, pair->body2);
+      }
+    }
+  }
+  else if (list_size(scene->collision_rules) > 0) {
+    for (size_t i = 0; i < scene_bodies(scene); i++) {
+      for (size_t j = i + 1; j < scene_bodies(scene); j++) {
+        scene_test_handled_pair(scene, scene_get_body(scene, i),
+          scene_get_body(scene, j));
+      }
+    }
+  }
+  else {
+    for (size_t i = 0; i < pair_map_capacity(scene->registrations); i++) {
+      void *value;
+      if (pair_map_slot(scene->registrations, i, NULL, &value)) {
+        registration_t *registration = ((registered_pair_t *) value)->head;
+        scene_test_handled_pair(scene, registration->body1,
+          registration->body2);
+      }
+    }
+  }
+}
+
+/**
+Runs the scene's collision system: tests the pairs that have handlers, then
+calls each collision rule's handler on the touching pairs it matches, with the
+bodies in the order of the rule's categories, and each registered handler on
+its touching pair, with the bodies in the order they were registered in.
+*/
+static void scene_apply_collisions(scene_t *scene){
+  if (list_size(scene->collision_rules) == 0
+    && pair_map_size(scene->registrations) == 0) {
+      return;
+  }
+  scene_test_handled_pairs(scene);
+  contact_cache_t *cache = scene->contacts;
+  for (size_t i = 0; i < contact_cache_capacity(cache); i++) {
+    contact_t *contact = contact_cache_slot(cache, i);
+    if (!scene_is_touching(scene, contact)) {
+      continue;
+    }
+    body_t *body1 = contact->body1;
+    body_t *body2 = contact->body2;
+    if (scene_is_resting(scene, body1) && scene_is_resting(scene, body2)) {
+      continue;
+    }
+    vector_t axis = contact->axis;
+    for (size_t j = 0; j < list_size(scene->collision_rules); j++) {
+      collision_rule_t *rule = list_get(scene->collision_rules, j);
+      if ((body_get_category(body1) & rule->category1)
+        && (body_get_category(body2) & rule->category2)) {
+          rule->handler(body1, body2, axis, rule->aux);
+      }
+      else if ((body_get_category(body2) & rule->category1)
+        && (body_get_category(body1) & rule->category2)) {
+          rule->handler(body2, body1, vec_negate(axis), rule->aux);
+      }
+    }
+    registered_pair_t *pair = pair_map_get(scene->registrations,
+      pair_key(body_get_id(body1), body_get_id(body2)));
+    // handlers may register more pairs, which can move the map's entries
+    registration_t *registration = pair != NULL ? pair->head : NULL;
+    for (; registration != NULL; registration = registration->next) {
+      if (registration->body1 == body1) {
+        registration->handler(body1, body2, axis, registration->aux);
+      }
+      else {
+        registration->handler(body2, body1, vec_negate(axis),
+          registration->aux);
+      }
+    }
+  }
+}
+
+typedef struct raycast_query {
+  uint32_t mask;
+  body_t *body;
+  raycast_hit_t *hit;
+} raycast_query_t;
+
+static bool scene_can_hit(raycast_query_t *query, body_t *body){
+  return body != query->body && !body_is_removed(body)
+    && (body_get_category(body) & query->mask) != 0;
+}
+
+static double scene_ray_hit(body_t *body, vector_t origin, vector_t direction,
+  double max_t, void *aux){
+    raycast_query_t *query = aux;
+    if (!scene_can_hit(query, body)) {
+      return max_t;
+    }
+    vector_t normal;
+    double t = ray_time_of_impact(body, origin, direction, max_t, &normal);
+    if (t == INFINITY) {
+      return max_t;
+    }
+    query->hit->body = body;
+    query->hit->fraction = t;
+    query->hit->point = vec_add(origin, vec_multiply(t, direction));
+    query->hit->normal = normal;
+    // only closer bodies matter from now on
+    return t;
+}
+
+bool scene_raycast(scene_t *scene, vector_t start, vector_t end,
+  uint32_t mask, raycast_hit_t *hit){
+    raycast_query_t query = {.mask = mask, .body = NULL, .hit = hit};
+    hit->body = NULL;
+    hit->fraction = 1;
+    vector_t direction = vec_subtract(end, start);
+    scene_update_candidates(scene);
+    if (scene->broadphase != NULL && broadphase_raycast(scene->broadphase,
+      start, direction, 1, scene_ray_hit, &query)) {
+        return hit->body != NULL;
+    }
+    for (size_t i = 0; i < scene_bodies(scene); i++) {
+      scene_ray_hit(scene_get_body(scene, i), start, direction, hit->fraction,
+        &query);
+    }
+    return hit->body != NULL;
+}
+
+typedef struct shapecast_query {
+  raycast_query_t base;
+  vector_t translation;
+} shapecast_query_t;
+
+static bool scene_shape_hit(body_t *body, void *aux){
+  shapecast_query_t *query = aux;
+  raycast_query_t *base = &query->base;
+  if (!scene_can_hit(base, body)
+    || get_if_collided(find_collision(body, base->body))) {
+      return true;
+  }
+  vector_t normal;
+  vector_t point;
+  double t = shape_time_of_impact(body_get_shape_view(body),
+    body_get_radius(body), body_get_shape_view(base->body),
+    body_get_radius(base->body), query->translation, base->hit->fraction,
+    &normal, &point);
+  if (t != INFINITY && (base->hit->body == NULL || t < base->hit->fraction)) {
+    base->hit->body = body;
+    base->hit->fraction = t;
+    base->hit->point = point;
+    base->hit->normal = normal;
+  }
+  return true;
+}
+
+bool scene_shapecast(scene_t *scene, body_t *body, vector_t translation,
+  uint32_t mask, raycast_hit_t *hit){
+    shapecast_query_t query = {
+      .base = {.mask = mask, .body = body, .hit = hit},
+      .translation = translation
+    };
+    hit->body = NULL;
+    hit->fraction = 1;
+    aabb_t box = body_get_aabb(body);
+    aabb_t moved = {vec_add(box.min, translation),
+      vec_add(box.max, translation)};
+    aabb_t path = aabb_union(box, moved);
+    scene_update_candidates(scene);
+    if (scene->broadphase != NULL
+      && broadphase_query(scene->broadphase, path, scene_shape_hit, &query)) {
+        return hit->body != NULL;
+    }
+    for (size_t i = 0; i < scene_bodies(scene); i++) {
+      body_t *other = scene_get_body(scene, i);
+      if (aabb_overlap(path, body_get_aabb(other))) {
+        scene_shape_hit(other, &query);
+      }
+    }
+    return hit->body != NULL;
+}
+
 /**
 Removes and frees the body at a given index from a scene.
 Asserts that the index is valid.
@@ -134,9 +887,36 @@ void scene_add_bodies_force_creator(
   free_func_t freer) {
       force_holder_t *force = force_holder_init(forcer, freer, aux, bodies);
       list_add(scene->scene_forces, force);
+      // a body listed twice is referenced twice, and unlinked twice
+      force->links = 1 + list_size(bodies);
+      for (size_t i = 0; i < list_size(bodies); i++) {
+        uint64_t id = body_get_id(list_get(bodies, i));
+        holder_list_t *list = pair_map_get(scene->holders_of, id);
+        if (list == NULL) {
+          list = pair_map_put(scene->holders_of, id);
+          list->holders = list_init(2, NULL);
+          list->dead = 0;
+        }
+        list_add(list->holders, force);
+      }
 }
 
 void scene_clear(scene_t *scene) {
+  if (scene->broadphase != NULL) {
+    for (size_t i = 0; i < scene_bodies(scene); i++) {
+      broadphase_remove(scene->broadphase, scene_get_body(scene, i));
+    }
+    pair_map_clear(scene->candidates);
+    scene->candidates_valid = false;
+  }
+  contact_cache_clear(scene->contacts);
+  scene->collected_tick = NOT_COLLECTED;
+  scene->step_count = 0;
+  list_free(scene->collision_rules);
+  scene->collision_rules = list_init(INIT_SIZE,
+    (free_func_t) collision_rule_free);
+  scene_clear_registrations(scene);
+  scene_clear_holders_of(scene);
   list_free(scene->bodies);
   list_free(scene->scene_forces);
   scene->bodies = list_init(5, (free_func_t) body_free);
@@ -144,43 +924,398 @@ void scene_clear(scene_t *scene) {
 }
 
 /**
-  Executes a tick of a given scene over a small time interval.
-  This requires ticking each body in the scene.
+Integrates every awake body in a scene over a time interval.
+Scenes with a body store are integrated in batches by body_store_tick(),
+which skips the slots of sleeping bodies.
 */
-void scene_tick(scene_t *scene, double dt) {
-  for (int i = 0; i < list_size(scene->scene_forces); i++) {
-    force_holder_t *force_holder = (force_holder_t *)list_get(scene->scene_forces, i);
-    get_force(force_holder)(force_get_aux(force_holder));
+void scene_integrate(scene_t *scene, double dt) {
+  if (scene->store != NULL) {
+    body_store_tick(scene->store, dt);
+    return;
+  }
+  for(size_t i = 0; i < scene_bodies(scene); i++) {
+    body_t *body = scene_get_body(scene, i);
+    if (!body_is_sleeping(body)) {
+      body_tick(body, dt);
+    }
+  }
+}
+
+/**
+Finds the root of a body's island, halving the path to it on the way.
+*/
+static size_t island_find(size_t *parents, size_t index){
+  while (parents[index] != index) {
+    parents[index] = parents[parents[index]];
+    index = parents[index];
+  }
+  return index;
+}
+
+/**
+Returns whether a body can join an island and fall asleep.
+*/
+static bool scene_can_sleep(body_t *body){
+  return body_get_mass(body) != INFINITY && !body_is_removed(body);
+}
+
+/**
+Times how long each awake body has been still, then groups the touching
+bodies into islands with a union-find. Islands whose bodies have all been still
+for SLEEP_TIME fall asleep; the others wake up entirely.
+*/
+static void scene_update_sleep(scene_t *scene, double dt){
+  if (!scene->sleeping || scene_is_settled(scene)) {
+    return;
+  }
+  size_t size = scene_bodies(scene);
+  if (size > scene->island_capacity) {
+    scene->island_capacity = 2 * size;
+    scene->island_parents = realloc(scene->island_parents,
+      scene->island_capacity * sizeof(size_t));
+    scene->island_still_times = realloc(scene->island_still_times,
+      scene->island_capacity * sizeof(double));
+    assert(scene->island_parents != NULL);
+    assert(scene->island_still_times != NULL);
+  }
+  size_t *parents = scene->island_parents;
+  double *still_times = scene->island_still_times;
+  pair_map_clear(scene->island_indices);
+  for (size_t i = 0; i < size; i++) {
+    body_t *body = scene_get_body(scene, i);
+    parents[i] = i;
+    still_times[i] = INFINITY;
+    if (!scene_can_sleep(body)) {
+      continue;
+    }
+    *(size_t *) pair_map_put(scene->island_indices, body_get_id(body)) = i;
+    if (!body_is_sleeping(body)) {
+      bool still = vec_magnitude(body_get_velocity(body)) < SLEEP_SPEED
+        && fabs(body_get_angular_velocity(body)) < SLEEP_ANGULAR_SPEED;
+      body_set_still_time(body, still ? body_get_still_time(body) + dt : 0);
+    }
+  }
+
+  contact_cache_t *cache = scene->contacts;
+  for (size_t i = 0; i < contact_cache_capacity(cache); i++) {
+    contact_t *contact = contact_cache_slot(cache, i);
+    if (!scene_is_touching(scene, contact)) {
+      continue;
+    }
+    size_t *index1 = pair_map_get(scene->island_indices,
+      body_get_id(contact->body1));
+    size_t *index2 = pair_map_get(scene->island_indices,
+      body_get_id(contact->body2));
+    if (index1 != NULL && index2 != NULL) {
+      parents[island_find(parents, *index1)] = island_find(parents, *index2);
+    }
+  }
+
+  // an island is only as still as its least still body
+  for (size_t i = 0; i < size; i++) {
+    body_t *body = scene_get_body(scene, i);
+    if (scene_can_sleep(body)) {
+      size_t root = island_find(parents, i);
+      still_times[root] = fmin(still_times[root], body_get_still_time(body));
+    }
+  }
+  for (size_t i = 0; i < size; i++) {
+    body_t *body = scene_get_body(scene, i);
+    if (!scene_can_sleep(body)) {
+      continue;
+    }
+    bool asleep = still_times[island_find(parents, i)] >= SLEEP_TIME;
+    if (asleep && !body_is_sleeping(body)) {
+      body_sleep(body);
+    }
+    else if (!asleep && body_is_sleeping(body)) {
+      body_wake(body);
+    }
   }
+}
 
-  bool free = false;
-  for (size_t i = 0; i < list_size(scene->scene_forces); i++) {
-    force_holder_t *force_holder = list_get(scene->scene_forces, i);
-    list_t *list_bodies = force_get_all_bodies(force_holder);
+typedef struct bullet_query {
+  body_t *bullet;
+  double dt;
+  double time_of_impact;
+} bullet_query_t;
 
-    for(size_t j = 0; j < list_size(list_bodies); j++){
-      if(body_is_removed(force_get_body(force_holder, j))) {
-        free = true;
-        break;
+static bool scene_bullet_hit(body_t *body, void *aux) {
+  bullet_query_t *query = aux;
+  // a pair of bullets is swept once, from the bullet with the smaller id
+  if (body != query->bullet && !body_is_removed(body)
+    && body_can_collide(query->bullet, body)
+    && !(body_is_bullet(body)
+      && body_get_id(body) < body_get_id(query->bullet))) {
+        query->time_of_impact = fmin(query->time_of_impact,
+          time_of_impact(query->bullet, body, query->dt));
+  }
+  return true;
+}
+
+/**
+Finds how long the scene can be integrated for before a bullet first hits
+another body, up to dt. Bullets are swept against the bodies near their path.
+*/
+static double scene_bullet_step(scene_t *scene, double dt) {
+  bullet_query_t query = {.dt = dt, .time_of_impact = dt};
+  for (size_t i = 0; i < scene_bodies(scene); i++) {
+    body_t *bullet = scene_get_body(scene, i);
+    if (!body_is_bullet(bullet) || body_is_removed(bullet)) {
+      continue;
+    }
+    query.bullet = bullet;
+    aabb_t box = body_get_aabb(bullet);
+    vector_t sweep = vec_multiply(dt, body_get_velocity(bullet));
+    aabb_t moved = {vec_add(box.min, sweep), vec_add(box.max, sweep)};
+    aabb_t path = aabb_union(box, moved);
+    if (scene->broadphase != NULL
+      && broadphase_query(scene->broadphase, path, scene_bullet_hit, &query)) {
+        continue;
+    }
+    for (size_t j = 0; j < scene_bodies(scene); j++) {
+      body_t *body = scene_get_body(scene, j);
+      if (aabb_overlap(path, body_get_aabb(body))) {
+        scene_bullet_hit(body, &query);
       }
     }
-    if(free) {
-      force_holder_t *removed = (force_holder_t *) list_remove(scene->scene_forces, i);
-      force_holder_free(removed);
-      i--;
-      free = false;
+  }
+  return query.time_of_impact;
+}
+
+/**
+Returns whether every body a force creator acts on is resting, in which case
+it is skipped. Creators that act on no bodies in particular always run.
+*/
+static bool scene_is_force_resting(scene_t *scene, force_holder_t *holder) {
+  list_t *bodies = force_get_all_bodies(holder);
+  if (!scene->sleeping || list_size(bodies) == 0) {
+    return false;
+  }
+  for (size_t i = 0; i < list_size(bodies); i++) {
+    if (!scene_is_resting(scene, list_get(bodies, i))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+Unlinks the dead holders in a body's holder list, keeping the others in order.
+*/
+static void scene_compact_holders(holder_list_t *list){
+  list_t *holders = list->holders;
+  size_t kept = 0;
+  for (size_t i = 0; i < list_size(holders); i++) {
+    force_holder_t *holder = list_get(holders, i);
+    if (holder->dead) {
+      force_holder_unlink(holder);
     }
+    else {
+      list_set(holders, kept++, holder);
+    }
+  }
+  // removing from the end moves nothing
+  while (list_size(holders) > kept) {
+    list_remove(holders, list_size(holders) - 1);
   }
+  list->dead = 0;
+}
 
-  for(int i = 0; i < scene_bodies(scene); i++) {
-    if(body_is_removed(scene_get_body(scene, i))) {
-      body_t *removed = (body_t *) list_remove(scene->bodies, i);
-      body_free(removed);
-      i--;
+/**
+Marks the force holders acting on a body as dead and frees the body's list
+of them. The holders stay in their other bodies' lists, which only count them
+as dead and are compacted once they are more than half dead, so removing a
+body costs time proportional to its own holders and their bodies.
+Returns whether any holder was marked.
+*/
+static bool scene_kill_holders(scene_t *scene, body_t *body){
+  uint64_t id = body_get_id(body);
+  holder_list_t *found = pair_map_get(scene->holders_of, id);
+  if (found == NULL) {
+    return false;
+  }
+  list_t *holders = found->holders;
+  pair_map_remove(scene->holders_of, id);
+  bool killed = false;
+  for (size_t i = 0; i < list_size(holders); i++) {
+    force_holder_t *holder = list_get(holders, i);
+    if (!holder->dead) {
+      holder->dead = true;
+      killed = true;
+      list_t *bodies = force_get_all_bodies(holder);
+      for (size_t j = 0; j < list_size(bodies); j++) {
+        body_t *other = list_get(bodies, j);
+        holder_list_t *others = other != body
+          ? pair_map_get(scene->holders_of, body_get_id(other)) : NULL;
+        if (others == NULL) {
+          continue;
+        }
+        others->dead++;
+        if (2 * others->dead > list_size(others->holders)) {
+          scene_compact_holders(others);
+        }
+      }
     }
+    force_holder_unlink(holder);
   }
+  list_free(holders);
+  return killed;
+}
 
-  for(size_t i = 0; i < scene_bodies(scene); i++) {
-     body_tick(scene_get_body(scene, i), dt);
-   }
+/**
+Drops the dead force holders, keeping the others in order, in one pass.
+Each is freed once no body's holder list points at it either.
+*/
+static void scene_drop_dead_forces(scene_t *scene){
+  list_t *forces = scene->scene_forces;
+  size_t kept = 0;
+  for (size_t i = 0; i < list_size(forces); i++) {
+    force_holder_t *holder = list_get(forces, i);
+    if (holder->dead) {
+      force_holder_unlink(holder);
+    }
+    else {
+      list_set(forces, kept++, holder);
+    }
+  }
+  // removing from the end moves nothing
+  while (list_size(forces) > kept) {
+    list_remove(forces, list_size(forces) - 1);
+  }
+}
+
+/**
+Keeps a copy of the force and torque on every body, so the later steps of a
+split tick can integrate them without running the force creators again.
+*/
+static void scene_save_forces(scene_t *scene){
+  size_t size = scene_bodies(scene);
+  if (size > scene->step_capacity) {
+    scene->step_capacity = 2 * size;
+    scene->step_forces = realloc(scene->step_forces,
+      scene->step_capacity * sizeof(vector_t));
+    scene->step_torques = realloc(scene->step_torques,
+      scene->step_capacity * sizeof(double));
+    assert(scene->step_forces != NULL);
+    assert(scene->step_torques != NULL);
+  }
+  for (size_t i = 0; i < size; i++) {
+    body_t *body = scene_get_body(scene, i);
+    scene->step_forces[i] = body_get_force(body);
+    scene->step_torques[i] = body_get_torque(body);
+  }
+  scene->step_count = size;
+}
+
+/**
+Puts back the forces and torques saved in the first step of the tick. Bodies
+added since then have none.
+*/
+static void scene_restore_forces(scene_t *scene){
+  for (size_t i = 0; i < scene->step_count; i++) {
+    body_t *body = scene_get_body(scene, i);
+    body_add_force(body, scene->step_forces[i]);
+    body_set_torque(body, scene->step_torques[i]);
+  }
+}
+
+/**
+Removes and frees the bodies marked for removal, along with everything the
+scene keeps about them, in one pass that keeps the other bodies (and their
+saved forces) in order.
+*/
+static void scene_remove_bodies(scene_t *scene){
+  list_t *bodies = scene->bodies;
+  size_t kept = 0;
+  size_t kept_saved = 0;
+  bool killed = false;
+  for (size_t i = 0; i < list_size(bodies); i++) {
+    body_t *body = list_get(bodies, i);
+    if (!body_is_removed(body)) {
+      if (i < scene->step_count) {
+        scene->step_forces[kept_saved] = scene->step_forces[i];
+        scene->step_torques[kept_saved] = scene->step_torques[i];
+        kept_saved++;
+      }
+      list_set(bodies, kept++, body);
+      continue;
+    }
+    if (scene->broadphase != NULL) {
+      broadphase_remove(scene->broadphase, body);
+    }
+    contact_cache_remove_body(scene->contacts, body);
+    scene_unregister_body(scene, body);
+    killed = scene_kill_holders(scene, body) || killed;
+    body_free(body);
+    scene->candidates_valid = false;
+  }
+  if (kept == list_size(bodies)) {
+    return;
+  }
+  scene->step_count = kept_saved;
+  // removing from the end moves nothing
+  while (list_size(bodies) > kept) {
+    list_remove(bodies, list_size(bodies) - 1);
+  }
+  if (killed) {
+    scene_drop_dead_forces(scene);
+  }
+}
+
+/**
+  Runs a scene's force creators, or in the later steps of a split tick puts
+  back the forces they gave in its first step. Then calls the collision
+  handlers and removes the bodies marked for removal, without moving anything.
+*/
+static void scene_apply_forces(scene_t *scene, bool first_step) {
+  scene_update_candidates(scene);
+
+  if (first_step) {
+    for (int i = 0; i < list_size(scene->scene_forces); i++) {
+      force_holder_t *force_holder = (force_holder_t *)list_get(scene->scene_forces, i);
+      if (!scene_is_force_resting(scene, force_holder)) {
+        get_force(force_holder)(force_get_aux(force_holder));
+      }
+    }
+    scene_save_forces(scene);
+  }
+  else {
+    scene_restore_forces(scene);
+  }
+  scene_apply_collisions(scene);
+  scene_remove_bodies(scene);
+}
+
+/**
+  Executes a tick of a given scene over a small time interval.
+  This requires ticking each body in the scene. When a bullet would hit
+  something during the tick, the tick is split at the time of impact so
+  the collision is handled before the bullet moves on. The force creators
+  only run in the first step; the later ones integrate the same forces.
+*/
+void scene_tick(scene_t *scene, double dt) {
+  double remaining = dt;
+  size_t step = 1;
+  do {
+    // bodies may have been moved by hand since the last step
+    if (!scene_is_settled(scene)) {
+      scene->candidates_valid = false;
+    }
+    scene_apply_forces(scene, step == 1);
+    double step_dt = remaining;
+    if (step < CCD_MAX_SUBSTEPS) {
+      step_dt = scene_bullet_step(scene, remaining);
+    }
+    bool moving = !scene_is_settled(scene);
+    scene_integrate(scene, step_dt);
+    scene_update_sleep(scene, step_dt);
+    // the bodies moved, so every pair has to be tested again
+    contact_cache_tick(scene->contacts);
+    if (moving) {
+      scene->candidates_valid = false;
+    }
+    remaining -= step_dt;
+    step++;
+  } while (remaining > 0);
 }
@@ -219,6 +219,99 @@ void sdl_draw_polygon(list_t *points, rgb_color_t color) {
     free(y_points);
 }
 
+/**
+ * Scratch arrays of pixel coordinates reused by sdl_draw_shape(),
+ * so drawing a body does not allocate once they are large enough.
+ */
+int16_t *shape_x_points = NULL;
+int16_t *shape_y_points = NULL;
+size_t shape_points_capacity = 0;
+
+void sdl_draw_shape(const shape_t *shape, rgb_color_t color) {
+    // Check parameters
+    size_t n = shape->size;
+    assert(n >= 3);
+    assert(0 <= color.r && color.r <= 1);
+    assert(0 <= color.g && color.g <= 1);
+    assert(0 <= color.b && color.b <= 1);
+    assert((0 <= color.op && color.op <= 1));
+
+    if (n > shape_points_capacity) {
+        shape_x_points = realloc(shape_x_points, sizeof(*shape_x_points) * n);
+        shape_y_points = realloc(shape_y_points, sizeof(*shape_y_points) * n);
+        assert(shape_x_points != NULL);
+        assert(shape_y_points != NULL);
+        shape_points_capacity = n;
+    }
+
+    vector_t window_center = get_window_center();
+
+    // Convert each vertex to a point on screen
+    for (size_t i = 0; i < n; i++) {
+        vector_t pixel = get_window_position(shape->points[i], window_center);
+        shape_x_points[i] = pixel.x;
+        shape_y_points[i] = pixel.y;
+    }
+
+    // Draw polygon with the given color
+    filledPolygonRGBA(
+        renderer,
+        shape_x_points, shape_y_points, n,
+        color.r * 255, color.g * 255, color.b * 255, color.op * 255
+    );
+}
+
+void sdl_draw_body(body_t *body) {
+    if (body_get_kind(body) == BODY_POLYGON) {
+        sdl_draw_shape(body_get_shape_view(body), body_get_color(body));
+        return;
+    }
+    rgb_color_t color = body_get_color(body);
+    vector_t window_center = get_window_center();
+    double scale = get_scene_scale(window_center);
+    double radius = body_get_radius(body);
+    const shape_t *core = body_get_shape_view(body);
+    int16_t pixel_radius = round(radius * scale);
+
+    // Draw a circle at each end of the core (only one for circles)
+    for (size_t i = 0; i < core->size; i++) {
+        vector_t pixel = get_window_position(core->points[i], window_center);
+        filledCircleRGBA(
+            renderer,
+            pixel.x, pixel.y, pixel_radius,
+            color.r * 255, color.g * 255, color.b * 255, color.op * 255
+        );
+    }
+    if (core->size < 2) {
+        return;
+    }
+
+    // Join a capsule's end caps with a rectangle
+    vector_t start = core->points[0];
+    vector_t end = core->points[1];
+    vector_t side = vec_subtract(end, start);
+    double length = vec_magnitude(side);
+    if (length == 0) {
+        return;
+    }
+    side = vec_multiply(radius / length, vec_init(-side.y, side.x));
+    vector_t corners[] = {
+        vec_add(start, side), vec_subtract(start, side),
+        vec_subtract(end, side), vec_add(end, side)
+    };
+    int16_t x_points[4], y_points[4];
+    for (size_t i = 0; i < 4; i++) {
+        vector_t pixel = get_window_position(corners[i], window_center);
+        x_points[i] = pixel.x;
+        y_points[i] = pixel.y;
+    }
+    filledPolygonRGBA(
+        renderer,
+        x_points, y_points, 4,
+        color.r * 255, color.g * 255, color.b * 255, color.op * 255
+    );
+}
+
 void sdl_show(void) {
     // Draw boundary lines
     vector_t window_center = get_window_center();
@@ -242,9 +335,7 @@ void sdl_render_scene(scene_t *scene) {
     size_t body_count = scene_bodies(scene);
     for (size_t i = 0; i < body_count; i++) {
         body_t *body = scene_get_body(scene, i);
-        list_t *shape = body_get_shape(body);
-        sdl_draw_polygon(shape, body_get_color(body));
-        list_free(shape);
+        sdl_draw_body(body);
     }
     sdl_show();
 }
@@ -290,13 +381,13 @@ SDL_Texture *sdl_make_image(SDL_Surface *image) {
 }
 
 void sdl_put_image_on_body(SDL_Texture *image_texture, body_t *body) {
-  list_t *list_of_points = body_get_shape(body);
+  aabb_t box = body_get_aabb(body);
   SDL_Rect textRect;
 
-  textRect.x = (*(vector_t *)list_get(list_of_points, 3)).x;
-  textRect.y = WINDOW_HEIGHT - (*(vector_t *)list_get(list_of_points, 2)).y;
-  textRect.w = (*(vector_t *)list_get(list_of_points, 1)).x - (*(vector_t *)list_get(list_of_points, 0)).x;
-  textRect.h = (*(vector_t *)list_get(list_of_points, 2)).y - (*(vector_t *)list_get(list_of_points, 1)).y;
+  textRect.x = box.min.x;
+  textRect.y = WINDOW_HEIGHT - box.max.y;
+  textRect.w = box.max.x - box.min.x;
+  textRect.h = box.max.y - box.min.y;
 
   SDL_RenderCopy(renderer, image_texture, NULL, &textRect);
 }
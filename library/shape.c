@@ -0,0 +1,59 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "shape.h"
+
+/**
+Allocates a shape with room for size vertices, all set to (0, 0).
+*/
+shape_t *shape_init(size_t size) {
+  shape_t *shape = malloc(sizeof(shape_t) + size * sizeof(vector_t));
+  assert(shape != NULL);
+  shape->size = size;
+  for (size_t i = 0; i < size; i++) {
+    shape->points[i] = VEC_ZERO;
+  }
+  return shape;
+}
+
+/**
+Copies the vertices of a vector list into a new shape.
+*/
+shape_t *shape_from_list(list_t *points) {
+  size_t size = list_size(points);
+  shape_t *shape = shape_init(size);
+  for (size_t i = 0; i < size; i++) {
+    shape->points[i] = *(vector_t *) list_get(points, i);
+  }
+  return shape;
+}
+
+/**
+Copies a shape.
+*/
+shape_t *shape_copy(const shape_t *shape) {
+  size_t bytes = sizeof(shape_t) + shape->size * sizeof(vector_t);
+  shape_t *copy = malloc(bytes);
+  assert(copy != NULL);
+  memcpy(copy, shape, bytes);
+  return copy;
+}
+
+/**
+Copies the vertices of a shape into a new vector list.
+*/
+list_t *shape_to_list(const shape_t *shape) {
+  list_t *points = list_init(shape->size, (free_func_t) vec_free);
+  for (size_t i = 0; i < shape->size; i++) {
+    list_add(points, vec_init_pointer(shape->points[i].x, shape->points[i].y));
+  }
+  return points;
+}
+
+/**
+Releases the memory allocated for a shape.
+*/
+void shape_free(shape_t *shape) {
+  free(shape);
+}
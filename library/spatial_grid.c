@@ -0,0 +1,244 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <math.h>
+#include "spatial_grid.h"
+#include "aabb.h"
+
+const size_t GRID_INIT_SIZE = 16;
+// Bodies whose box spans more cells than this are not binned
+const double GRID_MAX_CELLS = 64;
+
+typedef struct grid_proxy {
+  body_t *body;
+  aabb_t box;
+  bool oversized;
+} grid_proxy_t;
+
+/**
+Where a cell's proxies are in the entries array.
+*/
+typedef struct grid_cell {
+  size_t start;
+  size_t count;
+} grid_cell_t;
+
+typedef struct spatial_grid {
+  grid_proxy_t *proxies;
+  size_t size;
+  size_t capacity;
+  // body id -> index in proxies
+  pair_map_t *proxy_of;
+  // cell coordinates -> grid_cell_t, rebuilt every tick
+  pair_map_t *cells;
+  // proxy indices grouped by cell
+  size_t *entries;
+  size_t entries_capacity;
+  // scratch space for the median extent and the oversized proxies
+  double *extents;
+  size_t *oversized;
+  double cell_size;
+  bool cell_size_valid;
+} spatial_grid_t;
+
+static void grid_alloc(spatial_grid_t *grid, size_t capacity) {
+  grid->proxies = realloc(grid->proxies, capacity * sizeof(grid_proxy_t));
+  assert(grid->proxies != NULL);
+  grid->extents = realloc(grid->extents, capacity * sizeof(double));
+  assert(grid->extents != NULL);
+  grid->oversized = realloc(grid->oversized, capacity * sizeof(size_t));
+  assert(grid->oversized != NULL);
+  grid->capacity = capacity;
+}
+
+static void grid_free(spatial_grid_t *grid) {
+  free(grid->proxies);
+  free(grid->extents);
+  free(grid->oversized);
+  free(grid->entries);
+  pair_map_free(grid->proxy_of);
+  pair_map_free(grid->cells);
+  free(grid);
+}
+
+static void grid_add(spatial_grid_t *grid, body_t *body) {
+  if (grid->size == grid->capacity) {
+    grid_alloc(grid, 2 * grid->capacity);
+  }
+  size_t index = grid->size++;
+  grid->proxies[index] = (grid_proxy_t) {body, body_get_aabb(body), false};
+  *(size_t *) pair_map_put(grid->proxy_of, body_get_id(body)) = index;
+  grid->cell_size_valid = false;
+}
+
+static void grid_remove(spatial_grid_t *grid, body_t *body) {
+  size_t *found = pair_map_get(grid->proxy_of, body_get_id(body));
+  assert(found != NULL);
+  size_t index = *found;
+  pair_map_remove(grid->proxy_of, body_get_id(body));
+  size_t last = --grid->size;
+  if (index != last) {
+    grid->proxies[index] = grid->proxies[last];
+    *(size_t *) pair_map_get(grid->proxy_of,
+      body_get_id(grid->proxies[index].body)) = index;
+  }
+  grid->cell_size_valid = false;
+}
+
+static int compare_doubles(const void *a, const void *b) {
+  double x = *(const double *) a;
+  double y = *(const double *) b;
+  return (x > y) - (x < y);
+}
+
+/**
+Sizes cells from the median of the bodies' larger box dimension.
+Only recomputed when bodies are added or removed.
+*/
+static void grid_update_cell_size(spatial_grid_t *grid) {
+  if (grid->cell_size_valid || grid->size == 0) {
+    return;
+  }
+  for (size_t i = 0; i < grid->size; i++) {
+    aabb_t box = grid->proxies[i].box;
+    grid->extents[i] = fmax(box.max.x - box.min.x, box.max.y - box.min.y);
+  }
+  qsort(grid->extents, grid->size, sizeof(double), compare_doubles);
+  grid->cell_size = grid->extents[grid->size / 2];
+  if (grid->cell_size <= 0) {
+    grid->cell_size = 1;
+  }
+  grid->cell_size_valid = true;
+}
+
+static uint64_t grid_cell_key(long x, long y) {
+  return ((uint64_t) (uint32_t) x << 32) | (uint32_t) y;
+}
+
+/**
+Visits each cell a proxy's box touches. With fill false it counts the proxy
+in each cell; with fill true it writes the proxy into the cell's entries.
+*/
+static void grid_bin(spatial_grid_t *grid, size_t index, bool fill) {
+  aabb_t box = grid->proxies[index].box;
+  long min_x = (long) floor(box.min.x / grid->cell_size);
+  long max_x = (long) floor(box.max.x / grid->cell_size);
+  long min_y = (long) floor(box.min.y / grid->cell_size);
+  long max_y = (long) floor(box.max.y / grid->cell_size);
+  for (long x = min_x; x <= max_x; x++) {
+    for (long y = min_y; y <= max_y; y++) {
+      grid_cell_t *cell = pair_map_put(grid->cells, grid_cell_key(x, y));
+      if (fill) {
+        grid->entries[cell->start + cell->count] = index;
+      }
+      cell->count++;
+    }
+  }
+}
+
+/**
+Bins every body into its cells, then compares bodies within each cell.
+*/
+static void grid_find_pairs(spatial_grid_t *grid, pair_map_t *pairs) {
+  for (size_t i = 0; i < grid->size; i++) {
+    grid->proxies[i].box = body_get_aabb(grid->proxies[i].body);
+  }
+  grid_update_cell_size(grid);
+
+  // Count how many entries each cell needs
+  pair_map_clear(grid->cells);
+  size_t oversized_count = 0;
+  size_t total = 0;
+  for (size_t i = 0; i < grid->size; i++) {
+    grid_proxy_t *proxy = &grid->proxies[i];
+    aabb_t box = proxy->box;
+    double cells = (floor(box.max.x / grid->cell_size) -
+      floor(box.min.x / grid->cell_size) + 1) *
+      (floor(box.max.y / grid->cell_size) -
+      floor(box.min.y / grid->cell_size) + 1);
+    proxy->oversized = cells > GRID_MAX_CELLS;
+    if (proxy->oversized) {
+      grid->oversized[oversized_count++] = i;
+    }
+    else {
+      grid_bin(grid, i, false);
+      total += (size_t) cells;
+    }
+  }
+
+  // Give each cell its range of the entries array, then fill the ranges
+  if (total > grid->entries_capacity) {
+    grid->entries = realloc(grid->entries, total * sizeof(size_t));
+    assert(grid->entries != NULL);
+    grid->entries_capacity = total;
+  }
+  size_t start = 0;
+  for (size_t i = 0; i < pair_map_capacity(grid->cells); i++) {
+    void *value;
+    if (pair_map_slot(grid->cells, i, NULL, &value)) {
+      grid_cell_t *cell = value;
+      cell->start = start;
+      start += cell->count;
+      cell->count = 0;
+    }
+  }
+  for (size_t i = 0; i < grid->size; i++) {
+    if (!grid->proxies[i].oversized) {
+      grid_bin(grid, i, true);
+    }
+  }
+
+  for (size_t i = 0; i < pair_map_capacity(grid->cells); i++) {
+    void *value;
+    if (!pair_map_slot(grid->cells, i, NULL, &value)) {
+      continue;
+    }
+    grid_cell_t *cell = value;
+    size_t *entries = grid->entries + cell->start;
+    for (size_t a = 0; a < cell->count; a++) {
+      grid_proxy_t *proxy = &grid->proxies[entries[a]];
+      for (size_t b = a + 1; b < cell->count; b++) {
+        grid_proxy_t *other = &grid->proxies[entries[b]];
+        if (aabb_overlap(proxy->box, other->box)) {
+          broadphase_add_pair(pairs, proxy->body, other->body);
+        }
+      }
+    }
+  }
+
+  for (size_t i = 0; i < oversized_count; i++) {
+    grid_proxy_t *proxy = &grid->proxies[grid->oversized[i]];
+    for (size_t j = 0; j < grid->size; j++) {
+      grid_proxy_t *other = &grid->proxies[j];
+      // Pairs of oversized bodies are only checked from the first of them
+      if (other == proxy || (other->oversized && j < grid->oversized[i])) {
+        continue;
+      }
+      if (aabb_overlap(proxy->box, other->box)) {
+        broadphase_add_pair(pairs, proxy->body, other->body);
+      }
+    }
+  }
+}
+
+/**
+Allocates an empty spatial hash grid broadphase.
+*/
+broadphase_t *spatial_grid_init(void) {
+  spatial_grid_t *grid = malloc(sizeof(spatial_grid_t));
+  assert(grid != NULL);
+  grid->proxies = NULL;
+  grid->extents = NULL;
+  grid->oversized = NULL;
+  grid->size = 0;
+  grid_alloc(grid, GRID_INIT_SIZE);
+  grid->proxy_of = pair_map_init(GRID_INIT_SIZE, sizeof(size_t));
+  grid->cells = pair_map_init(GRID_INIT_SIZE, sizeof(grid_cell_t));
+  grid->entries = NULL;
+  grid->entries_capacity = 0;
+  grid->cell_size = 1;
+  grid->cell_size_valid = false;
+  return broadphase_init(grid, (broadphase_add_t) grid_add,
+    (broadphase_remove_t) grid_remove, (broadphase_pairs_t) grid_find_pairs,
+    (free_func_t) grid_free);
+}
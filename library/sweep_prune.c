@@ -0,0 +1,170 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "sweep_prune.h"
+#include "aabb.h"
+
+const size_t SAP_INIT_SIZE = 16;
+
+typedef struct sap_proxy {
+  body_t *body;
+  aabb_t box;
+} sap_proxy_t;
+
+/**
+One end of a body's x extent. The proxy index says whose it is.
+*/
+typedef struct sap_endpoint {
+  double value;
+  size_t proxy;
+  bool is_min;
+} sap_endpoint_t;
+
+typedef struct sweep_prune {
+  sap_proxy_t *proxies;
+  size_t size;
+  size_t capacity;
+  // 2 * size endpoints, sorted by value after each sap_find_pairs()
+  sap_endpoint_t *endpoints;
+  // body id -> index in proxies
+  pair_map_t *proxy_of;
+  // proxies whose x extent contains the sweep position
+  size_t *active;
+} sweep_prune_t;
+
+static void sap_alloc(sweep_prune_t *sap, size_t capacity) {
+  sap->proxies = realloc(sap->proxies, capacity * sizeof(sap_proxy_t));
+  assert(sap->proxies != NULL);
+  sap->endpoints = realloc(sap->endpoints,
+    2 * capacity * sizeof(sap_endpoint_t));
+  assert(sap->endpoints != NULL);
+  sap->active = realloc(sap->active, capacity * sizeof(size_t));
+  assert(sap->active != NULL);
+  sap->capacity = capacity;
+}
+
+static void sap_free(sweep_prune_t *sap) {
+  free(sap->proxies);
+  free(sap->endpoints);
+  free(sap->active);
+  pair_map_free(sap->proxy_of);
+  free(sap);
+}
+
+/**
+Appends a body's endpoints at the end of the list; the next sort moves them
+into place.
+*/
+static void sap_add(sweep_prune_t *sap, body_t *body) {
+  if (sap->size == sap->capacity) {
+    sap_alloc(sap, 2 * sap->capacity);
+  }
+  size_t index = sap->size++;
+  aabb_t box = body_get_aabb(body);
+  sap->proxies[index] = (sap_proxy_t) {body, box};
+  sap->endpoints[2 * index] = (sap_endpoint_t) {box.min.x, index, true};
+  sap->endpoints[2 * index + 1] = (sap_endpoint_t) {box.max.x, index, false};
+  *(size_t *) pair_map_put(sap->proxy_of, body_get_id(body)) = index;
+}
+
+/**
+Removes a body's endpoints, keeping the rest in order, and moves the last
+proxy into the freed index.
+*/
+static void sap_remove(sweep_prune_t *sap, body_t *body) {
+  size_t *found = pair_map_get(sap->proxy_of, body_get_id(body));
+  assert(found != NULL);
+  size_t index = *found;
+  pair_map_remove(sap->proxy_of, body_get_id(body));
+  size_t last = --sap->size;
+
+  size_t kept = 0;
+  for (size_t i = 0; i < 2 * (sap->size + 1); i++) {
+    sap_endpoint_t endpoint = sap->endpoints[i];
+    if (endpoint.proxy == index) {
+      continue;
+    }
+    if (endpoint.proxy == last) {
+      endpoint.proxy = index;
+    }
+    sap->endpoints[kept++] = endpoint;
+  }
+
+  if (index != last) {
+    sap->proxies[index] = sap->proxies[last];
+    *(size_t *) pair_map_get(sap->proxy_of,
+      body_get_id(sap->proxies[index].body)) = index;
+  }
+}
+
+static bool sap_before(sap_endpoint_t a, sap_endpoint_t b) {
+  // At equal values minimums go first, so touching boxes count as overlapping
+  return a.value < b.value || (a.value == b.value && a.is_min && !b.is_min);
+}
+
+/**
+Refreshes every box, re-sorts the endpoints and sweeps them for overlaps.
+*/
+static void sap_find_pairs(sweep_prune_t *sap, pair_map_t *pairs) {
+  for (size_t i = 0; i < sap->size; i++) {
+    sap->proxies[i].box = body_get_aabb(sap->proxies[i].body);
+  }
+  size_t count = 2 * sap->size;
+  for (size_t i = 0; i < count; i++) {
+    sap_endpoint_t *endpoint = &sap->endpoints[i];
+    aabb_t box = sap->proxies[endpoint->proxy].box;
+    endpoint->value = endpoint->is_min ? box.min.x : box.max.x;
+  }
+
+  // Insertion sort: the list was sorted last tick, so few endpoints move
+  for (size_t i = 1; i < count; i++) {
+    sap_endpoint_t endpoint = sap->endpoints[i];
+    size_t j = i;
+    while (j > 0 && sap_before(endpoint, sap->endpoints[j - 1])) {
+      sap->endpoints[j] = sap->endpoints[j - 1];
+      j--;
+    }
+    sap->endpoints[j] = endpoint;
+  }
+
+  size_t active_size = 0;
+  for (size_t i = 0; i < count; i++) {
+    sap_endpoint_t endpoint = sap->endpoints[i];
+    if (endpoint.is_min) {
+      sap_proxy_t *proxy = &sap->proxies[endpoint.proxy];
+      for (size_t j = 0; j < active_size; j++) {
+        sap_proxy_t *other = &sap->proxies[sap->active[j]];
+        if (proxy->box.min.y <= other->box.max.y &&
+            other->box.min.y <= proxy->box.max.y) {
+          broadphase_add_pair(pairs, other->body, proxy->body);
+        }
+      }
+      sap->active[active_size++] = endpoint.proxy;
+    }
+    else {
+      for (size_t j = 0; j < active_size; j++) {
+        if (sap->active[j] == endpoint.proxy) {
+          sap->active[j] = sap->active[--active_size];
+          break;
+        }
+      }
+    }
+  }
+}
+
+/**
+Allocates an empty sweep-and-prune broadphase.
+*/
+broadphase_t *sweep_prune_init(void) {
+  sweep_prune_t *sap = malloc(sizeof(sweep_prune_t));
+  assert(sap != NULL);
+  sap->proxies = NULL;
+  sap->endpoints = NULL;
+  sap->active = NULL;
+  sap->size = 0;
+  sap_alloc(sap, SAP_INIT_SIZE);
+  sap->proxy_of = pair_map_init(SAP_INIT_SIZE, sizeof(size_t));
+  return broadphase_init(sap, (broadphase_add_t) sap_add,
+    (broadphase_remove_t) sap_remove, (broadphase_pairs_t) sap_find_pairs,
+    (free_func_t) sap_free);
+}
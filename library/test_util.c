@@ -9,6 +9,10 @@
 #include <unistd.h>
 
 #define DEFAULT_EPSILON 1e-7
+#define BRUTE_FORCE_BODIES 120
+#define BRUTE_FORCE_TICKS 30
+
+const rgb_color_t TEST_COLOR = {0, 0, 0, 1};
 
 bool isclose(double d1, double d2) {
     return within(DEFAULT_EPSILON, d1, d2);
@@ -58,3 +62,133 @@ bool test_assert_fail(void (*run)(void *aux), void *aux) {
         exit(0); // should not be reached
     }
 }
+
+double random_between(double min, double max) {
+    return min + (max - min) * rand() / RAND_MAX;
+}
+
+aabb_t make_aabb(double min_x, double min_y, double max_x, double max_y) {
+    return (aabb_t) {vec_init(min_x, min_y), vec_init(max_x, max_y)};
+}
+
+shape_t *make_box_shape(vector_t center, double width, double height) {
+    shape_t *shape = shape_init(4);
+    shape->points[0] = vec_init(center.x - width / 2, center.y - height / 2);
+    shape->points[1] = vec_init(center.x + width / 2, center.y - height / 2);
+    shape->points[2] = vec_init(center.x + width / 2, center.y + height / 2);
+    shape->points[3] = vec_init(center.x - width / 2, center.y + height / 2);
+    return shape;
+}
+
+body_t *make_box(vector_t center, double width, double height, double mass) {
+    return body_init_with_shape(make_box_shape(center, width, height), mass,
+        TEST_COLOR, NULL, NULL);
+}
+
+body_t *make_circle(vector_t center, double radius, double mass) {
+    return body_init_circle(center, radius, mass, TEST_COLOR, NULL, NULL);
+}
+
+body_t *make_star(vector_t center, size_t points, double outer, double inner,
+    double angle) {
+    size_t size = inner == outer ? points : 2 * points;
+    shape_t *shape = shape_init(size);
+    for (size_t i = 0; i < size; i++) {
+        double radius = i % 2 == 0 || inner == outer ? outer : inner;
+        double theta = angle + 2 * M_PI * i / size;
+        shape->points[i] = vec_add(center,
+            vec_init(radius * cos(theta), radius * sin(theta)));
+    }
+    return body_init_with_shape(shape, 1, TEST_COLOR, NULL, NULL);
+}
+
+// A floor and a wall, then boxes and circles of mixed sizes, a few of which
+// only collide with the floor and wall
+static body_t *make_scattered_body(size_t i) {
+    if (i == 0) {
+        return make_box(vec_init(100, -2), 400, 4, 1);
+    }
+    if (i == 1) {
+        return make_box(vec_init(-2, 50), 4, 400, 1);
+    }
+    vector_t center = vec_init(random_between(0, 200), random_between(0, 100));
+    body_t *body = i % 2 == 0
+        ? make_box(center, random_between(1, 6), random_between(1, 6), 1)
+        : make_circle(center, random_between(0.5, 3), 1);
+    if (i % 10 == 3) {
+        body_set_collision_filter(body, 1 << 1, 1 << 0);
+    }
+    return body;
+}
+
+static void check_pairs(body_t **bodies, bool *tracked, pair_map_t *pairs,
+    bool exact) {
+    size_t expected = 0;
+    for (size_t i = 0; i < BRUTE_FORCE_BODIES; i++) {
+        for (size_t j = i + 1; j < BRUTE_FORCE_BODIES; j++) {
+            if (!tracked[i] || !tracked[j]
+                || !aabb_overlap(body_get_aabb(bodies[i]),
+                    body_get_aabb(bodies[j]))
+                || !body_can_collide(bodies[i], bodies[j])) {
+                continue;
+            }
+            expected++;
+            body_pair_t *pair = pair_map_get(pairs,
+                pair_key(body_get_id(bodies[i]), body_get_id(bodies[j])));
+            assert(pair != NULL);
+            assert((pair->body1 == bodies[i] && pair->body2 == bodies[j])
+                || (pair->body1 == bodies[j] && pair->body2 == bodies[i]));
+        }
+    }
+    assert(exact ? pair_map_size(pairs) == expected
+        : pair_map_size(pairs) >= expected);
+    for (size_t i = 0; i < pair_map_capacity(pairs); i++) {
+        void *value;
+        if (pair_map_slot(pairs, i, NULL, &value)) {
+            body_pair_t *pair = value;
+            assert(body_can_collide(pair->body1, pair->body2));
+        }
+    }
+}
+
+void check_broadphase_brute_force(broadphase_t *broadphase, bool exact) {
+    srand(6);
+    body_t *bodies[BRUTE_FORCE_BODIES];
+    bool tracked[BRUTE_FORCE_BODIES];
+    for (size_t i = 0; i < BRUTE_FORCE_BODIES; i++) {
+        bodies[i] = make_scattered_body(i);
+        broadphase_add(broadphase, bodies[i]);
+        tracked[i] = true;
+    }
+    pair_map_t *pairs = pair_map_init(0, sizeof(body_pair_t));
+    for (size_t tick = 0; tick < BRUTE_FORCE_TICKS; tick++) {
+        // most bodies drift, a few jump across the scene
+        for (size_t i = 2; i < BRUTE_FORCE_BODIES; i++) {
+            vector_t move = i % 17 == tick % 17
+                ? vec_init(random_between(-80, 80), random_between(-40, 40))
+                : vec_init(random_between(-2, 2), random_between(-2, 2));
+            body_set_centroid(bodies[i],
+                vec_add(body_get_centroid(bodies[i]), move));
+        }
+        // bodies leave and come back
+        size_t toggled = 2 + (tick * 7) % (BRUTE_FORCE_BODIES - 2);
+        if (tracked[toggled]) {
+            broadphase_remove(broadphase, bodies[toggled]);
+        }
+        else {
+            broadphase_add(broadphase, bodies[toggled]);
+        }
+        tracked[toggled] = !tracked[toggled];
+
+        pair_map_clear(pairs);
+        broadphase_find_pairs(broadphase, pairs);
+        check_pairs(bodies, tracked, pairs, exact);
+    }
+    pair_map_free(pairs);
+    for (size_t i = 0; i < BRUTE_FORCE_BODIES; i++) {
+        if (tracked[i]) {
+            broadphase_remove(broadphase, bodies[i]);
+        }
+        body_free(bodies[i]);
+    }
+}
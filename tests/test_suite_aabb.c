@@ -0,0 +1,83 @@
+#include "aabb.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+void test_aabb_of_shape() {
+    shape_t *shape = shape_init(4);
+    shape->points[0] = vec_init(1, -2);
+    shape->points[1] = vec_init(4, 0);
+    shape->points[2] = vec_init(2, 3);
+    shape->points[3] = vec_init(-1, 1);
+    aabb_t box = aabb_of_shape(shape);
+    assert(vec_equal(box.min, vec_init(-1, -2)));
+    assert(vec_equal(box.max, vec_init(4, 3)));
+    shape_free(shape);
+
+    // a single point, e.g. the core of a circle, has an empty box
+    shape = shape_init(1);
+    shape->points[0] = vec_init(5, 6);
+    box = aabb_of_shape(shape);
+    assert(vec_equal(box.min, vec_init(5, 6)));
+    assert(vec_equal(box.max, vec_init(5, 6)));
+    shape_free(shape);
+}
+
+void test_aabb_overlap() {
+    aabb_t box = make_aabb(0, 0, 2, 2);
+    assert(aabb_overlap(box, make_aabb(1, 1, 3, 3)));
+    assert(aabb_overlap(box, make_aabb(0.5, 0.5, 1, 1)));
+    assert(aabb_overlap(make_aabb(0.5, 0.5, 1, 1), box));
+    assert(aabb_overlap(box, make_aabb(-1, 0.5, 3, 1)));
+    // touching counts
+    assert(aabb_overlap(box, make_aabb(2, 0, 3, 2)));
+    assert(aabb_overlap(box, make_aabb(2, 2, 3, 3)));
+    // apart along either axis
+    assert(!aabb_overlap(box, make_aabb(2.1, 0, 3, 2)));
+    assert(!aabb_overlap(box, make_aabb(0, -1, 2, -0.1)));
+    assert(!aabb_overlap(box, make_aabb(3, 3, 4, 4)));
+}
+
+void test_aabb_contains() {
+    aabb_t box = make_aabb(0, 0, 2, 2);
+    assert(aabb_contains(box, box));
+    assert(aabb_contains(box, make_aabb(0.5, 0.5, 1, 2)));
+    assert(!aabb_contains(box, make_aabb(0.5, 0.5, 1, 2.5)));
+    assert(!aabb_contains(make_aabb(0.5, 0.5, 1, 1), box));
+}
+
+void test_aabb_union() {
+    aabb_t box = aabb_union(make_aabb(0, 0, 1, 1), make_aabb(3, -2, 4, 0.5));
+    assert(vec_equal(box.min, vec_init(0, -2)));
+    assert(vec_equal(box.max, vec_init(4, 1)));
+    box = aabb_union(make_aabb(0, 0, 4, 4), make_aabb(1, 1, 2, 2));
+    assert(vec_equal(box.min, vec_init(0, 0)));
+    assert(vec_equal(box.max, vec_init(4, 4)));
+}
+
+void test_aabb_fatten_perimeter() {
+    aabb_t box = aabb_fatten(make_aabb(0, 0, 2, 1), 0.5);
+    assert(vec_equal(box.min, vec_init(-0.5, -0.5)));
+    assert(vec_equal(box.max, vec_init(2.5, 1.5)));
+    assert(isclose(aabb_perimeter(make_aabb(0, 0, 2, 1)), 6));
+    assert(isclose(aabb_perimeter(box), 10));
+}
+
+int main(int argc, char *argv[]) {
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests) {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_aabb_of_shape)
+    DO_TEST(test_aabb_overlap)
+    DO_TEST(test_aabb_contains)
+    DO_TEST(test_aabb_union)
+    DO_TEST(test_aabb_fatten_perimeter)
+
+    puts("aabb_test PASS");
+}
@@ -0,0 +1,210 @@
+#include "aabb_tree.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TREE_TEST_LEAVES 1024
+
+aabb_t random_aabb() {
+    vector_t min = vec_init(random_between(0, 200), random_between(0, 100));
+    return (aabb_t) {min, vec_add(min,
+        vec_init(random_between(0.5, 5), random_between(0.5, 5)))};
+}
+
+bool mark_found(void *data, void *aux) {
+    ((bool *) aux)[*(size_t *) data] = true;
+    return true;
+}
+
+// Checks that a region query finds exactly the leaves whose fat boxes
+// overlap the region, which only holds if every inner box still covers its
+// children
+void check_query(aabb_tree_t *tree, size_t *leaves, size_t *ids,
+    bool *inserted, size_t count, aabb_t region) {
+    bool found[TREE_TEST_LEAVES] = {false};
+    aabb_tree_query(tree, region, mark_found, found);
+    for (size_t i = 0; i < count; i++) {
+        bool expected = inserted[i]
+            && aabb_overlap(aabb_tree_get_box(tree, leaves[i]), region);
+        assert(found[i] == expected);
+        assert(!inserted[i] || aabb_tree_get_data(tree, leaves[i]) == &ids[i]);
+    }
+}
+
+void test_aabb_tree_move() {
+    aabb_tree_t *tree = aabb_tree_init(0.5);
+    size_t ids[2] = {0, 1};
+    size_t leaf = aabb_tree_insert(tree, make_aabb(0, 0, 1, 1), &ids[0]);
+    aabb_tree_insert(tree, make_aabb(5, 5, 6, 6), &ids[1]);
+    aabb_t fat = aabb_tree_get_box(tree, leaf);
+    assert(vec_equal(fat.min, vec_init(-0.5, -0.5)));
+    assert(vec_equal(fat.max, vec_init(1.5, 1.5)));
+
+    // moving within the fat box keeps the leaf where it is
+    assert(!aabb_tree_move(tree, leaf, make_aabb(0.3, -0.4, 1.3, 0.6)));
+    assert(vec_equal(aabb_tree_get_box(tree, leaf).min, fat.min));
+    // leaving it fattens the new box
+    assert(aabb_tree_move(tree, leaf, make_aabb(0.3, 0.7, 1.3, 1.7)));
+    fat = aabb_tree_get_box(tree, leaf);
+    assert(vec_isclose(fat.min, vec_init(-0.2, 0.2)));
+    assert(vec_isclose(fat.max, vec_init(1.8, 2.2)));
+    assert(aabb_tree_get_data(tree, leaf) == &ids[0]);
+
+    aabb_tree_remove(tree, leaf);
+    assert(aabb_tree_height(tree) == 0);
+    aabb_tree_free(tree);
+}
+
+void test_aabb_tree_balance() {
+    // leaves inserted in order along a line make an unrotated tree a chain
+    aabb_tree_t *tree = aabb_tree_init(0);
+    size_t ids[TREE_TEST_LEAVES];
+    size_t leaves[TREE_TEST_LEAVES];
+    bool inserted[TREE_TEST_LEAVES];
+    for (size_t i = 0; i < TREE_TEST_LEAVES; i++) {
+        ids[i] = i;
+        leaves[i] = aabb_tree_insert(tree, make_aabb(i, 0, i + 1, 1), &ids[i]);
+        inserted[i] = true;
+    }
+    // log2(TREE_TEST_LEAVES) is 10
+    assert(aabb_tree_height(tree) <= 20);
+    for (size_t i = 0; i < TREE_TEST_LEAVES; i += 2) {
+        aabb_tree_remove(tree, leaves[i]);
+        inserted[i] = false;
+    }
+    assert(aabb_tree_height(tree) <= 18);
+    check_query(tree, leaves, ids, inserted, TREE_TEST_LEAVES,
+        make_aabb(100.5, 0, 200.5, 1));
+    aabb_tree_free(tree);
+}
+
+void test_aabb_tree_refit() {
+    // leaves keep leaving their fat boxes, so they are removed and inserted
+    // again; queries only stay right if the inner boxes are refit each time
+    srand(8);
+    aabb_tree_t *tree = aabb_tree_init(1);
+    size_t ids[TREE_TEST_LEAVES];
+    size_t leaves[TREE_TEST_LEAVES];
+    bool inserted[TREE_TEST_LEAVES];
+    size_t count = 300;
+    for (size_t i = 0; i < count; i++) {
+        ids[i] = i;
+        leaves[i] = aabb_tree_insert(tree, random_aabb(), &ids[i]);
+        inserted[i] = true;
+    }
+    for (size_t step = 0; step < 40; step++) {
+        for (size_t i = 0; i < count; i++) {
+            if (!inserted[i]) {
+                continue;
+            }
+            aabb_t box = aabb_tree_get_box(tree, leaves[i]);
+            vector_t move = i % 13 == step % 13
+                ? vec_init(random_between(-80, 80), random_between(-40, 40))
+                : vec_init(random_between(-1.5, 1.5),
+                    random_between(-1.5, 1.5));
+            // the stored box is fat, so shrink it back to the object's box
+            box = aabb_fatten(box, -1);
+            box.min = vec_add(box.min, move);
+            box.max = vec_add(box.max, move);
+            aabb_tree_move(tree, leaves[i], box);
+            assert(aabb_contains(aabb_tree_get_box(tree, leaves[i]), box));
+        }
+        size_t toggled = (step * 7) % count;
+        if (inserted[toggled]) {
+            aabb_tree_remove(tree, leaves[toggled]);
+        }
+        else {
+            leaves[toggled] = aabb_tree_insert(tree, random_aabb(),
+                &ids[toggled]);
+        }
+        inserted[toggled] = !inserted[toggled];
+        for (size_t query = 0; query < 5; query++) {
+            check_query(tree, leaves, ids, inserted, count,
+                aabb_fatten(random_aabb(), random_between(0, 20)));
+        }
+        assert(aabb_tree_height(tree) <= 20);
+    }
+    aabb_tree_free(tree);
+}
+
+double mark_hit(void *data, vector_t origin, vector_t direction, double max_t,
+    void *aux) {
+    (void) origin;
+    (void) direction;
+    ((bool *) aux)[*(size_t *) data] = true;
+    return max_t;
+}
+
+double stop_at_hit(void *data, vector_t origin, vector_t direction,
+    double max_t, void *aux) {
+    (void) data;
+    (void) origin;
+    (void) direction;
+    (void) max_t;
+    ++*(size_t *) aux;
+    return 0;
+}
+
+void test_aabb_tree_raycast() {
+    // two rows of boxes; the ray runs along the lower one and stops short
+    aabb_tree_t *tree = aabb_tree_init(0);
+    size_t ids[40];
+    for (size_t i = 0; i < 40; i++) {
+        ids[i] = i;
+        double y = i < 20 ? 0 : 10;
+        double x = 3 * (i % 20);
+        aabb_tree_insert(tree, make_aabb(x, y, x + 1, y + 1), &ids[i]);
+    }
+    bool hit[40] = {false};
+    aabb_tree_raycast(tree, vec_init(-1, 0.5), vec_init(2, 0), 20, mark_hit,
+        hit);
+    for (size_t i = 0; i < 40; i++) {
+        // the ray ends at x = 39
+        assert(hit[i] == (i < 20 && 3 * i <= 39));
+    }
+
+    // a diagonal ray reaches the upper row
+    memset(hit, 0, sizeof(hit));
+    aabb_tree_raycast(tree, vec_init(-0.5, -0.5), vec_init(1, 1), 100,
+        mark_hit, hit);
+    for (size_t i = 0; i < 40; i++) {
+        assert(hit[i] == (i == 0 || i == 23));
+    }
+
+    size_t count = 0;
+    aabb_tree_raycast(tree, vec_init(-1, 0.5), vec_init(1, 0), 100,
+        stop_at_hit, &count);
+    assert(count == 1);
+    aabb_tree_free(tree);
+}
+
+void test_aabb_tree_broadphase() {
+    // with no margin the fat boxes are the bodies' boxes
+    broadphase_t *broadphase = aabb_tree_broadphase_init(0);
+    check_broadphase_brute_force(broadphase, true);
+    broadphase_free(broadphase);
+    // fat boxes can only add pairs
+    broadphase = aabb_tree_broadphase_init(2);
+    check_broadphase_brute_force(broadphase, false);
+    broadphase_free(broadphase);
+}
+
+int main(int argc, char *argv[]) {
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests) {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_aabb_tree_move)
+    DO_TEST(test_aabb_tree_balance)
+    DO_TEST(test_aabb_tree_refit)
+    DO_TEST(test_aabb_tree_raycast)
+    DO_TEST(test_aabb_tree_broadphase)
+
+    puts("aabb_tree_test PASS");
+}
@@ -0,0 +1,137 @@
+#include "barnes_hut.h"
+#include "forces.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+const double BH_G = 50;
+const size_t BH_BODIES = 90;
+
+// A mix of boxes, circles and capsules, some close enough to be touching
+body_t *make_body(size_t i) {
+    vector_t center = vec_init((i * 37) % 101 + 0.3 * (i % 7),
+        (i * 53) % 89 + 0.2 * (i % 5));
+    double mass = 1 + i % 4;
+    switch (i % 3) {
+        case 0: {
+            body_t *box = make_box(center, 2 + i % 3, 2 + i % 3, mass);
+            body_set_rotation(box, 0.1 * i);
+            return box;
+        }
+        case 1:
+            return make_circle(center, 1 + 0.5 * (i % 4), mass);
+        default:
+            return body_init_capsule(center, vec_add(center, vec_init(2, 1)),
+                0.5, mass, TEST_COLOR, NULL, NULL);
+    }
+}
+
+// Applies the pairwise force to every pair not touching, like
+// create_newtonian_gravity() on each pair
+void apply_pairwise(scene_t *scene) {
+    for (size_t i = 0; i < scene_bodies(scene); i++) {
+        body_t *body1 = scene_get_body(scene, i);
+        for (size_t j = i + 1; j < scene_bodies(scene); j++) {
+            body_t *body2 = scene_get_body(scene, j);
+            double distance = vec_magnitude(vec_subtract(
+                body_get_centroid(body1), body_get_centroid(body2)));
+            if (distance >= body_get_reach(body1) + body_get_reach(body2)) {
+                grav_calc_helper(BH_G, body1, body2);
+            }
+        }
+    }
+}
+
+// Returns the largest error of the Barnes-Hut forces relative to the
+// largest pairwise force
+double barnes_hut_error(double theta) {
+    scene_t *exact = scene_init();
+    scene_t *approximate = scene_init();
+    for (size_t i = 0; i < BH_BODIES; i++) {
+        scene_add_body(exact, make_body(i));
+        scene_add_body(approximate, make_body(i));
+    }
+    apply_pairwise(exact);
+    barnes_hut_t *gravity = barnes_hut_init(approximate, BH_G, theta);
+    barnes_hut_apply(gravity);
+    barnes_hut_free(gravity);
+
+    double largest = 0;
+    double error = 0;
+    for (size_t i = 0; i < BH_BODIES; i++) {
+        vector_t expected = body_get_force(scene_get_body(exact, i));
+        vector_t actual = body_get_force(scene_get_body(approximate, i));
+        largest = fmax(largest, vec_magnitude(expected));
+        error = fmax(error, vec_magnitude(vec_subtract(actual, expected)));
+    }
+    assert(largest > 0);
+    scene_free(exact);
+    scene_free(approximate);
+    return error / largest;
+}
+
+void test_barnes_hut_exact() {
+    // with theta 0 every pair interacts directly
+    assert(barnes_hut_error(0) < 1e-9);
+}
+
+void test_barnes_hut_approximate() {
+    assert(barnes_hut_error(0.5) < 0.05);
+}
+
+// Returns whether a body is pulled straight towards a point
+bool pulled_towards(body_t *body, vector_t point) {
+    vector_t force = body_get_force(body);
+    vector_t direction = vec_subtract(point, body_get_centroid(body));
+    return vec_dot(force, direction) > 0 && isclose(vec_cross(force, direction)
+        / (vec_magnitude(force) * vec_magnitude(direction)), 0);
+}
+
+void test_barnes_hut_touching_circles() {
+    // the circles overlap, so only the far box pulls on them
+    scene_t *scene = scene_init();
+    body_t *circle1 = make_circle(VEC_ZERO, 1, 1);
+    body_t *circle2 = make_circle(vec_init(1.5, 0), 1, 1);
+    body_t *box = make_box(vec_init(0, 100), 2, 2, 1);
+    scene_add_body(scene, circle1);
+    scene_add_body(scene, circle2);
+    scene_add_body(scene, box);
+    barnes_hut_t *gravity = barnes_hut_init(scene, BH_G, 0);
+    barnes_hut_apply(gravity);
+    barnes_hut_free(gravity);
+    assert(pulled_towards(circle1, body_get_centroid(box)));
+    assert(pulled_towards(circle2, body_get_centroid(box)));
+    scene_free(scene);
+}
+
+void test_barnes_hut_skips_fixed() {
+    scene_t *scene = scene_init();
+    body_t *fixed = make_box(VEC_ZERO, 2, 2, INFINITY);
+    body_t *free_box = make_box(vec_init(10, 0), 2, 2, 1);
+    scene_add_body(scene, fixed);
+    scene_add_body(scene, free_box);
+    barnes_hut_t *gravity = barnes_hut_init(scene, BH_G, 0.5);
+    barnes_hut_apply(gravity);
+    barnes_hut_free(gravity);
+    assert(vec_equal(body_get_force(fixed), VEC_ZERO));
+    assert(vec_equal(body_get_force(free_box), VEC_ZERO));
+    scene_free(scene);
+}
+
+int main(int argc, char *argv[]) {
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests) {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_barnes_hut_exact)
+    DO_TEST(test_barnes_hut_approximate)
+    DO_TEST(test_barnes_hut_touching_circles)
+    DO_TEST(test_barnes_hut_skips_fixed)
+
+    puts("barnes_hut_test PASS");
+}
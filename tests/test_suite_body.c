@@ -0,0 +1,81 @@
+#include "body.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+void check_aabb(aabb_t box, aabb_t expected) {
+    assert(vec_isclose(box.min, expected.min));
+    assert(vec_isclose(box.max, expected.max));
+}
+
+void test_round_body_aabb() {
+    body_t *circle = make_circle(vec_init(1, 2), 0.5, 1);
+    assert(body_get_kind(circle) == BODY_CIRCLE);
+    assert(body_get_radius(circle) == 0.5);
+    check_aabb(body_get_aabb(circle), make_aabb(0.5, 1.5, 1.5, 2.5));
+    body_set_centroid(circle, vec_init(-3, 0));
+    check_aabb(body_get_aabb(circle), make_aabb(-3.5, -0.5, -2.5, 0.5));
+
+    // a capsule's box covers both end caps, however it is turned
+    body_t *capsule = body_init_capsule(vec_init(0, 0), vec_init(4, 0), 1, 1,
+        TEST_COLOR, NULL, NULL);
+    assert(body_get_kind(capsule) == BODY_CAPSULE);
+    check_aabb(body_get_aabb(capsule), make_aabb(-1, -1, 5, 1));
+    body_set_rotation(capsule, M_PI / 2);
+    check_aabb(body_get_aabb(capsule), make_aabb(1, -3, 3, 3));
+    body_set_centroid(capsule, vec_init(10, 10));
+    check_aabb(body_get_aabb(capsule), make_aabb(9, 7, 11, 13));
+    body_free(circle);
+    body_free(capsule);
+}
+
+void test_polygon_aabb() {
+    body_t *box = make_box(vec_init(1, 1), 4, 2, 1);
+    assert(body_get_kind(box) == BODY_POLYGON);
+    assert(body_get_radius(box) == 0);
+    check_aabb(body_get_aabb(box), make_aabb(-1, 0, 3, 2));
+    body_set_rotation(box, M_PI / 4);
+    double reach = 3 / sqrt(2);
+    check_aabb(body_get_aabb(box),
+        make_aabb(1 - reach, 1 - reach, 1 + reach, 1 + reach));
+    body_free(box);
+}
+
+void test_collision_filter() {
+    body_t *body1 = make_circle(VEC_ZERO, 1, 1);
+    body_t *body2 = make_circle(VEC_ZERO, 1, 1);
+    // everything collides by default
+    assert(body_get_category(body1) == 1);
+    assert(body_can_collide(body1, body2));
+    // each body's category has to be in the other's mask
+    body_set_collision_filter(body1, 1 << 1, 1 << 2);
+    body_set_collision_filter(body2, 1 << 2, 1 << 1);
+    assert(body_can_collide(body1, body2));
+    assert(body_can_collide(body2, body1));
+    body_set_collision_filter(body2, 1 << 2, 1 << 3);
+    assert(!body_can_collide(body1, body2));
+    assert(!body_can_collide(body2, body1));
+    // a body with no mask collides with nothing
+    body_set_collision_filter(body2, 1 << 2, 0);
+    assert(!body_can_collide(body1, body2));
+    assert(body_get_mask(body2) == 0);
+    body_free(body1);
+    body_free(body2);
+}
+
+int main(int argc, char *argv[]) {
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests) {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_round_body_aabb)
+    DO_TEST(test_polygon_aabb)
+    DO_TEST(test_collision_filter)
+
+    puts("body_test PASS");
+}
@@ -0,0 +1,130 @@
+#include "body_store.h"
+#include "body.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+// Odd, so the SIMD kernel leaves some bodies for the scalar loop
+#define STORE_TEST_BODIES 13
+
+body_t *make_body(size_t i) {
+    return make_circle(vec_init(i, 2.0 * i), 1, 1 + i % 3);
+}
+
+// Gives a body some velocity, forces and spin, depending on its index
+void push_body(body_t *body, size_t i) {
+    body_set_velocity(body, vec_init(i % 4, -1.0 * (i % 3)));
+    body_set_angular_velocity(body, 0.1 * i);
+    body_add_force(body, vec_init(3, -2.0 * i));
+    body_add_impulse(body, vec_init(0.5 * i, 1));
+    body_add_torque(body, 0.25 * i);
+    if (i % 4 == 1) {
+        // rotating about a point off the centroid swings the centroid around
+        vector_t pivot = vec_add(body_get_centroid(body), vec_init(1, 0));
+        body_add_force_imp_pos(body, vec_init(0, 1), pivot);
+    }
+}
+
+void test_store_tick_matches_body_tick() {
+    body_store_t *store = body_store_init(1);
+    body_t *alone[STORE_TEST_BODIES];
+    body_t *stored[STORE_TEST_BODIES];
+    for (size_t i = 0; i < STORE_TEST_BODIES; i++) {
+        alone[i] = make_body(i);
+        stored[i] = make_body(i);
+        body_set_store(stored[i], store);
+    }
+    for (size_t tick = 0; tick < 5; tick++) {
+        for (size_t i = 0; i < STORE_TEST_BODIES; i++) {
+            push_body(alone[i], i + tick);
+            push_body(stored[i], i + tick);
+            body_tick(alone[i], 0.1);
+        }
+        body_store_tick(store, 0.1);
+        for (size_t i = 0; i < STORE_TEST_BODIES; i++) {
+            assert(vec_isclose(body_get_centroid(alone[i]),
+                body_get_centroid(stored[i])));
+            assert(vec_isclose(body_get_velocity(alone[i]),
+                body_get_velocity(stored[i])));
+            assert(isclose(body_get_angular_velocity(alone[i]),
+                body_get_angular_velocity(stored[i])));
+            assert(vec_equal(body_get_force(stored[i]), VEC_ZERO));
+        }
+    }
+    for (size_t i = 0; i < STORE_TEST_BODIES; i++) {
+        body_free(alone[i]);
+        body_free(stored[i]);
+    }
+    body_store_free(store);
+}
+
+void test_store_remove_keeps_others() {
+    body_store_t *store = body_store_init(4);
+    body_t *bodies[STORE_TEST_BODIES];
+    for (size_t i = 0; i < STORE_TEST_BODIES; i++) {
+        bodies[i] = make_body(i);
+        body_set_velocity(bodies[i], vec_init(i, 0));
+        body_set_store(bodies[i], store);
+    }
+    assert(store->size == STORE_TEST_BODIES);
+    // the last slot moves into the gap each time
+    for (size_t i = 0; i < STORE_TEST_BODIES; i += 3) {
+        body_set_store(bodies[i], NULL);
+    }
+    assert(store->size == STORE_TEST_BODIES - 5);
+    body_store_tick(store, 1);
+    for (size_t i = 0; i < STORE_TEST_BODIES; i++) {
+        double expected = i % 3 == 0 ? i : 2 * i;
+        assert(isclose(body_get_centroid(bodies[i]).x, expected));
+        assert(vec_isclose(body_get_velocity(bodies[i]), vec_init(i, 0)));
+        body_free(bodies[i]);
+    }
+    assert(store->size == 0);
+    body_store_free(store);
+}
+
+void test_store_skips_sleeping() {
+    body_store_t *store = body_store_init(4);
+    body_t *bodies[5];
+    for (size_t i = 0; i < 5; i++) {
+        bodies[i] = make_body(i);
+        body_set_store(bodies[i], store);
+        body_set_velocity(bodies[i], vec_init(1, 0));
+    }
+    body_sleep(bodies[1]);
+    body_sleep(bodies[2]);
+    body_sleep(bodies[4]);
+    // a velocity written straight into a sleeping slot must not move it
+    assert(store->bodies[2] == bodies[2]);
+    store->fields[STORE_VELOCITY_Y][2] = 5;
+    body_store_tick(store, 1);
+    for (size_t i = 0; i < 5; i++) {
+        double moved = body_is_sleeping(bodies[i]) ? 0 : 1;
+        assert(vec_isclose(body_get_centroid(bodies[i]),
+            vec_init(i + moved, 2.0 * i)));
+    }
+    body_wake(bodies[2]);
+    body_store_tick(store, 1);
+    assert(vec_isclose(body_get_centroid(bodies[2]), vec_init(2, 9)));
+    for (size_t i = 0; i < 5; i++) {
+        body_free(bodies[i]);
+    }
+    body_store_free(store);
+}
+
+int main(int argc, char *argv[]) {
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests) {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_store_tick_matches_body_tick)
+    DO_TEST(test_store_remove_keeps_others)
+    DO_TEST(test_store_skips_sleeping)
+
+    puts("body_store_test PASS");
+}
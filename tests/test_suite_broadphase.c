@@ -0,0 +1,184 @@
+#include "broadphase.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+// A broadphase that pairs every body it tracks, counting the calls it gets
+typedef struct {
+    body_t *bodies[4];
+    size_t size;
+    size_t queries;
+    size_t raycasts;
+    bool *freed;
+} list_phase_t;
+
+void list_phase_add(list_phase_t *state, body_t *body) {
+    state->bodies[state->size++] = body;
+}
+
+void list_phase_remove(list_phase_t *state, body_t *body) {
+    for (size_t i = 0; i < state->size; i++) {
+        if (state->bodies[i] == body) {
+            state->bodies[i] = state->bodies[--state->size];
+            return;
+        }
+    }
+    assert(false);
+}
+
+void list_phase_pairs(list_phase_t *state, pair_map_t *pairs) {
+    for (size_t i = 0; i < state->size; i++) {
+        for (size_t j = i + 1; j < state->size; j++) {
+            broadphase_add_pair(pairs, state->bodies[i], state->bodies[j]);
+        }
+    }
+}
+
+void list_phase_query(list_phase_t *state, aabb_t region,
+    body_query_t callback, void *aux) {
+    (void) region;
+    state->queries++;
+    for (size_t i = 0; i < state->size && callback(state->bodies[i], aux);
+        i++) {
+    }
+}
+
+void list_phase_raycast(list_phase_t *state, vector_t origin,
+    vector_t direction, double max_t, body_raycast_t callback, void *aux) {
+    state->raycasts++;
+    for (size_t i = 0; i < state->size && max_t > 0; i++) {
+        max_t = callback(state->bodies[i], origin, direction, max_t, aux);
+    }
+}
+
+void list_phase_free(list_phase_t *state) {
+    *state->freed = true;
+    free(state);
+}
+
+broadphase_t *make_list_phase(bool *freed) {
+    list_phase_t *state = calloc(1, sizeof(list_phase_t));
+    assert(state != NULL);
+    state->freed = freed;
+    return broadphase_init(state, (broadphase_add_t) list_phase_add,
+        (broadphase_remove_t) list_phase_remove,
+        (broadphase_pairs_t) list_phase_pairs,
+        (free_func_t) list_phase_free);
+}
+
+bool count_body(body_t *body, void *aux) {
+    (void) body;
+    return ++*(size_t *) aux < 2;
+}
+
+double count_hit(body_t *body, vector_t origin, vector_t direction,
+    double max_t, void *aux) {
+    (void) body;
+    (void) origin;
+    (void) direction;
+    ++*(size_t *) aux;
+    return max_t;
+}
+
+void test_broadphase_dispatch() {
+    bool freed = false;
+    broadphase_t *broadphase = make_list_phase(&freed);
+    list_phase_t *state = broadphase_get_state(broadphase);
+    body_t *bodies[3];
+    for (size_t i = 0; i < 3; i++) {
+        bodies[i] = make_circle(vec_init(i, 0), 1, 1);
+        broadphase_add(broadphase, bodies[i]);
+    }
+    assert(state->size == 3);
+    broadphase_remove(broadphase, bodies[1]);
+    assert(state->size == 2);
+
+    pair_map_t *pairs = pair_map_init(0, sizeof(body_pair_t));
+    broadphase_find_pairs(broadphase, pairs);
+    assert(pair_map_size(pairs) == 1);
+    body_pair_t *pair = pair_map_get(pairs,
+        pair_key(body_get_id(bodies[2]), body_get_id(bodies[0])));
+    assert(pair != NULL);
+    assert(pair->body1 == bodies[0] || pair->body1 == bodies[2]);
+    assert(pair->body2 == bodies[0] || pair->body2 == bodies[2]);
+    pair_map_free(pairs);
+
+    broadphase_free(broadphase);
+    assert(freed);
+    for (size_t i = 0; i < 3; i++) {
+        body_free(bodies[i]);
+    }
+}
+
+void test_broadphase_queries() {
+    bool freed = false;
+    broadphase_t *broadphase = make_list_phase(&freed);
+    list_phase_t *state = broadphase_get_state(broadphase);
+    body_t *bodies[3];
+    for (size_t i = 0; i < 3; i++) {
+        bodies[i] = make_circle(vec_init(i, 0), 1, 1);
+        broadphase_add(broadphase, bodies[i]);
+    }
+    aabb_t region = body_get_aabb(bodies[0]);
+    size_t count = 0;
+
+    // without query functions, callers are told to scan for themselves
+    assert(!broadphase_query(broadphase, region, count_body, &count));
+    assert(!broadphase_raycast(broadphase, VEC_ZERO, vec_init(1, 0), 1,
+        count_hit, &count));
+    assert(count == 0);
+
+    broadphase_set_query(broadphase, (broadphase_query_t) list_phase_query);
+    broadphase_set_raycast(broadphase,
+        (broadphase_raycast_t) list_phase_raycast);
+    assert(broadphase_query(broadphase, region, count_body, &count));
+    // the callback stopped the query after two bodies
+    assert(count == 2 && state->queries == 1);
+    count = 0;
+    assert(broadphase_raycast(broadphase, VEC_ZERO, vec_init(1, 0), 1,
+        count_hit, &count));
+    assert(count == 3 && state->raycasts == 1);
+
+    broadphase_free(broadphase);
+    for (size_t i = 0; i < 3; i++) {
+        body_free(bodies[i]);
+    }
+}
+
+void test_broadphase_add_pair() {
+    pair_map_t *pairs = pair_map_init(0, sizeof(body_pair_t));
+    body_t *body1 = make_circle(vec_init(0, 0), 1, 1);
+    body_t *body2 = make_circle(vec_init(1, 0), 1, 1);
+    body_t *ghost = make_circle(vec_init(2, 0), 1, 1);
+    body_set_collision_filter(ghost, 1 << 5, 0);
+
+    broadphase_add_pair(pairs, body1, body2);
+    broadphase_add_pair(pairs, body2, body1);
+    assert(pair_map_size(pairs) == 1);
+    // pairs the collision filters rule out are never reported
+    broadphase_add_pair(pairs, body1, ghost);
+    broadphase_add_pair(pairs, ghost, body2);
+    assert(pair_map_size(pairs) == 1);
+
+    pair_map_free(pairs);
+    body_free(body1);
+    body_free(body2);
+    body_free(ghost);
+}
+
+int main(int argc, char *argv[]) {
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests) {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_broadphase_dispatch)
+    DO_TEST(test_broadphase_queries)
+    DO_TEST(test_broadphase_add_pair)
+
+    puts("broadphase_test PASS");
+}
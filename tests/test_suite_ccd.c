@@ -0,0 +1,214 @@
+#include "ccd.h"
+#include "collision.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+// The tolerance shape_time_of_impact() stops within
+#define CCD_TEST_TOLERANCE 0.05
+
+shape_t *make_point_shape(vector_t point) {
+    shape_t *shape = shape_init(1);
+    shape->points[0] = point;
+    return shape;
+}
+
+// The distance from a point to the box [-1, 1] x [-1, 1]
+double box_distance(vector_t point) {
+    double dx = fmax(fabs(point.x) - 1, 0);
+    double dy = fmax(fabs(point.y) - 1, 0);
+    return sqrt(dx * dx + dy * dy);
+}
+
+void test_shape_time_of_impact() {
+    shape_t *box = make_box_shape(VEC_ZERO, 2, 2);
+    shape_t *ball = make_point_shape(vec_init(5, 0));
+    vector_t normal;
+    vector_t point;
+    // the ball's edge reaches the box once its center is at x = 1.5
+    double t = shape_time_of_impact(box, 0, ball, 0.5, vec_init(-2, 0), 5,
+        &normal, &point);
+    assert(t <= 1.75 && t >= 1.75 - CCD_TEST_TOLERANCE / 2);
+    assert(vec_isclose(normal, vec_init(1, 0)));
+    assert(vec_isclose(point, vec_init(1, 0)));
+
+    // moving away, passing by, or stopping short never hits
+    assert(shape_time_of_impact(box, 0, ball, 0.5, vec_init(2, 0), 5,
+        &normal, &point) == INFINITY);
+    assert(shape_time_of_impact(box, 0, ball, 0.5, vec_init(0, 2), 5,
+        &normal, &point) == INFINITY);
+    assert(shape_time_of_impact(box, 0, ball, 0.5, vec_init(-2, 0), 1.5,
+        &normal, &point) == INFINITY);
+
+    // a rounded still shape reports the point on its rounded surface
+    t = shape_time_of_impact(box, 0.5, ball, 0, vec_init(-2, 0), 5, &normal,
+        &point);
+    assert(t <= 1.75 && t >= 1.75 - CCD_TEST_TOLERANCE / 2);
+    assert(vec_isclose(point, vec_init(1.5, 0)));
+    shape_free(box);
+    shape_free(ball);
+}
+
+void test_shape_time_of_impact_sampled() {
+    // checks conservative advancement against a finely sampled motion: it
+    // must never report a time after the first contact, and must stop
+    // within the tolerance of the box
+    srand(15);
+    shape_t *box = make_box_shape(VEC_ZERO, 2, 2);
+    for (size_t trial = 0; trial < 500; trial++) {
+        double angle = random_between(0, 2 * M_PI);
+        vector_t start = vec_multiply(random_between(2, 6),
+            vec_init(cos(angle), sin(angle)));
+        // aim roughly at the box, missing some of the time
+        vector_t target = vec_init(random_between(-2.5, 2.5),
+            random_between(-2.5, 2.5));
+        vector_t velocity = vec_multiply(random_between(0.5, 4),
+            vec_unit(vec_subtract(target, start)));
+        double radius = random_between(0, 0.5);
+        if (box_distance(start) <= radius) {
+            continue;
+        }
+        double dt = 4;
+        shape_t *ball = make_point_shape(start);
+        vector_t normal;
+        vector_t point;
+        double t = shape_time_of_impact(box, 0, ball, radius, velocity, dt,
+            &normal, &point);
+        shape_free(ball);
+
+        double first_contact = INFINITY;
+        for (size_t step = 0; step <= 4000; step++) {
+            double sample = dt * step / 4000;
+            vector_t center = vec_add(start, vec_multiply(sample, velocity));
+            if (box_distance(center) <= radius) {
+                first_contact = sample;
+                break;
+            }
+        }
+        if (t == INFINITY) {
+            assert(first_contact == INFINITY);
+            continue;
+        }
+        assert(t <= first_contact);
+        double gap = box_distance(vec_add(start, vec_multiply(t, velocity)))
+            - radius;
+        assert(gap >= -1e-9 && gap <= CCD_TEST_TOLERANCE);
+        assert(isclose(vec_magnitude(normal), 1));
+    }
+    shape_free(box);
+}
+
+void test_time_of_impact() {
+    // a bullet that would pass through a thin wall in a single tick
+    body_t *wall = make_box(vec_init(0.1, 0), 0.2, 10, 1);
+    body_t *bullet = make_circle(vec_init(-10, 0), 0.5, 1);
+    body_set_velocity(bullet, vec_init(100, 0));
+    double t = time_of_impact(wall, bullet, 1);
+    // it touches at t = 0.095 and may sink in by 0.5 / 100 more
+    assert(t >= 0.095 - CCD_TEST_TOLERANCE / 100 && t <= 0.1 + 1e-9);
+    body_set_centroid(bullet, vec_init(-10 + 100 * t, 0));
+    assert(get_if_collided(find_collision(wall, bullet)));
+
+    // the order of the bodies and whose velocity it is do not matter
+    body_set_centroid(bullet, vec_init(-10, 0));
+    body_set_velocity(bullet, VEC_ZERO);
+    body_set_velocity(wall, vec_init(-100, 0));
+    assert(isclose(time_of_impact(bullet, wall, 1), t));
+
+    // bodies moving apart, or already colliding, have no time of impact
+    body_set_velocity(wall, vec_init(100, 0));
+    assert(time_of_impact(wall, bullet, 1) == INFINITY);
+    body_set_centroid(bullet, vec_init(0, 0));
+    assert(time_of_impact(wall, bullet, 1) == INFINITY);
+    body_free(wall);
+    body_free(bullet);
+}
+
+void test_ray_box() {
+    body_t *box = make_box(VEC_ZERO, 2, 2, 1);
+    vector_t normal;
+    assert(isclose(ray_time_of_impact(box, vec_init(-5, 0), vec_init(2, 0),
+        10, &normal), 2));
+    assert(vec_isclose(normal, vec_init(-1, 0)));
+    assert(isclose(ray_time_of_impact(box, vec_init(3, 4), vec_init(-1, -1),
+        10, &normal), 3));
+    assert(vec_isclose(normal, vec_init(0, 1)));
+    // too short, pointing away, passing by, or starting inside
+    assert(ray_time_of_impact(box, vec_init(-5, 0), vec_init(2, 0), 1.5,
+        &normal) == INFINITY);
+    assert(ray_time_of_impact(box, vec_init(-5, 0), vec_init(-1, 0), 10,
+        &normal) == INFINITY);
+    assert(ray_time_of_impact(box, vec_init(-5, 2), vec_init(1, 0), 10,
+        &normal) == INFINITY);
+    assert(ray_time_of_impact(box, VEC_ZERO, vec_init(1, 0), 10, &normal)
+        == INFINITY);
+    body_free(box);
+}
+
+void test_ray_concave() {
+    // an L shape, hit inside its notch
+    shape_t *shape = shape_init(6);
+    shape->points[0] = vec_init(0, 0);
+    shape->points[1] = vec_init(4, 0);
+    shape->points[2] = vec_init(4, 1);
+    shape->points[3] = vec_init(1, 1);
+    shape->points[4] = vec_init(1, 4);
+    shape->points[5] = vec_init(0, 4);
+    body_t *body = body_init_with_shape(shape, 1, TEST_COLOR, NULL, NULL);
+    vector_t normal;
+    assert(isclose(ray_time_of_impact(body, vec_init(3, 3), vec_init(-1, 0),
+        10, &normal), 2));
+    assert(vec_isclose(normal, vec_init(1, 0)));
+    assert(isclose(ray_time_of_impact(body, vec_init(3, 3), vec_init(0, -1),
+        10, &normal), 2));
+    assert(vec_isclose(normal, vec_init(0, 1)));
+    assert(ray_time_of_impact(body, vec_init(3, 3), vec_init(1, 1), 10,
+        &normal) == INFINITY);
+    body_free(body);
+}
+
+void test_ray_rounded() {
+    vector_t normal;
+    body_t *circle = make_circle(VEC_ZERO, 1, 1);
+    assert(isclose(ray_time_of_impact(circle, vec_init(-5, 0),
+        vec_init(2, 0), 10, &normal), 2));
+    assert(vec_isclose(normal, vec_init(-1, 0)));
+    assert(ray_time_of_impact(circle, vec_init(-5, 1.5), vec_init(1, 0), 10,
+        &normal) == INFINITY);
+    assert(ray_time_of_impact(circle, vec_init(0.5, 0), vec_init(1, 0), 10,
+        &normal) == INFINITY);
+    body_free(circle);
+
+    // a capsule is hit on its sides and its end caps
+    body_t *capsule = body_init_capsule(vec_init(0, 0), vec_init(4, 0), 1, 1,
+        TEST_COLOR, NULL, NULL);
+    assert(isclose(ray_time_of_impact(capsule, vec_init(2, 5),
+        vec_init(0, -1), 10, &normal), 4));
+    assert(vec_isclose(normal, vec_init(0, 1)));
+    assert(isclose(ray_time_of_impact(capsule, vec_init(7, 0),
+        vec_init(-1, 0), 10, &normal), 2));
+    assert(vec_isclose(normal, vec_init(1, 0)));
+    assert(ray_time_of_impact(capsule, vec_init(2, 0.5), vec_init(0, 1), 10,
+        &normal) == INFINITY);
+    body_free(capsule);
+}
+
+int main(int argc, char *argv[]) {
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests) {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_shape_time_of_impact)
+    DO_TEST(test_shape_time_of_impact_sampled)
+    DO_TEST(test_time_of_impact)
+    DO_TEST(test_ray_box)
+    DO_TEST(test_ray_concave)
+    DO_TEST(test_ray_rounded)
+
+    puts("ccd_test PASS");
+}
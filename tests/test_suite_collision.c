@@ -0,0 +1,351 @@
+#include "collision.h"
+#include "contact_cache.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+// How far find_collision() may be from the reference test below
+#define SAT_EPSILON 1e-9
+
+// The separating axis test written out plainly: every edge normal of both
+// shapes, normalized and facing the way find_collision() faces them (which
+// matters for the depth when one projection contains the other), with the
+// overlap defined as overlap() defines it
+double reference_overlap(const shape_t *shape1, const shape_t *shape2,
+    bool *collided) {
+    double least = INFINITY;
+    *collided = true;
+    const shape_t *shapes[2] = {shape1, shape2};
+    for (size_t s = 0; s < 2; s++) {
+        const shape_t *edges = shapes[s];
+        for (size_t i = 0; i < edges->size; i++) {
+            vector_t edge = vec_subtract(edges->points[i],
+                edges->points[(i + 1) % edges->size]);
+            vector_t normal = vec_unit(vec_init(-edge.y, edge.x));
+            double min[2] = {INFINITY, INFINITY};
+            double max[2] = {-INFINITY, -INFINITY};
+            for (size_t k = 0; k < 2; k++) {
+                for (size_t j = 0; j < shapes[k]->size; j++) {
+                    double dot = vec_dot(shapes[k]->points[j], normal);
+                    min[k] = fmin(min[k], dot);
+                    max[k] = fmax(max[k], dot);
+                }
+            }
+            double depth = min[0] <= min[1] ? max[0] - min[1]
+                : max[1] - min[0];
+            if (depth < 0) {
+                *collided = false;
+                return depth;
+            }
+            least = fmin(least, depth);
+        }
+    }
+    return least;
+}
+
+void test_project_shape() {
+    shape_t *box = make_box_shape(vec_init(1, 0), 2, 2);
+    double min, max;
+    project_shape(vec_init(1, 0), box, &min, &max);
+    assert(isclose(min, 0) && isclose(max, 2));
+    // the extent is scaled by the line's length
+    project_shape(vec_init(0, 3), box, &min, &max);
+    assert(isclose(min, -3) && isclose(max, 3));
+    project_shape(vec_init(1, 1), box, &min, &max);
+    assert(isclose(min, -1) && isclose(max, 3));
+    shape_free(box);
+}
+
+void test_overlap() {
+    shape_t *box1 = make_box_shape(VEC_ZERO, 2, 2);
+    shape_t *box2 = make_box_shape(vec_init(1.5, 0), 2, 2);
+    shape_t *far = make_box_shape(vec_init(3, 0), 2, 2);
+    // divided by the line's length, and the same either way round
+    assert(isclose(overlap(vec_init(1, 0), box1, box2), 0.5));
+    assert(isclose(overlap(vec_init(-4, 0), box2, box1), 0.5));
+    assert(isclose(overlap(vec_init(2, 0), box1, far), -1));
+    assert(isclose(overlap(vec_init(0, 1), box1, far), 2));
+    shape_free(box1);
+    shape_free(box2);
+    shape_free(far);
+}
+
+void test_sat_boxes() {
+    body_t *box = make_box(VEC_ZERO, 4, 2, 1);
+    body_t *other = make_box(vec_init(2.5, 0.5), 2, 2, 1);
+    collision_info_t info = find_collision(box, other);
+    assert(info.collided);
+    assert(isclose(info.depth, 0.5));
+    // the axis points from the first body towards the second
+    assert(vec_isclose(info.axis, vec_init(1, 0)));
+    assert(vec_isclose(find_collision(other, box).axis, vec_init(-1, 0)));
+
+    // boxes that share an edge touch, with no depth
+    body_set_centroid(other, vec_init(3, 0.5));
+    info = find_collision(box, other);
+    assert(info.collided);
+    assert(isclose(info.depth, 0));
+
+    body_set_centroid(other, vec_init(3.01, 0.5));
+    assert(!find_collision(box, other).collided);
+    body_set_centroid(other, vec_init(0, 2.5));
+    assert(!find_collision(other, box).collided);
+    body_free(box);
+    body_free(other);
+}
+
+void test_sat_reference() {
+    // random convex polygons of many sizes, in and out of contact
+    srand(10);
+    for (size_t trial = 0; trial < 2000; trial++) {
+        vector_t offset = vec_init(random_between(-4, 4),
+            random_between(-4, 4));
+        double radius1 = random_between(0.5, 2);
+        double radius2 = random_between(0.5, 2);
+        body_t *body1 = make_star(VEC_ZERO, 3 + rand() % 14, radius1, radius1,
+            random_between(0, 2 * M_PI));
+        body_t *body2 = make_star(offset, 3 + rand() % 14, radius2, radius2,
+            random_between(0, 2 * M_PI));
+        bool collided;
+        double depth = reference_overlap(body_get_shape_view(body1),
+            body_get_shape_view(body2), &collided);
+        collision_info_t info = find_collision(body1, body2);
+        if (fabs(depth) > SAT_EPSILON) {
+            assert(info.collided == collided);
+        }
+        if (collided && info.collided) {
+            assert(within(SAT_EPSILON, info.depth, depth));
+            assert(isclose(vec_magnitude(info.axis), 1));
+        }
+        body_free(body1);
+        body_free(body2);
+    }
+}
+
+void test_sat_leaves_shapes() {
+    // the test reads the bodies' shapes in place, without changing them
+    body_t *body1 = make_star(VEC_ZERO, 7, 2, 2, 0.3);
+    body_t *body2 = make_star(vec_init(1, 1), 5, 2, 2, 0.1);
+    const shape_t *view = body_get_shape_view(body1);
+    vector_t before[7];
+    for (size_t i = 0; i < view->size; i++) {
+        before[i] = view->points[i];
+    }
+    for (size_t i = 0; i < 10; i++) {
+        assert(find_collision(body1, body2).collided);
+    }
+    assert(body_get_shape_view(body1) == view);
+    for (size_t i = 0; i < view->size; i++) {
+        assert(vec_equal(view->points[i], before[i]));
+    }
+    body_free(body1);
+    body_free(body2);
+}
+
+void check_same_collision(collision_info_t cached, collision_info_t plain) {
+    assert(cached.collided == plain.collided);
+    if (plain.collided) {
+        assert(cached.depth == plain.depth);
+        assert(vec_equal(cached.axis, plain.axis));
+        assert(cached.contact_count == plain.contact_count);
+    }
+}
+
+void test_axis_hint_matches() {
+    // two polygons drifting past each other, tested every step with and
+    // without a remembered separating axis
+    srand(11);
+    contact_cache_t *cache = contact_cache_init();
+    body_t *body1 = make_star(VEC_ZERO, 6, 1.5, 1.5, 0.2);
+    body_t *body2 = make_star(vec_init(-6, 0.5), 5, 1, 1, 0);
+    for (size_t step = 0; step < 400; step++) {
+        body_set_centroid(body2, vec_init(-6 + 0.03 * step,
+            0.5 + random_between(-0.02, 0.02)));
+        body_set_rotation(body1, 0.01);
+        check_same_collision(find_collision_cached(cache, body1, body2),
+            find_collision(body1, body2));
+        check_same_collision(find_collision_cached(cache, body2, body1),
+            find_collision(body2, body1));
+    }
+    // the pair spends most steps apart, and the axis keeps separating it
+    assert(contact_cache_axis_hits(cache) > contact_cache_axis_misses(cache));
+    assert(contact_cache_axis_hits(cache) + contact_cache_axis_misses(cache)
+        == 800);
+    contact_cache_free(cache);
+    body_free(body1);
+    body_free(body2);
+}
+
+void test_axis_hint_new_shape() {
+    // a hint naming an edge the body's new shape no longer has is ignored
+    contact_cache_t *cache = contact_cache_init();
+    body_t *body1 = make_star(VEC_ZERO, 12, 1, 1, 0);
+    body_t *body2 = make_box(vec_init(5, 0), 2, 2, 1);
+    assert(!find_collision_cached(cache, body1, body2).collided);
+    separating_axis_t *hint = contact_cache_separating_axis(cache, body1,
+        body2);
+    assert(hint->valid);
+    hint->body_id = body_get_id(body1);
+    hint->edge = 11;
+    list_t *points = list_init(3, free);
+    list_add(points, vec_init_pointer(0, 0));
+    list_add(points, vec_init_pointer(8, 0));
+    list_add(points, vec_init_pointer(0, 1));
+    body_set_points(body1, points);
+    check_same_collision(find_collision_cached(cache, body1, body2),
+        find_collision(body1, body2));
+    assert(find_collision(body1, body2).collided);
+    contact_cache_free(cache);
+    body_free(body1);
+    body_free(body2);
+}
+
+void test_circle_collisions() {
+    body_t *circle1 = make_circle(VEC_ZERO, 1, 1);
+    body_t *circle2 = make_circle(vec_init(1.2, 1.6), 1.5, 1);
+    collision_info_t info = find_collision(circle1, circle2);
+    assert(info.collided);
+    assert(isclose(info.depth, 0.5));
+    assert(vec_isclose(info.axis, vec_init(0.6, 0.8)));
+    assert(info.contact_count == 1);
+    // halfway between the two surfaces
+    assert(vec_isclose(info.contacts[0], vec_init(0.45, 0.6)));
+    body_set_centroid(circle2, vec_init(0, 2.6));
+    assert(!find_collision(circle2, circle1).collided);
+
+    // a circle against a box's face and against its corner
+    body_t *box = make_box(VEC_ZERO, 4, 2, 1);
+    body_set_centroid(circle1, vec_init(0, 1.75));
+    info = find_collision(box, circle1);
+    assert(info.collided);
+    assert(isclose(info.depth, 0.25));
+    assert(vec_isclose(info.axis, vec_init(0, 1)));
+    body_set_centroid(circle1, vec_init(2.54, 1.72));
+    info = find_collision(box, circle1);
+    assert(info.collided);
+    assert(isclose(info.depth, 0.1));
+    assert(vec_isclose(info.axis, vec_init(0.6, 0.8)));
+    body_set_centroid(circle1, vec_init(2.7, 1.8));
+    assert(!find_collision(circle1, box).collided);
+
+    // a circle whose center is inside the box is pushed out the nearest face
+    body_set_centroid(circle1, vec_init(1.5, 0.2));
+    info = find_collision(box, circle1);
+    assert(info.collided);
+    assert(isclose(info.depth, 1.5));
+    assert(vec_isclose(info.axis, vec_init(1, 0)));
+    body_free(circle1);
+    body_free(circle2);
+    body_free(box);
+}
+
+void test_capsule_collisions() {
+    body_t *capsule = body_init_capsule(vec_init(-2, 0), vec_init(2, 0), 1, 1,
+        TEST_COLOR, NULL, NULL);
+    // a circle above the capsule's side and beyond its end cap
+    body_t *circle = make_circle(vec_init(1, 1.5), 1, 1);
+    collision_info_t info = find_collision(capsule, circle);
+    assert(info.collided);
+    assert(isclose(info.depth, 0.5));
+    assert(vec_isclose(info.axis, vec_init(0, 1)));
+    body_set_centroid(circle, vec_init(3.5, 0));
+    info = find_collision(circle, capsule);
+    assert(info.collided);
+    assert(isclose(info.depth, 0.5));
+    assert(vec_isclose(info.axis, vec_init(-1, 0)));
+    body_set_centroid(circle, vec_init(3.5, 1.5));
+    assert(!find_collision(capsule, circle).collided);
+
+    // crossing capsules, whose cores overlap
+    body_t *crossing = body_init_capsule(vec_init(0, -2), vec_init(0, 2), 0.5,
+        1, TEST_COLOR, NULL, NULL);
+    info = find_collision(capsule, crossing);
+    assert(info.collided);
+    assert(info.depth > 1.5);
+    assert(isclose(vec_magnitude(info.axis), 1));
+    // parallel capsules resting on each other
+    body_t *parallel = body_init_capsule(vec_init(-1, 1.9), vec_init(3, 1.9),
+        1, 1, TEST_COLOR, NULL, NULL);
+    info = find_collision(capsule, parallel);
+    assert(info.collided);
+    assert(isclose(info.depth, 0.1));
+    assert(vec_isclose(info.axis, vec_init(0, 1)));
+    body_free(capsule);
+    body_free(circle);
+    body_free(crossing);
+    body_free(parallel);
+}
+
+void test_manifold_points() {
+    // a box resting on a wider one touches along an edge: 2 points, at the
+    // ends of the smaller box's bottom edge
+    body_t *floor = make_box(VEC_ZERO, 10, 2, 1);
+    body_t *box = make_box(vec_init(1, 1.9), 2, 2, 1);
+    collision_info_t info = find_collision(floor, box);
+    assert(info.collided);
+    assert(info.contact_count == 2);
+    bool found_left = false;
+    bool found_right = false;
+    for (size_t i = 0; i < 2; i++) {
+        assert(within(0.1 + 1e-9, info.contacts[i].y, 1));
+        found_left |= isclose(info.contacts[i].x, 0);
+        found_right |= isclose(info.contacts[i].x, 2);
+    }
+    assert(found_left && found_right);
+
+    // overhanging the edge, the points are clipped to the floor's end
+    body_set_centroid(box, vec_init(5, 1.9));
+    info = find_collision(box, floor);
+    assert(info.contact_count == 2);
+    for (size_t i = 0; i < 2; i++) {
+        assert(info.contacts[i].x <= 5 + 1e-9);
+        assert(info.contacts[i].x >= 4 - 1e-9);
+    }
+
+    // standing on a corner gives 1 point, at the corner
+    body_free(box);
+    box = make_box(vec_init(0, 1 + sqrt(2) - 0.1), 2, 2, 1);
+    body_set_rotation(box, M_PI / 4);
+    info = find_collision(floor, box);
+    assert(info.collided);
+    assert(info.contact_count == 1);
+    assert(vec_within(1e-9, info.contacts[0], vec_init(0, 0.9)));
+
+    // round bodies always touch at 1 point
+    body_t *circle = make_circle(vec_init(2, 1.8), 1, 1);
+    info = find_collision(floor, circle);
+    assert(info.contact_count == 1);
+    // separated bodies at none
+    body_set_centroid(circle, vec_init(2, 5));
+    assert(find_collision(floor, circle).contact_count == 0);
+    assert(find_collision(floor, box).contact_count == 1);
+    body_set_centroid(box, vec_init(0, 5));
+    assert(find_collision(floor, box).contact_count == 0);
+    body_free(floor);
+    body_free(box);
+    body_free(circle);
+}
+
+int main(int argc, char *argv[]) {
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests) {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_project_shape)
+    DO_TEST(test_overlap)
+    DO_TEST(test_sat_boxes)
+    DO_TEST(test_sat_reference)
+    DO_TEST(test_sat_leaves_shapes)
+    DO_TEST(test_axis_hint_matches)
+    DO_TEST(test_axis_hint_new_shape)
+    DO_TEST(test_circle_collisions)
+    DO_TEST(test_capsule_collisions)
+    DO_TEST(test_manifold_points)
+
+    puts("collision_test PASS");
+}
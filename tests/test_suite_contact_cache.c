@@ -0,0 +1,252 @@
+#include "contact_cache.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define CACHE_TEST_BODIES 30
+
+void test_contact_lifecycle() {
+    contact_cache_t *cache = contact_cache_init();
+    body_t *body1 = make_circle(vec_init(0, 0), 1, 1);
+    body_t *body2 = make_circle(vec_init(1, 0), 1, 1);
+    assert(contact_cache_get(cache, body1, body2) == NULL);
+
+    contact_t *contact = contact_cache_touch(cache, body1, body2,
+        vec_init(1, 0));
+    assert(contact->state == CONTACT_NEW);
+    assert(!contact->resolved);
+    contact->resolved = true;
+    contact->impulse = vec_init(2, 0);
+    // touching again in the same tick is still new
+    contact = contact_cache_touch(cache, body1, body2, vec_init(1, 0));
+    assert(contact->state == CONTACT_NEW);
+    assert(contact_cache_get(cache, body2, body1) == contact);
+
+    contact_cache_tick(cache);
+    assert(contact_cache_get_tick(cache) == 1);
+    contact = contact_cache_touch(cache, body1, body2, vec_init(1, 0));
+    assert(contact->state == CONTACT_PERSISTING);
+    // what was learned about the contact is kept while it lasts
+    assert(contact->resolved);
+    assert(vec_equal(contact->impulse, vec_init(2, 0)));
+
+    // a tick without touching ends the contact, and the next one drops it
+    contact_cache_tick(cache);
+    contact_cache_tick(cache);
+    assert(contact_cache_get(cache, body1, body2)->state == CONTACT_ENDED);
+    contact_cache_tick(cache);
+    assert(contact_cache_get(cache, body1, body2) == NULL);
+    assert(contact_cache_size(cache) == 0);
+
+    contact_cache_free(cache);
+    body_free(body1);
+    body_free(body2);
+}
+
+void test_contact_separate() {
+    contact_cache_t *cache = contact_cache_init();
+    body_t *body1 = make_circle(vec_init(0, 0), 1, 1);
+    body_t *body2 = make_circle(vec_init(1, 0), 1, 1);
+    contact_t *contact = contact_cache_touch(cache, body1, body2,
+        vec_init(1, 0));
+    contact->resolved = true;
+    contact_cache_separate(cache, body2, body1);
+    assert(contact_cache_get(cache, body1, body2)->state == CONTACT_ENDED);
+    // touching after ending starts over
+    contact = contact_cache_touch(cache, body1, body2, vec_init(1, 0));
+    assert(contact->state == CONTACT_NEW);
+    assert(!contact->resolved);
+    // separating bodies that were never touching does nothing
+    body_t *body3 = make_circle(vec_init(5, 0), 1, 1);
+    contact_cache_separate(cache, body1, body3);
+    assert(contact_cache_size(cache) == 1);
+
+    contact_cache_free(cache);
+    body_free(body1);
+    body_free(body2);
+    body_free(body3);
+}
+
+void test_contact_axis_order() {
+    // the axis always points from the contact's body1 to its body2
+    contact_cache_t *cache = contact_cache_init();
+    body_t *body1 = make_circle(vec_init(0, 0), 1, 1);
+    body_t *body2 = make_circle(vec_init(1, 0), 1, 1);
+    contact_cache_touch(cache, body1, body2, vec_init(1, 0));
+    contact_cache_tick(cache);
+    contact_t *contact = contact_cache_touch(cache, body2, body1,
+        vec_init(-0.6, 0.8));
+    assert(contact->body1 == body1 && contact->body2 == body2);
+    assert(vec_equal(contact->axis, vec_init(0.6, -0.8)));
+    contact_cache_free(cache);
+    body_free(body1);
+    body_free(body2);
+}
+
+void test_separating_axes() {
+    contact_cache_t *cache = contact_cache_init();
+    body_t *body1 = make_circle(vec_init(0, 0), 1, 1);
+    body_t *body2 = make_circle(vec_init(1, 0), 1, 1);
+    separating_axis_t *axis = contact_cache_separating_axis(cache, body1,
+        body2);
+    assert(!axis->valid);
+    *axis = (separating_axis_t) {true, body_get_id(body2), 3};
+    axis = contact_cache_separating_axis(cache, body2, body1);
+    assert(axis->valid && axis->body_id == body_get_id(body2));
+    assert(axis->edge == 3);
+    // axes are not contacts
+    assert(contact_cache_size(cache) == 0);
+
+    contact_cache_count_axis(cache, true);
+    contact_cache_count_axis(cache, true);
+    contact_cache_count_axis(cache, false);
+    assert(contact_cache_axis_hits(cache) == 2);
+    assert(contact_cache_axis_misses(cache) == 1);
+
+    contact_cache_clear(cache);
+    assert(!contact_cache_separating_axis(cache, body1, body2)->valid);
+    contact_cache_free(cache);
+    body_free(body1);
+    body_free(body2);
+}
+
+void test_contact_remove_body() {
+    // every pair of bodies touches and has an axis; removing bodies must
+    // drop exactly their contacts and axes
+    contact_cache_t *cache = contact_cache_init();
+    body_t *bodies[CACHE_TEST_BODIES];
+    for (size_t i = 0; i < CACHE_TEST_BODIES; i++) {
+        bodies[i] = make_circle(vec_init(i, 0), 1, 1);
+    }
+    for (size_t i = 0; i < CACHE_TEST_BODIES; i++) {
+        for (size_t j = i + 1; j < CACHE_TEST_BODIES; j++) {
+            contact_cache_touch(cache, bodies[i], bodies[j], vec_init(1, 0));
+            contact_cache_separating_axis(cache, bodies[i], bodies[j])->valid =
+                true;
+        }
+    }
+    for (size_t i = 0; i < CACHE_TEST_BODIES; i += 3) {
+        contact_cache_remove_body(cache, bodies[i]);
+    }
+    size_t kept = 0;
+    for (size_t i = 0; i < CACHE_TEST_BODIES; i++) {
+        for (size_t j = i + 1; j < CACHE_TEST_BODIES; j++) {
+            bool removed = i % 3 == 0 || j % 3 == 0;
+            assert((contact_cache_get(cache, bodies[i], bodies[j]) == NULL)
+                == removed);
+            assert(contact_cache_separating_axis(cache, bodies[i],
+                bodies[j])->valid != removed);
+            kept += !removed;
+        }
+    }
+    assert(contact_cache_size(cache) == kept);
+
+    // iterating over the slots visits every contact once
+    size_t count = 0;
+    for (size_t i = 0; i < contact_cache_capacity(cache); i++) {
+        contact_t *contact = contact_cache_slot(cache, i);
+        if (contact != NULL) {
+            assert(contact_cache_get(cache, contact->body1, contact->body2)
+                == contact);
+            count++;
+        }
+    }
+    assert(count == kept);
+
+    contact_cache_free(cache);
+    for (size_t i = 0; i < CACHE_TEST_BODIES; i++) {
+        body_free(bodies[i]);
+    }
+}
+
+void test_separating_axes_age() {
+    // an axis that keeps being looked up stays, one that does not is dropped
+    contact_cache_t *cache = contact_cache_init();
+    body_t *body1 = make_circle(vec_init(0, 0), 1, 1);
+    body_t *body2 = make_circle(vec_init(5, 0), 1, 1);
+    body_t *body3 = make_circle(vec_init(10, 0), 1, 1);
+    contact_cache_separating_axis(cache, body1, body2)->valid = true;
+    contact_cache_separating_axis(cache, body2, body3)->valid = true;
+    for (size_t tick = 0; tick < 100; tick++) {
+        assert(contact_cache_separating_axis(cache, body1, body2)->valid);
+        contact_cache_tick(cache);
+    }
+    assert(!contact_cache_separating_axis(cache, body2, body3)->valid);
+    // dropped axes no longer count towards their bodies' pairs
+    contact_cache_remove_body(cache, body2);
+    assert(!contact_cache_separating_axis(cache, body1, body2)->valid);
+    contact_cache_free(cache);
+    body_free(body1);
+    body_free(body2);
+    body_free(body3);
+}
+
+void test_contact_churn() {
+    // pairs come and go over many ticks while bodies are removed; the cache
+    // must agree with a plain record of which pairs were touched last
+    srand(9);
+    contact_cache_t *cache = contact_cache_init();
+    body_t *bodies[CACHE_TEST_BODIES];
+    size_t touched[CACHE_TEST_BODIES][CACHE_TEST_BODIES];
+    bool removed[CACHE_TEST_BODIES] = {false};
+    for (size_t i = 0; i < CACHE_TEST_BODIES; i++) {
+        bodies[i] = make_circle(vec_init(i, 0), 1, 1);
+        for (size_t j = 0; j < CACHE_TEST_BODIES; j++) {
+            touched[i][j] = SIZE_MAX;
+        }
+    }
+    for (size_t tick = 0; tick < 200; tick++) {
+        for (size_t n = 0; n < 20; n++) {
+            size_t i = rand() % CACHE_TEST_BODIES;
+            size_t j = rand() % CACHE_TEST_BODIES;
+            if (i == j || removed[i] || removed[j]) {
+                continue;
+            }
+            contact_cache_touch(cache, bodies[i], bodies[j], vec_init(1, 0));
+            contact_cache_separating_axis(cache, bodies[j], bodies[i]);
+            touched[i][j] = touched[j][i] = tick;
+        }
+        if (tick % 10 == 9) {
+            size_t i = rand() % CACHE_TEST_BODIES;
+            contact_cache_remove_body(cache, bodies[i]);
+            removed[i] = true;
+        }
+        for (size_t i = 0; i < CACHE_TEST_BODIES; i++) {
+            for (size_t j = i + 1; j < CACHE_TEST_BODIES; j++) {
+                contact_t *contact = contact_cache_get(cache, bodies[i],
+                    bodies[j]);
+                bool current = touched[i][j] == tick && !removed[i]
+                    && !removed[j];
+                assert((contact != NULL && contact->last_tick == tick)
+                    == current);
+            }
+        }
+        contact_cache_tick(cache);
+    }
+    contact_cache_free(cache);
+    for (size_t i = 0; i < CACHE_TEST_BODIES; i++) {
+        body_free(bodies[i]);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests) {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_contact_lifecycle)
+    DO_TEST(test_contact_separate)
+    DO_TEST(test_contact_axis_order)
+    DO_TEST(test_separating_axes)
+    DO_TEST(test_contact_remove_body)
+    DO_TEST(test_separating_axes_age)
+    DO_TEST(test_contact_churn)
+
+    puts("contact_cache_test PASS");
+}
@@ -0,0 +1,95 @@
+#include "forces.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// The pull calc_gravity_force() gives body1 towards body2, which it scales
+// down by 0.1
+vector_t gravity_pull(double G, body_t *body1, body_t *body2) {
+    vector_t difference = vec_subtract(body_get_centroid(body2),
+        body_get_centroid(body1));
+    double distance = vec_magnitude(difference);
+    return vec_multiply(0.1 * G * body_get_mass(body1) * body_get_mass(body2)
+        / (distance * distance * distance), difference);
+}
+
+// Runs calc_gravity_force() once on a pair of bodies, which it frees
+void check_gravity(body_t *body1, body_t *body2, bool pulls) {
+    const double G = 10;
+    auxillary_t *aux = aux_init(G);
+    aux_add_body(aux, body1);
+    aux_add_body(aux, body2);
+    calc_gravity_force(aux);
+    vector_t pull = pulls ? gravity_pull(G, body1, body2) : VEC_ZERO;
+    assert(vec_isclose(body_get_force(body1), pull));
+    assert(vec_isclose(body_get_force(body2), vec_negate(pull)));
+    aux_free(aux);
+}
+
+void test_gravity_round_bodies() {
+    // circles and capsules count as touching within their radii, where
+    // gravity is switched off
+    check_gravity(make_circle(VEC_ZERO, 2, 3), make_circle(vec_init(3, 0), 2, 5),
+        false);
+    check_gravity(make_circle(VEC_ZERO, 2, 3), make_circle(vec_init(3, 4), 2, 5),
+        true);
+    // measured from the capsule's centroid, whatever its length
+    body_t *capsule = body_init_capsule(vec_init(-3, 0), vec_init(3, 0), 1, 2,
+        TEST_COLOR, NULL, NULL);
+    check_gravity(capsule, make_circle(vec_init(0, 1.5), 1, 5), false);
+    capsule = body_init_capsule(vec_init(-3, 0), vec_init(3, 0), 1, 2,
+        TEST_COLOR, NULL, NULL);
+    check_gravity(capsule, make_circle(vec_init(0, 2.5), 1, 5), true);
+    // a box reaches as far as its corners
+    check_gravity(make_box(VEC_ZERO, 2, 2, 1), make_circle(vec_init(2, 0), 1, 1),
+        false);
+    check_gravity(make_box(VEC_ZERO, 2, 2, 1), make_circle(vec_init(3, 0), 1, 1),
+        true);
+}
+
+void add_unit_torque(void *aux) {
+    body_add_torque(aux, 1);
+}
+
+void test_uniform_gravity() {
+    const double G = 9.8;
+    const double DT = 0.1;
+    scene_t *scene = scene_init();
+    body_t *falling = make_box(VEC_ZERO, 2, 2, 2);
+    body_t *spinning = make_box(vec_init(5, 0), 2, 2, 1);
+    body_t *excluded = make_box(vec_init(10, 0), 2, 2, 1);
+    body_t *fixed = make_box(vec_init(15, 0), 2, 2, INFINITY);
+    body_set_collision_filter(excluded, 1 << 1, UINT32_MAX);
+    scene_add_body(scene, falling);
+    scene_add_body(scene, spinning);
+    scene_add_body(scene, excluded);
+    scene_add_body(scene, fixed);
+    // gravity adds to the forces and torques other creators gave first
+    scene_add_force_creator(scene, add_unit_torque, spinning, NULL);
+    create_uniform_gravity(scene, G, 1 << 0);
+    scene_tick(scene, DT);
+    assert(vec_isclose(body_get_velocity(falling), vec_init(0, -G * DT)));
+    assert(vec_isclose(body_get_velocity(spinning), vec_init(0, -G * DT)));
+    assert(body_get_angular_velocity(falling) == 0);
+    assert(body_get_angular_velocity(spinning) > 0);
+    assert(vec_equal(body_get_velocity(excluded), VEC_ZERO));
+    assert(vec_equal(body_get_velocity(fixed), VEC_ZERO));
+    scene_free(scene);
+}
+
+int main(int argc, char *argv[]) {
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests) {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_gravity_round_bodies)
+    DO_TEST(test_uniform_gravity)
+
+    puts("forces_test PASS");
+}
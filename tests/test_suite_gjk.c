@@ -0,0 +1,116 @@
+#include "gjk.h"
+#include "collision.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+const double GJK_EPSILON = 1e-6;
+
+// Checks that GJK and the separating axis test agree on a pair of bodies
+void check_agrees(body_t *body1, body_t *body2, bool check_axis) {
+    collision_info_t sat = find_collision(body1, body2);
+    collision_info_t gjk = find_collision_gjk(body1, body2);
+    assert(gjk.collided == sat.collided);
+    if (sat.collided) {
+        assert(within(GJK_EPSILON, gjk.depth, sat.depth));
+        assert(gjk.contact_count == sat.contact_count);
+    }
+    if (sat.collided && check_axis) {
+        // the separating axis test may give the axis either way round
+        assert(within(GJK_EPSILON, fabs(vec_dot(gjk.axis, sat.axis)), 1));
+    }
+    body_free(body1);
+    body_free(body2);
+}
+
+void test_gjk_boxes() {
+    // overlapping, separated and offset so the shallowest axis is unique
+    for (int i = -12; i <= 12; i++) {
+        for (int j = -12; j <= 12; j++) {
+            vector_t offset = vec_init(i * 0.37, j * 0.29);
+            if (fabs(fabs(offset.x) - 2.5 - (fabs(offset.y) - 1.5)) < 0.01) {
+                continue;
+            }
+            check_agrees(make_box(VEC_ZERO, 3, 2, 1), make_box(offset, 2, 1, 1),
+                true);
+        }
+    }
+}
+
+void test_gjk_separated() {
+    collision_info_t info;
+    body_t *box = make_box(VEC_ZERO, 2, 2, 1);
+    body_t *far = make_box(vec_init(10, 3), 2, 2, 1);
+    info = find_collision_gjk(box, far);
+    assert(!info.collided);
+    body_free(far);
+    body_free(box);
+}
+
+void test_gjk_regular_polygons() {
+    for (size_t sides = 3; sides <= 40; sides++) {
+        for (int i = 0; i < 16; i++) {
+            double angle = 2 * M_PI * i / 16;
+            vector_t offset = vec_init(1.7 * cos(angle), 1.7 * sin(angle));
+            check_agrees(make_star(VEC_ZERO, sides, 1, 1, 0.1),
+                make_star(offset, sides, 1, 1, 0.3 * i), true);
+        }
+    }
+}
+
+void test_gjk_stars() {
+    // concave stars are split into pieces and tested piece by piece
+    for (int i = 0; i < 16; i++) {
+        double angle = 2 * M_PI * i / 16 + 0.05;
+        vector_t offset = vec_init(3.2 * cos(angle), 3.2 * sin(angle));
+        check_agrees(make_star(VEC_ZERO, 5, 2, 0.8, 0),
+            make_star(offset, 5, 2, 0.8, 0.2 * i), true);
+    }
+}
+
+void test_gjk_touching() {
+    // boxes sharing an edge or part of one
+    check_agrees(make_box(VEC_ZERO, 2, 2, 1), make_box(vec_init(2, 0), 2, 2, 1),
+        true);
+    check_agrees(make_box(VEC_ZERO, 2, 2, 1), make_box(vec_init(0, -2), 2, 2, 1),
+        true);
+    check_agrees(make_box(VEC_ZERO, 2, 2, 1), make_box(vec_init(2, 0.5), 2, 2, 1),
+        true);
+    // boxes sharing only a corner, which either edge normal separates
+    check_agrees(make_box(VEC_ZERO, 2, 2, 1), make_box(vec_init(2, 2), 2, 2, 1),
+        false);
+    // a triangle resting its tip on a box
+    shape_t *triangle = shape_init(3);
+    triangle->points[0] = vec_init(0.5, 1);
+    triangle->points[1] = vec_init(1.5, 3);
+    triangle->points[2] = vec_init(-0.5, 3);
+    check_agrees(make_box(VEC_ZERO, 2, 2, 1), body_init_with_shape(triangle, 1, TEST_COLOR, NULL, NULL), true);
+
+    body_t *box1 = make_box(VEC_ZERO, 2, 2, 1);
+    body_t *box2 = make_box(vec_init(2, 0.5), 2, 2, 1);
+    collision_info_t info = find_collision_gjk(box1, box2);
+    assert(info.collided);
+    assert(isclose(info.depth, 0));
+    assert(vec_isclose(info.axis, vec_init(1, 0)));
+    body_free(box1);
+    body_free(box2);
+}
+
+int main(int argc, char *argv[]) {
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests) {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_gjk_separated)
+    DO_TEST(test_gjk_boxes)
+    DO_TEST(test_gjk_regular_polygons)
+    DO_TEST(test_gjk_stars)
+    DO_TEST(test_gjk_touching)
+
+    puts("gjk_test PASS");
+}
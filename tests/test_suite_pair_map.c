@@ -0,0 +1,127 @@
+#include "pair_map.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+// Enough keys to make a 16-slot map wrap its probe runs around the end
+#define MAP_TEST_KEYS 12
+
+void test_pair_key() {
+    assert(pair_key(3, 7) == pair_key(7, 3));
+    assert(pair_key(3, 7) != pair_key(3, 8));
+    assert(pair_key(0, 1) != pair_key(1, 1));
+    assert(pair_key(1, 2) != pair_key(2, 3));
+}
+
+void test_pair_map_put_get() {
+    pair_map_t *map = pair_map_init(0, sizeof(double));
+    for (size_t i = 0; i < 1000; i++) {
+        double *value = pair_map_put(map, pair_key(i, i + 1));
+        assert(*value == 0);
+        *value = i;
+    }
+    assert(pair_map_size(map) == 1000);
+    for (size_t i = 0; i < 1000; i++) {
+        assert(pair_map_contains(map, pair_key(i + 1, i)));
+        assert(*(double *) pair_map_get(map, pair_key(i, i + 1)) == i);
+        // putting an existing key keeps its value
+        assert(*(double *) pair_map_put(map, pair_key(i, i + 1)) == i);
+    }
+    assert(pair_map_size(map) == 1000);
+    assert(!pair_map_contains(map, pair_key(0, 2)));
+    assert(pair_map_get(map, pair_key(0, 2)) == NULL);
+    pair_map_free(map);
+}
+
+void test_pair_map_remove() {
+    // a map that never grows past 16 slots, so removals keep shifting
+    // entries back through long and wrapped probe runs
+    pair_map_t *map = pair_map_init(MAP_TEST_KEYS, sizeof(size_t));
+    size_t capacity = pair_map_capacity(map);
+    bool present[3 * MAP_TEST_KEYS] = {false};
+    size_t size = 0;
+    srand(4);
+    for (size_t step = 0; step < 20000; step++) {
+        size_t id = rand() % (3 * MAP_TEST_KEYS);
+        uint64_t key = pair_key(id, 1000);
+        if (present[id]) {
+            assert(pair_map_remove(map, key));
+            present[id] = false;
+            size--;
+        }
+        else if (size < MAP_TEST_KEYS) {
+            *(size_t *) pair_map_put(map, key) = id;
+            present[id] = true;
+            size++;
+        }
+        else {
+            assert(!pair_map_remove(map, key));
+        }
+        assert(pair_map_size(map) == size);
+        for (size_t other = 0; other < 3 * MAP_TEST_KEYS; other++) {
+            size_t *value = pair_map_get(map, pair_key(other, 1000));
+            assert((value != NULL) == present[other]);
+            assert(value == NULL || *value == other);
+        }
+    }
+    assert(pair_map_capacity(map) == capacity);
+    pair_map_free(map);
+}
+
+void test_pair_map_slots() {
+    pair_map_t *map = pair_map_init(4, sizeof(size_t));
+    for (size_t i = 0; i < 50; i++) {
+        *(size_t *) pair_map_put(map, pair_key(i, 0)) = i;
+    }
+    bool seen[50] = {false};
+    size_t count = 0;
+    for (size_t i = 0; i < pair_map_capacity(map); i++) {
+        uint64_t key;
+        void *value;
+        if (pair_map_slot(map, i, &key, &value)) {
+            size_t id = *(size_t *) value;
+            assert(key == pair_key(id, 0));
+            assert(!seen[id]);
+            seen[id] = true;
+            count++;
+        }
+    }
+    assert(count == 50);
+    pair_map_clear(map);
+    assert(pair_map_size(map) == 0);
+    for (size_t i = 0; i < pair_map_capacity(map); i++) {
+        assert(!pair_map_slot(map, i, NULL, NULL));
+    }
+    assert(!pair_map_contains(map, pair_key(3, 0)));
+    pair_map_free(map);
+}
+
+void test_pair_map_set() {
+    // with no values the map is a set of keys
+    pair_map_t *set = pair_map_init(0, 0);
+    assert(pair_map_put(set, pair_key(1, 2)) != NULL);
+    assert(pair_map_contains(set, pair_key(2, 1)));
+    assert(pair_map_remove(set, pair_key(1, 2)));
+    assert(!pair_map_remove(set, pair_key(1, 2)));
+    assert(pair_map_size(set) == 0);
+    pair_map_free(set);
+}
+
+int main(int argc, char *argv[]) {
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests) {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_pair_key)
+    DO_TEST(test_pair_map_put_get)
+    DO_TEST(test_pair_map_remove)
+    DO_TEST(test_pair_map_slots)
+    DO_TEST(test_pair_map_set)
+
+    puts("pair_map_test PASS");
+}
@@ -0,0 +1,91 @@
+#include "polygon.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+// The slingshot from the game, listed counterclockwise
+const double SLINGSHOT[13][2] = {
+    {143, 0}, {157, 0}, {157, 50}, {182, 100}, {182, 150},
+    {173, 150}, {173, 100}, {146, 52}, {127, 93}, {127, 138},
+    {120, 138}, {120, 93}, {143, 47}
+};
+
+shape_t *make_shape(const double points[][2], size_t size, bool reverse) {
+    shape_t *shape = shape_init(size);
+    for (size_t i = 0; i < size; i++) {
+        size_t j = reverse ? size - 1 - i : i;
+        shape->points[i] = vec_init(points[j][0], points[j][1]);
+    }
+    return shape;
+}
+
+// Checks that every piece is convex and that the pieces cover the polygon
+void check_decomposition(shape_t *shape, size_t expected_pieces) {
+    list_t *pieces = shape_decompose(shape);
+    assert(list_size(pieces) == expected_pieces);
+    double area = 0;
+    for (size_t i = 0; i < list_size(pieces); i++) {
+        shape_t *piece = list_get(pieces, i);
+        assert(shape_is_convex(piece));
+        area += shape_area(piece);
+    }
+    assert(isclose(area, shape_area(shape)));
+    list_free(pieces);
+    shape_free(shape);
+}
+
+void test_decompose_convex() {
+    const double square[4][2] = {{0, 0}, {1, 0}, {1, 1}, {0, 1}};
+    check_decomposition(make_shape(square, 4, false), 1);
+}
+
+void test_decompose_l() {
+    const double l[6][2] = {{0, 0}, {2, 0}, {2, 1}, {1, 1}, {1, 2}, {0, 2}};
+    // the ear at (0, 0) is clipped along a diagonal through (1, 1), which
+    // would leave three triangles instead of two rectangles
+    check_decomposition(make_shape(l, 6, false), 2);
+    check_decomposition(make_shape(l, 6, true), 2);
+}
+
+void test_decompose_slingshot() {
+    check_decomposition(make_shape(SLINGSHOT, 13, false), 6);
+    check_decomposition(make_shape(SLINGSHOT, 13, true), 6);
+}
+
+void test_decompose_star() {
+    shape_t *star = shape_init(10);
+    for (size_t i = 0; i < 10; i++) {
+        double radius = i % 2 == 0 ? 2.5 : 1;
+        star->points[i] = vec_init(radius * cos(i * M_PI / 5),
+            radius * sin(i * M_PI / 5));
+    }
+    list_t *pieces = shape_decompose(star);
+    assert(list_size(pieces) > 1);
+    double area = 0;
+    for (size_t i = 0; i < list_size(pieces); i++) {
+        shape_t *piece = list_get(pieces, i);
+        assert(shape_is_convex(piece));
+        area += shape_area(piece);
+    }
+    assert(isclose(area, shape_area(star)));
+    list_free(pieces);
+    shape_free(star);
+}
+
+int main(int argc, char *argv[]) {
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests) {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_decompose_convex)
+    DO_TEST(test_decompose_l)
+    DO_TEST(test_decompose_slingshot)
+    DO_TEST(test_decompose_star)
+
+    puts("polygon_test PASS");
+}
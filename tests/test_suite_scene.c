@@ -0,0 +1,600 @@
+#include "scene.h"
+#include "aabb_tree.h"
+#include "forces.h"
+#include "sweep_prune.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define REGISTER_TEST_BODIES 20
+#define HOLDER_TEST_BODIES 40
+
+// A force creator that pushes one body and counts how often it runs
+typedef struct counted_force {
+    body_t *body;
+    vector_t force;
+    size_t calls;
+} counted_force_t;
+
+void apply_counted_force(void *aux) {
+    counted_force_t *counted = aux;
+    counted->calls++;
+    body_add_force(counted->body, counted->force);
+}
+
+counted_force_t *add_counted_force(scene_t *scene, body_t *body,
+    vector_t force) {
+    counted_force_t *counted = malloc(sizeof(counted_force_t));
+    *counted = (counted_force_t) {body, force, 0};
+    scene_add_force_creator(scene, apply_counted_force, counted, NULL);
+    return counted;
+}
+
+// A thin wall and a bullet that would pass through it in a single tick,
+// hitting it after about -start / 100 seconds
+body_t *add_bullet_and_wall(scene_t *scene, double start, double y) {
+    body_t *wall = make_box(vec_init(0.1, y), 0.2, 10, INFINITY);
+    body_t *bullet = make_circle(vec_init(start, y), 0.5, 1);
+    body_set_velocity(bullet, vec_init(100, 0));
+    body_set_bullet(bullet, true);
+    scene_add_body(scene, bullet);
+    scene_add_body(scene, wall);
+    create_physics_collision(scene, 1, wall, bullet);
+    return bullet;
+}
+
+void test_split_tick_forces_once() {
+    scene_t *scene = scene_init();
+    body_t *bullet = add_bullet_and_wall(scene, -10, 0);
+    body_t *free_body = make_box(vec_init(0, 50), 1, 1, 2);
+    scene_add_body(scene, free_body);
+    counted_force_t *counted = add_counted_force(scene, free_body,
+        vec_init(4, 0));
+
+    scene_tick(scene, 1);
+    // the bullet bounced, so the tick was split at the wall
+    assert(body_get_velocity(bullet).x < 0);
+    assert(counted->calls == 1);
+    // the force still acted for the whole tick
+    assert(vec_isclose(body_get_velocity(free_body), vec_init(2, 0)));
+    scene_tick(scene, 1);
+    assert(counted->calls == 2);
+    assert(vec_isclose(body_get_velocity(free_body), vec_init(4, 0)));
+    scene_free(scene);
+    free(counted);
+}
+
+void test_split_tick_removal() {
+    // a bullet destroyed partway through a tick leaves the saved forces of
+    // the bodies after it in the scene with the right bodies
+    scene_t *scene = scene_init();
+    body_t *target = make_box(vec_init(0.1, 0), 0.2, 10, 1);
+    body_t *bullet = make_circle(vec_init(-10, 0), 0.5, 1);
+    body_set_velocity(bullet, vec_init(100, 0));
+    body_set_bullet(bullet, true);
+    scene_add_body(scene, bullet);
+    scene_add_body(scene, target);
+    create_collision(scene, target, bullet, calc_destructive_force, NULL, NULL);
+    // another bullet splits the tick again after the first one is gone
+    body_t *other = add_bullet_and_wall(scene, -60, 20);
+    body_t *pushed = make_box(vec_init(0, 50), 1, 1, 2);
+    body_t *still = make_box(vec_init(10, 50), 1, 1, 2);
+    scene_add_body(scene, pushed);
+    scene_add_body(scene, still);
+    counted_force_t *counted = add_counted_force(scene, pushed,
+        vec_init(4, 0));
+
+    scene_tick(scene, 1);
+    assert(body_get_velocity(other).x < 0);
+    assert(scene_bodies(scene) == 4);
+    assert(counted->calls == 1);
+    assert(vec_isclose(body_get_velocity(pushed), vec_init(2, 0)));
+    assert(vec_equal(body_get_velocity(still), VEC_ZERO));
+    scene_free(scene);
+    free(counted);
+}
+
+// How many narrowphase tests a scene has run with its separating axes
+size_t narrowphase_tests(scene_t *scene) {
+    contact_cache_t *cache = scene_get_contacts(scene);
+    return contact_cache_axis_hits(cache) + contact_cache_axis_misses(cache);
+}
+
+void count_handler_call(body_t *body1, body_t *body2, vector_t axis,
+    void *aux) {
+    (*(size_t *) aux)++;
+}
+
+// A row of boxes, each touching the next, with its left end at x
+void add_box_row(scene_t *scene, double x, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        scene_add_body(scene, make_box(vec_init(x + 1.9 * i, 0), 2, 2, 1));
+    }
+}
+
+void check_collect_once(scene_t *scene, size_t tests) {
+    const size_t ROW = 6;
+    add_box_row(scene, 0, ROW);
+    size_t calls = 0;
+    create_collision(scene, scene_get_body(scene, 0), scene_get_body(scene, 1),
+        count_handler_call, &calls, NULL);
+
+    list_t *contacts = list_init(ROW, free);
+    scene_collect_contacts(scene, contacts);
+    assert(list_size(contacts) == ROW - 1);
+    assert(narrowphase_tests(scene) == tests);
+    // a second call, and the handlers run by the next tick, test nothing
+    list_free(contacts);
+    contacts = list_init(ROW, free);
+    scene_collect_contacts(scene, contacts);
+    assert(list_size(contacts) == ROW - 1);
+    scene_tick(scene, 0.01);
+    assert(calls == 1);
+    assert(narrowphase_tests(scene) == tests);
+    list_free(contacts);
+
+    // after the tick every pair is tested once more
+    contacts = list_init(ROW, free);
+    scene_collect_contacts(scene, contacts);
+    assert(list_size(contacts) == ROW - 1);
+    assert(narrowphase_tests(scene) == 2 * tests);
+    list_free(contacts);
+    scene_free(scene);
+}
+
+void test_collect_contacts_once() {
+    // every pair without a broadphase, only neighbours with one
+    check_collect_once(scene_init(), 6 * 5 / 2);
+    scene_t *scene = scene_init();
+    scene_set_broadphase(scene, sweep_prune_init());
+    check_collect_once(scene, 5);
+}
+
+void check_mask_filtering(scene_t *scene) {
+    // three overlapping boxes, of which only the first two may collide
+    body_t *body1 = make_box(VEC_ZERO, 2, 2, 1);
+    body_t *body2 = make_box(vec_init(1, 0), 2, 2, 1);
+    body_t *body3 = make_box(vec_init(0.5, 1), 2, 2, 1);
+    body_set_collision_filter(body1, 1 << 0, 1 << 1);
+    body_set_collision_filter(body2, 1 << 1, 1 << 0);
+    body_set_collision_filter(body3, 1 << 2, UINT32_MAX);
+    scene_add_body(scene, body1);
+    scene_add_body(scene, body2);
+    scene_add_body(scene, body3);
+    size_t calls = 0;
+    create_collision(scene, body1, body3, count_handler_call, &calls, NULL);
+    create_collision(scene, body2, body3, count_handler_call, &calls, NULL);
+
+    list_t *contacts = list_init(1, free);
+    scene_collect_contacts(scene, contacts);
+    assert(list_size(contacts) == 1);
+    contact_t *contact = list_get(contacts, 0);
+    assert((contact->body1 == body1 && contact->body2 == body2)
+        || (contact->body1 == body2 && contact->body2 == body1));
+    // the filtered pairs never reach the narrowphase or their handlers
+    assert(narrowphase_tests(scene) == 1);
+    scene_tick(scene, 0.01);
+    assert(calls == 0);
+    list_free(contacts);
+    scene_free(scene);
+}
+
+void test_mask_filtering() {
+    check_mask_filtering(scene_init());
+    scene_t *scene = scene_init();
+    scene_set_broadphase(scene, sweep_prune_init());
+    check_mask_filtering(scene);
+}
+
+// The last pair of bodies a collision handler was called on
+typedef struct handler_call {
+    body_t *body1;
+    body_t *body2;
+    vector_t axis;
+    size_t calls;
+} handler_call_t;
+
+void record_handler_call(body_t *body1, body_t *body2, vector_t axis,
+    void *aux) {
+    handler_call_t *call = aux;
+    *call = (handler_call_t) {body1, body2, axis, call->calls + 1};
+}
+
+void check_rule_order(scene_t *scene, bool reversed) {
+    // box1 touches box2 on its right and box3 on its left
+    body_t *box1 = make_box(vec_init(0, 0), 2, 2, 1);
+    body_t *box2 = make_box(vec_init(1.9, 0), 2, 2, 1);
+    body_t *box3 = make_box(vec_init(-1.9, 0), 2, 2, 1);
+    body_set_collision_filter(box1, 1 << 0, UINT32_MAX);
+    body_set_collision_filter(box2, 1 << 1, UINT32_MAX);
+    body_set_collision_filter(box3, 1 << 2, UINT32_MAX);
+    body_t *order[] = {box1, box2, box3};
+    for (size_t i = 0; i < 3; i++) {
+        scene_add_body(scene, order[reversed ? 2 - i : i]);
+    }
+    handler_call_t call = {NULL, NULL, VEC_ZERO, 0};
+    scene_add_collision_rule(scene, 1 << 1, 1 << 0, record_handler_call,
+        &call, NULL);
+    scene_tick(scene, 0.01);
+    // the body in the rule's first category comes first, whatever the order
+    // the bodies were added in, and the axis points from it to the other
+    assert(call.calls == 1);
+    assert(call.body1 == box2 && call.body2 == box1);
+    assert(vec_isclose(call.axis, vec_init(-1, 0)));
+    // the pair no rule matches is never tested
+    assert(narrowphase_tests(scene) == 1);
+    scene_tick(scene, 0.01);
+    assert(call.calls == 2);
+    scene_free(scene);
+}
+
+void test_collision_rule_order() {
+    for (size_t reversed = 0; reversed < 2; reversed++) {
+        check_rule_order(scene_init(), reversed);
+        scene_t *scene = scene_init();
+        scene_set_broadphase(scene, sweep_prune_init());
+        check_rule_order(scene, reversed);
+    }
+}
+
+// Boxes at x = 3 (category 2), 5 and 10 (category 1) on the x axis
+void add_cast_targets(scene_t *scene) {
+    body_t *near = make_box(vec_init(3, 0), 2, 2, 1);
+    body_set_collision_filter(near, 1 << 1, UINT32_MAX);
+    scene_add_body(scene, near);
+    scene_add_body(scene, make_box(vec_init(5, 0), 2, 2, 1));
+    scene_add_body(scene, make_box(vec_init(10, 0), 2, 2, 1));
+}
+
+void check_raycast(scene_t *scene) {
+    add_cast_targets(scene);
+    raycast_hit_t hit;
+    assert(scene_raycast(scene, VEC_ZERO, vec_init(20, 0), 1 << 0, &hit));
+    assert(hit.body == scene_get_body(scene, 1));
+    assert(isclose(hit.fraction, 0.2));
+    assert(vec_isclose(hit.point, vec_init(4, 0)));
+    assert(vec_isclose(hit.normal, vec_init(-1, 0)));
+    // a wider mask hits the nearer box
+    assert(scene_raycast(scene, VEC_ZERO, vec_init(20, 0), 3, &hit));
+    assert(hit.body == scene_get_body(scene, 0));
+    assert(isclose(hit.fraction, 0.1));
+    // the box the ray starts in is ignored
+    assert(scene_raycast(scene, vec_init(5, 0), vec_init(20, 0), 1, &hit));
+    assert(hit.body == scene_get_body(scene, 2));
+    assert(isclose(hit.fraction, 4.0 / 15));
+    // too short, or passing by
+    assert(!scene_raycast(scene, VEC_ZERO, vec_init(1.5, 0), 3, &hit));
+    assert(hit.body == NULL);
+    assert(!scene_raycast(scene, vec_init(0, 5), vec_init(20, 5), 3, &hit));
+    scene_free(scene);
+}
+
+void check_shapecast(scene_t *scene) {
+    add_cast_targets(scene);
+    body_t *ball = make_circle(VEC_ZERO, 0.5, 1);
+    raycast_hit_t hit;
+    // stops within the time of impact tolerance of the box at x = 5
+    assert(scene_shapecast(scene, ball, vec_init(20, 0), 1, &hit));
+    assert(hit.body == scene_get_body(scene, 1));
+    assert(hit.fraction <= 3.5 / 20 && hit.fraction >= 3.4 / 20);
+    assert(vec_within(0.01, hit.normal, vec_init(-1, 0)));
+    assert(vec_within(0.1, hit.point, vec_init(4, 0)));
+    assert(scene_shapecast(scene, ball, vec_init(20, 0), 3, &hit));
+    assert(hit.body == scene_get_body(scene, 0));
+    // a box the ball already overlaps is ignored
+    body_set_centroid(ball, vec_init(5.5, 0));
+    assert(scene_shapecast(scene, ball, vec_init(20, 0), 1, &hit));
+    assert(hit.body == scene_get_body(scene, 2));
+    // passing by above the boxes
+    body_set_centroid(ball, vec_init(0, 1.6));
+    assert(!scene_shapecast(scene, ball, vec_init(20, 0), 3, &hit));
+    assert(hit.body == NULL);
+    body_free(ball);
+    scene_free(scene);
+}
+
+void test_raycast() {
+    check_raycast(scene_init());
+    scene_t *scene = scene_init();
+    scene_set_broadphase(scene, aabb_tree_broadphase_init(0.5));
+    check_raycast(scene);
+}
+
+void test_shapecast() {
+    check_shapecast(scene_init());
+    scene_t *scene = scene_init();
+    scene_set_broadphase(scene, aabb_tree_broadphase_init(0.5));
+    check_shapecast(scene);
+}
+
+size_t freed_auxes = 0;
+
+void count_aux_free(void *aux) {
+    freed_auxes++;
+}
+
+void test_register_collision() {
+    scene_t *scene = scene_init();
+    add_box_row(scene, 0, 4);
+    body_t *box[4];
+    for (size_t i = 0; i < 4; i++) {
+        box[i] = scene_get_body(scene, i);
+    }
+    size_t calls = 0;
+    freed_auxes = 0;
+    assert(scene_register_collision(scene, box[0], box[1], count_handler_call,
+        &calls, count_aux_free));
+    // the same handler again is a duplicate, and its aux is freed at once
+    assert(!scene_register_collision(scene, box[0], box[1],
+        count_handler_call, &calls, count_aux_free));
+    assert(scene_duplicate_collisions(scene) == 1);
+    assert(freed_auxes == 1);
+    // the other order of the bodies is a different registration
+    assert(scene_register_collision(scene, box[1], box[0], count_handler_call,
+        &calls, count_aux_free));
+    assert(scene_register_collision(scene, box[1], box[2], count_handler_call,
+        &calls, count_aux_free));
+    assert(scene_register_collision(scene, box[2], box[3], count_handler_call,
+        &calls, count_aux_free));
+    assert(scene_register_collision(scene, box[0], box[3], count_handler_call,
+        &calls, count_aux_free));
+    scene_tick(scene, 0.01);
+    assert(calls == 4);
+    assert(scene_duplicate_collisions(scene) == 1);
+
+    // removing a body drops exactly the registrations it is in
+    body_remove(box[1]);
+    scene_tick(scene, 0.01);
+    assert(freed_auxes == 4);
+    calls = 0;
+    scene_tick(scene, 0.01);
+    assert(calls == 1);
+    assert(scene_register_collision(scene, box[2], box[2], count_handler_call,
+        &calls, count_aux_free));
+    assert(!scene_register_collision(scene, box[0], box[3],
+        count_handler_call, &calls, count_aux_free));
+    assert(freed_auxes == 5);
+    body_remove(box[2]);
+    scene_tick(scene, 0.01);
+    assert(freed_auxes == 7);
+    scene_free(scene);
+    assert(freed_auxes == 8);
+}
+
+void test_register_churn() {
+    // random pairs are registered while bodies are removed; each removal must
+    // free exactly the registrations of the removed body
+    srand(21);
+    scene_t *scene = scene_init();
+    body_t *bodies[REGISTER_TEST_BODIES];
+    bool registered[REGISTER_TEST_BODIES][REGISTER_TEST_BODIES];
+    bool removed[REGISTER_TEST_BODIES];
+    for (size_t i = 0; i < REGISTER_TEST_BODIES; i++) {
+        bodies[i] = make_box(vec_init(5 * i, 0), 1, 1, 1);
+        scene_add_body(scene, bodies[i]);
+        removed[i] = false;
+        for (size_t j = 0; j < REGISTER_TEST_BODIES; j++) {
+            registered[i][j] = false;
+        }
+    }
+    freed_auxes = 0;
+    size_t expected = 0;
+    for (size_t round = 0; round < REGISTER_TEST_BODIES - 2; round++) {
+        for (size_t n = 0; n < 15; n++) {
+            size_t i = rand() % REGISTER_TEST_BODIES;
+            size_t j = rand() % REGISTER_TEST_BODIES;
+            if (i == j || removed[i] || removed[j]) {
+                continue;
+            }
+            bool fresh = scene_register_collision(scene, bodies[i], bodies[j],
+                count_handler_call, NULL, count_aux_free);
+            assert(fresh == !registered[i][j]);
+            expected += !fresh;
+            registered[i][j] = true;
+        }
+        size_t k;
+        do {
+            k = rand() % REGISTER_TEST_BODIES;
+        } while (removed[k]);
+        body_remove(bodies[k]);
+        removed[k] = true;
+        for (size_t i = 0; i < REGISTER_TEST_BODIES; i++) {
+            expected += registered[k][i] + registered[i][k];
+            registered[k][i] = registered[i][k] = false;
+        }
+        scene_tick(scene, 0.01);
+        assert(freed_auxes == expected);
+    }
+    scene_free(scene);
+}
+
+// Whether the creator made for body i in test_holder_cleanup() still runs
+bool holder_alive(bool *removed, size_t i) {
+    return !removed[i]
+        && !(i % 4 == 1 && removed[(i + 1) % HOLDER_TEST_BODIES]);
+}
+
+void test_holder_cleanup() {
+    // every creator acts on a long-lived anchor and one or two other bodies,
+    // some listed twice; removing bodies a few at a time must stop exactly
+    // the creators that act on them
+    scene_t *scene = scene_init();
+    body_t *anchor = make_box(VEC_ZERO, 1, 1, 1);
+    scene_add_body(scene, anchor);
+    body_t *bodies[HOLDER_TEST_BODIES];
+    counted_force_t counted[HOLDER_TEST_BODIES];
+    bool removed[HOLDER_TEST_BODIES];
+    for (size_t i = 0; i < HOLDER_TEST_BODIES; i++) {
+        bodies[i] = make_box(vec_init(0, 5 * (i + 1)), 1, 1, 1);
+        scene_add_body(scene, bodies[i]);
+        removed[i] = false;
+    }
+    for (size_t i = 0; i < HOLDER_TEST_BODIES; i++) {
+        counted[i] = (counted_force_t) {anchor, VEC_ZERO, 0};
+        list_t *list = list_init(3, NULL);
+        list_add(list, anchor);
+        list_add(list, bodies[i]);
+        if (i % 3 == 0) {
+            list_add(list, bodies[i]);
+        }
+        if (i % 4 == 1) {
+            list_add(list, bodies[(i + 1) % HOLDER_TEST_BODIES]);
+        }
+        scene_add_bodies_force_creator(scene, apply_counted_force,
+            &counted[i], list, NULL);
+    }
+    // one creator acts on the anchor alone, and outlives every other
+    counted_force_t anchored = {anchor, VEC_ZERO, 0};
+    list_t *list = list_init(1, NULL);
+    list_add(list, anchor);
+    scene_add_bodies_force_creator(scene, apply_counted_force, &anchored,
+        list, NULL);
+    size_t order = 0;
+    for (size_t tick = 1; order < HOLDER_TEST_BODIES; tick++) {
+        size_t expected[HOLDER_TEST_BODIES];
+        for (size_t i = 0; i < HOLDER_TEST_BODIES; i++) {
+            expected[i] = counted[i].calls + holder_alive(removed, i);
+        }
+        // one body on odd ticks, two on even ones, each removed at the end
+        // of the tick, after its creators last ran
+        for (size_t n = 0; n < 1 + tick % 2 && order < HOLDER_TEST_BODIES;
+            n++) {
+            size_t i = order++ * 7 % HOLDER_TEST_BODIES;
+            body_remove(bodies[i]);
+            removed[i] = true;
+        }
+        scene_tick(scene, 0.01);
+        for (size_t i = 0; i < HOLDER_TEST_BODIES; i++) {
+            assert(counted[i].calls == expected[i]);
+        }
+    }
+    assert(scene_bodies(scene) == 1);
+    size_t calls = anchored.calls;
+    scene_tick(scene, 0.01);
+    assert(anchored.calls == calls + 1);
+    body_remove(anchor);
+    scene_tick(scene, 0.01);
+    scene_tick(scene, 0.01);
+    assert(anchored.calls == calls + 2);
+    scene_free(scene);
+}
+
+// A static floor and two boxes on it, under every kind of force that acts
+// on the whole scene or on one body
+scene_t *make_floor_scene(counted_force_t **counted) {
+    scene_t *scene = scene_init();
+    scene_set_broadphase(scene, sweep_prune_init());
+    scene_set_sleeping(scene, true);
+    body_t *floor = make_box(vec_init(0, -1), 40, 2, INFINITY);
+    body_t *box1 = make_box(vec_init(-3, 1), 2, 2, 1);
+    body_t *box2 = make_box(vec_init(3, 1), 2, 2, 1);
+    scene_add_body(scene, floor);
+    scene_add_body(scene, box1);
+    scene_add_body(scene, box2);
+    create_barnes_hut_gravity(scene, 1e-3, 0.5);
+    create_drag(scene, 2, box1);
+    create_physics_collision_rule(scene, 0, UINT32_MAX, UINT32_MAX);
+    *counted = malloc(sizeof(counted_force_t));
+    **counted = (counted_force_t) {box2, VEC_ZERO, 0};
+    list_t *bodies = list_init(1, NULL);
+    list_add(bodies, box2);
+    scene_add_bodies_force_creator(scene, apply_counted_force, *counted,
+        bodies, NULL);
+    return scene;
+}
+
+// Ticks a scene until all of its movable bodies are asleep
+void settle(scene_t *scene) {
+    for (size_t tick = 0; tick < 1000; tick++) {
+        scene_tick(scene, 0.01);
+        bool settled = true;
+        for (size_t i = 0; i < scene_bodies(scene); i++) {
+            body_t *body = scene_get_body(scene, i);
+            settled &= body_get_mass(body) == INFINITY
+                || body_is_sleeping(body);
+        }
+        if (settled) {
+            return;
+        }
+    }
+    assert(false);
+}
+
+void test_settled_scene_idle() {
+    counted_force_t *counted;
+    scene_t *scene = make_floor_scene(&counted);
+    create_uniform_gravity(scene, 9.8, UINT32_MAX);
+    body_t *box1 = scene_get_body(scene, 1);
+    body_t *box2 = scene_get_body(scene, 2);
+    body_sleep(box1);
+    body_sleep(box2);
+    for (size_t tick = 0; tick < 200; tick++) {
+        scene_tick(scene, 0.01);
+    }
+    // neither gravity nor drag woke the bodies, and nothing was tested
+    assert(body_is_sleeping(box1) && body_is_sleeping(box2));
+    assert(vec_equal(body_get_centroid(box1), vec_init(-3, 1)));
+    assert(counted->calls == 0);
+    assert(narrowphase_tests(scene) == 0);
+    scene_free(scene);
+    free(counted);
+}
+
+void test_sleep_and_wake() {
+    counted_force_t *counted;
+    scene_t *scene = make_floor_scene(&counted);
+    body_t *box1 = scene_get_body(scene, 1);
+    body_t *box2 = scene_get_body(scene, 2);
+    // drag slows the sliding box until it falls asleep
+    body_set_velocity(box1, vec_init(3, 0));
+    settle(scene);
+    assert(body_get_centroid(box1).x > -2);
+    size_t calls = counted->calls;
+    size_t tests = narrowphase_tests(scene);
+    scene_tick(scene, 0.01);
+    assert(counted->calls == calls);
+    assert(narrowphase_tests(scene) == tests);
+
+    // a push wakes the body, which falls back asleep once it stops
+    body_add_impulse(box1, vec_init(5, 0));
+    assert(!body_is_sleeping(box1));
+    scene_tick(scene, 0.01);
+    assert(narrowphase_tests(scene) > tests);
+    settle(scene);
+
+    // turning sleeping off wakes every body, and the creators run again
+    calls = counted->calls;
+    scene_set_sleeping(scene, false);
+    assert(!body_is_sleeping(box1) && !body_is_sleeping(box2));
+    scene_tick(scene, 0.01);
+    assert(counted->calls == calls + 1);
+    scene_free(scene);
+    free(counted);
+}
+
+int main(int argc, char *argv[]) {
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests) {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_split_tick_forces_once)
+    DO_TEST(test_split_tick_removal)
+    DO_TEST(test_collect_contacts_once)
+    DO_TEST(test_mask_filtering)
+    DO_TEST(test_collision_rule_order)
+    DO_TEST(test_raycast)
+    DO_TEST(test_shapecast)
+    DO_TEST(test_register_collision)
+    DO_TEST(test_register_churn)
+    DO_TEST(test_holder_cleanup)
+    DO_TEST(test_settled_scene_idle)
+    DO_TEST(test_sleep_and_wake)
+
+    puts("scene_test PASS");
+}
@@ -0,0 +1,47 @@
+#include "sweep_prune.h"
+#include "test_util.h"
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+void test_sweep_prune_brute_force() {
+    broadphase_t *broadphase = sweep_prune_init();
+    check_broadphase_brute_force(broadphase, true);
+    broadphase_free(broadphase);
+}
+
+void test_sweep_prune_touching() {
+    // boxes that share an edge, or only have equal x extents, are paired
+    broadphase_t *broadphase = sweep_prune_init();
+    body_t *left = make_box(vec_init(0, 0), 2, 2, 1);
+    body_t *right = make_box(vec_init(2, 0), 2, 2, 1);
+    body_t *above = make_box(vec_init(0, 5), 2, 2, 1);
+    broadphase_add(broadphase, left);
+    broadphase_add(broadphase, right);
+    broadphase_add(broadphase, above);
+    pair_map_t *pairs = pair_map_init(0, sizeof(body_pair_t));
+    broadphase_find_pairs(broadphase, pairs);
+    assert(pair_map_size(pairs) == 1);
+    assert(pair_map_contains(pairs,
+        pair_key(body_get_id(left), body_get_id(right))));
+    pair_map_free(pairs);
+    broadphase_free(broadphase);
+    body_free(left);
+    body_free(right);
+    body_free(above);
+}
+
+int main(int argc, char *argv[]) {
+    // Run all tests if there are no command-line arguments
+    bool all_tests = argc == 1;
+    // Read test name from file
+    char testname[100];
+    if (!all_tests) {
+        read_testname(argv[1], testname, sizeof(testname));
+    }
+
+    DO_TEST(test_sweep_prune_brute_force)
+    DO_TEST(test_sweep_prune_touching)
+
+    puts("sweep_prune_test PASS");
+}